@@ -6,6 +6,10 @@
 #include <string>
 #include <boost/algorithm/string.hpp>
 #include <boost/program_options.hpp> 
+#include <boost/filesystem/fstream.hpp> // fs::ofstream
+#include <ctime> // time
+
+#include "../JSON/json.h"
 
 using namespace std;
 namespace fs = boost::filesystem;
@@ -124,6 +128,16 @@ unsigned int Analysis::getNumJobs() const{
 	return jobs.size();
 }
 
+unsigned int Analysis::countJobs(Job::Status status) const {
+    unsigned int count = 0;
+    for (const Job &job : jobs) {
+        if (job.status == status) {
+            count++;
+        }
+    }
+    return count;
+}
+
 bool Analysis::hasJobs() const{
 	return !jobs.empty();
 }
@@ -142,7 +156,8 @@ vector<fs::path> Analysis::getAllObjectFiles() const {
     vector<fs::path> objFiles;
     for (const Analysis::Job &job : jobs) {
 		if(job.status == Job::SUCCESS 
-				|| job.status == Job::COMPLETE_WITH_ERROR)
+				|| job.status == Job::COMPLETE_WITH_ERROR
+				|| job.status == Job::COMPLETE_DEGRADED)
 		{
 			objFiles.push_back(job.objectFilePath);
 		}
@@ -158,8 +173,73 @@ bool Analysis::hasExtraObjectFiles() const {
     return !extraObjectFiles.empty();
 }
 
-//TODO: Write a summary of extraction run
-void Analysis::writeDiagnostics(const fs::path &outputPath) {
-    (void) outputPath;
+static string statusToString(Analysis::Job::Status status) {
+    switch (status) {
+        case Analysis::Job::SUCCESS: return "success";
+        case Analysis::Job::COMPLETE_WITH_ERROR: return "complete-with-error";
+        case Analysis::Job::COMPLETE_DEGRADED: return "complete-degraded";
+        case Analysis::Job::FAIL: return "fail";
+        case Analysis::Job::NOT_PROCESSED: return "not-processed";
+    }
+    return "unknown";
+}
+
+// Write a per-job summary of the extraction run to the given directory.
+//
+// telemetry.csv is appended to on every run (like information.csv) so that
+// results can be tracked over time. telemetry.json only holds the latest run.
+void Analysis::writeDiagnostics(const fs::path &outputDir) const {
+    fs::create_directories(outputDir);
+    time_t runTime = time(nullptr);
+
+    fs::path csvPath = outputDir / "telemetry.csv";
+    bool writeHeader = !fs::exists(csvPath);
+    fs::ofstream csv(csvPath, ios::app);
+    if (writeHeader) {
+        csv << "run,source,status,total-ms,parse-ms,walk-ms,write-ms,max-rss-kb,"
+               "decls,stmts,id-lookups,id-cache-hits,nodes,edges,unestablished-edges" << endl;
+    }
+
+    Json::Value report;
+    report["run"] = Json::Int64(runTime);
+    // Degraded jobs count as successes everywhere else, so they are totalled
+    // separately here
+    for (Job::Status status : {Job::SUCCESS, Job::COMPLETE_WITH_ERROR, Job::COMPLETE_DEGRADED, Job::FAIL,
+                               Job::NOT_PROCESSED}) {
+        report["statusCounts"][statusToString(status)] = countJobs(status);
+    }
+    report["jobs"] = Json::Value(Json::arrayValue);
+    for (const Job &job : jobs) {
+        const JobTelemetry &t = job.telemetry;
+        csv << runTime << ',' << job.sourcePath.string() << ',' << statusToString(job.status) << ','
+            << t.totalMs << ',' << t.parseMs << ',' << t.walkMs << ',' << t.writeMs << ','
+            << t.maxRSS << ',' << t.numDecls << ',' << t.numStmts << ','
+            << t.numIDLookups << ',' << t.numIDCacheHits << ','
+            << t.numNodes << ',' << t.numEdges << ',' << t.numUnestablishedEdges << endl;
+
+        Json::Value entry;
+        entry["source"] = job.sourcePath.string();
+        entry["status"] = statusToString(job.status);
+        entry["reported"] = t.reported;
+        entry["totalMs"] = t.totalMs;
+        entry["parseMs"] = t.parseMs;
+        entry["walkMs"] = t.walkMs;
+        entry["writeMs"] = t.writeMs;
+        entry["maxRssKb"] = Json::Int64(t.maxRSS);
+        entry["decls"] = Json::UInt64(t.numDecls);
+        entry["stmts"] = Json::UInt64(t.numStmts);
+        entry["idLookups"] = Json::UInt64(t.numIDLookups);
+        entry["idCacheHits"] = Json::UInt64(t.numIDCacheHits);
+        entry["idCacheHitRate"] = t.numIDLookups ? double(t.numIDCacheHits) / t.numIDLookups : 0.0;
+        entry["nodes"] = Json::UInt64(t.numNodes);
+        entry["edges"] = Json::UInt64(t.numEdges);
+        entry["unestablishedEdges"] = Json::UInt64(t.numUnestablishedEdges);
+        report["jobs"].append(entry);
+    }
+
+    fs::ofstream json(outputDir / "telemetry.json");
+    Json::StreamWriterBuilder builder;
+    builder["indentation"] = "  ";
+    json << Json::writeString(builder, report) << endl;
 }
 
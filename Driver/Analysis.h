@@ -4,6 +4,8 @@
 #include <vector> // for vector
 #include <unordered_set> // for unordered_set
 
+#include "JobTelemetry.h"
+
 // Need this code to store fs::path in unordered_set
 // Source: https://lists.boost.org/boost-users/2012/12/76835.php
 #include <boost/functional/hash.hpp>
@@ -30,6 +32,10 @@ class Analysis {
 		{
 			SUCCESS,
 			COMPLETE_WITH_ERROR,
+			// Only completed after being retried without the
+			// expensive features (CFG, variability) because it
+			// ran out of time or memory
+			COMPLETE_DEGRADED,
 			FAIL,
 			NOT_PROCESSED
 		};
@@ -37,6 +43,7 @@ class Analysis {
         boost::filesystem::path sourcePath;
         boost::filesystem::path objectFilePath;
         Status status;
+        JobTelemetry telemetry;
         
         Job() : status{NOT_PROCESSED} {}
     };
@@ -45,11 +52,13 @@ class Analysis {
 
     Job &getJob(unsigned int index);
     unsigned int getNumJobs() const;
+    // The number of jobs that ended with the given status
+    unsigned int countJobs(Job::Status status) const;
     bool hasJobs() const;
     const std::unordered_set<boost::filesystem::path> &getSourceDirectories() const;
     std::vector<boost::filesystem::path> getAllObjectFiles() const;
     bool hasExtraObjectFiles() const;
-    void writeDiagnostics(const boost::filesystem::path &outputPath);
+    void writeDiagnostics(const boost::filesystem::path &outputDir) const;
 
   private:
     std::vector<Job> jobs;
@@ -158,7 +158,8 @@ bool VariabilityOptions::isEqual(const ConfigOption &other) const
         && bools == otherCpy.bools
         && chars == otherCpy.chars
         && nameMatch == otherCpy.nameMatch
-        && variability_On == otherCpy.variability_On;
+        && variability_On == otherCpy.variability_On
+        && bdd == otherCpy.bdd;
 }
 string VariabilityOptions::writeData() const
 {
@@ -186,6 +187,7 @@ istream& VariabilityOptions::readFile(std::istream &in)
         chars = extractionConfig["variability"]["chars"].asBool();
         nameMatch = extractionConfig["variability"]["nameMatch"].asString();
         variability_On = extractionConfig["variability"]["variability_On"].asBool();
+        bdd = extractionConfig["variability"]["bdd"].asBool();
     }
     else
     {   
@@ -204,6 +206,7 @@ bool VariabilityOptions::readJson(Json::Value extractionConfig){
         chars = extractionConfig["variability"]["chars"].asBool();
         nameMatch = extractionConfig["variability"]["nameMatch"].asString();
         variability_On = extractionConfig["variability"]["variability_On"].asBool();
+        bdd = extractionConfig["variability"]["bdd"].asBool();
         return true;
     }
     else{
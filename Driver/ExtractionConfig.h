@@ -44,8 +44,9 @@ struct VariabilityOptions : public ConfigOption {
     bool chars = false;
     bool variability_On = false;
     bool extractAll = false;
+    // Simplify presence conditions with BDDs (see CondBDD)
+    bool bdd = false;
     std::string nameMatch = "";
-    std::regex cfgVarRegex;
     
     // Do we extract all variables as config variables
     bool allVariables() const {
@@ -1,35 +1,59 @@
 #include "IgnoreMatcher.h"
 
-#include <fstream>
-
-#include <boost/algorithm/string.hpp>
-
 using namespace std;
 namespace fs = boost::filesystem;
-namespace ba = boost::algorithm;
 
 IgnoreMatcher::IgnoreMatcher() {}
 
-// Adds a source directory. These should NOT be ignored during traversal.
-void IgnoreMatcher::addSourceDir(const fs::path &sourceDir) {
-    if (!pattern.empty()) {
-        pattern += '|';
+// Call func with each non-empty component of the given '/' separated path.
+// Stops early as soon as func returns false.
+template<class Func>
+static void forEachComponent(const string &path, Func &&func) {
+    size_t start = 0;
+    while (start < path.size()) {
+        size_t end = path.find('/', start);
+        if (end == string::npos) {
+            end = path.size();
+        }
+        if (end > start && !func(path.substr(start, end - start))) {
+            return;
+        }
+        start = end + 1;
     }
+}
 
-    // only match if this path is the prefix of the path being checked
-    pattern += '^';
+// Adds a source directory. These should NOT be ignored during traversal.
+void IgnoreMatcher::addSourceDir(const fs::path &sourceDir) {
     // prefix matching only works if we use the absolute path
-    if (sourceDir.is_absolute()) {
-        pattern += sourceDir.string();
-    } else {
-        pattern += fs::canonical(sourceDir).string();
-    }
-
-    // Reload the matcher with the latest pattern
-    matcher = regex(pattern);
+    string dir = sourceDir.is_absolute() ? sourceDir.string() : fs::canonical(sourceDir).string();
+
+    Node *node = &root;
+    forEachComponent(dir, [&node](const string &component) {
+        unique_ptr<Node> &child = node->children[component];
+        if (!child) {
+            child.reset(new Node);
+        }
+        node = child.get();
+        return true;
+    });
+    node->isSourceDir = true;
 }
 
 bool IgnoreMatcher::shouldIgnore(const string &path) const {
-    // Ignore anything that isn't within the pattern of source directories
-    return !regex_search(path, matcher);
+    // Ignore anything that isn't within one of the source directories
+    const Node *node = &root;
+    if (node->isSourceDir) {
+        return false;
+    }
+    // Stops either when we run out of matching components or as soon as we
+    // are within a source directory
+    forEachComponent(path, [&node](const string &component) {
+        auto child = node->children.find(component);
+        if (child == node->children.end()) {
+            return false;
+        }
+        node = child->second.get();
+        return !node->isSourceDir;
+    });
+    return !node->isSourceDir;
 }
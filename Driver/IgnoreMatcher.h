@@ -1,15 +1,29 @@
 #pragma once
 
+#include <memory> // for unique_ptr
 #include <string> // for string
-#include <regex> // for regex
+#include <unordered_map> // for unordered_map
 
 #include <boost/filesystem.hpp> // for path
 
+// Decides which files should be ignored during traversal. Anything that isn't
+// within one of the source directories is ignored.
+//
+// Source directories are stored as a trie of path components, so checking a
+// path costs one lookup per component no matter how many source directories
+// there are.
 class IgnoreMatcher {
-    std::string pattern;
-    std::regex matcher;
+    struct Node {
+        std::unordered_map<std::string, std::unique_ptr<Node>> children;
+        // True if a source directory ends at this node
+        bool isSourceDir = false;
+    };
+    Node root;
+
 public:
     IgnoreMatcher();
+    IgnoreMatcher(const IgnoreMatcher &) = delete;
+    IgnoreMatcher &operator=(const IgnoreMatcher &) = delete;
 
     void addSourceDir(const boost::filesystem::path &sourceDir);
 
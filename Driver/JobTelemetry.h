@@ -0,0 +1,44 @@
+#pragma once
+
+// Performance measurements for a single extraction job.
+//
+// Most of these are filled in by the child process running the job and sent
+// back to the parent through a pipe, so this must stay trivially copyable.
+struct JobTelemetry {
+    // Set by the child once it has filled in everything below
+    bool reported = false;
+
+    // Time spent in clang before the walker started (parsing, sema)
+    double parseMs = 0;
+    // Time spent walking the AST
+    double walkMs = 0;
+    // Time spent writing the .tao file
+    double writeMs = 0;
+
+    // When each of the phases above started, in microseconds on the steady
+    // clock (which is shared between processes)
+    long long parseStartUs = 0;
+    long long walkStartUs = 0;
+    long long writeStartUs = 0;
+
+    // Decls/stmts visited by the walker
+    unsigned long numDecls = 0;
+    unsigned long numStmts = 0;
+
+    // Calls to generateID and how many of them were answered from the cache
+    unsigned long numIDLookups = 0;
+    unsigned long numIDCacheHits = 0;
+
+    // Facts written to the .tao file
+    unsigned long numNodes = 0;
+    unsigned long numEdges = 0;
+    unsigned long numUnestablishedEdges = 0;
+
+    // Filled in by the parent
+    double totalMs = 0;
+    // When the parent started the job, after any wait for --mem-budget, in
+    // microseconds on the steady clock
+    long long startUs = 0;
+    // Peak RSS of the child in kilobytes
+    long maxRSS = 0;
+};
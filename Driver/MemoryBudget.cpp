@@ -0,0 +1,77 @@
+#include "MemoryBudget.h"
+
+#include <algorithm> // for max, nth_element
+#include <chrono> // for milliseconds
+#include <fstream> // for ifstream
+#include <string> // for to_string
+
+#include <unistd.h> // for sysconf
+
+using namespace std;
+
+// How often a blocked job re-checks the RSS of the running children. Children
+// don't tell us when their memory use changes, so we have to poll.
+static const chrono::milliseconds POLL_INTERVAL(250);
+
+MemoryBudget::MemoryBudget(unsigned long budget, unsigned int maxJobs) :
+    budget{budget}, initialEstimate{maxJobs ? budget / maxJobs : budget}, reserved{0} {}
+
+// The 90th percentile of the peak RSS seen so far. This is deliberately
+// pessimistic: a few huge TUs running together is what pushes a host into swap.
+unsigned long MemoryBudget::estimate() const {
+    if (peaks.empty()) {
+        return initialEstimate;
+    }
+    vector<unsigned long> sorted(peaks);
+    auto nth = sorted.begin() + (sorted.size() * 9) / 10;
+    nth_element(sorted.begin(), nth, sorted.end());
+    return *nth;
+}
+
+unsigned long MemoryBudget::projectedUsage() const {
+    unsigned long perJob = estimate();
+    unsigned long total = reserved * perJob;
+    for (pid_t child : running) {
+        total += max(currentRSS(child), perJob);
+    }
+    return total;
+}
+
+void MemoryBudget::admit() {
+    unique_lock<mutex> guard(lock);
+    if (budget > 0) {
+        while (reserved + running.size() > 0 && projectedUsage() + estimate() > budget) {
+            released.wait_for(guard, POLL_INTERVAL);
+        }
+    }
+    reserved++;
+}
+
+void MemoryBudget::started(pid_t pid) {
+    lock_guard<mutex> guard(lock);
+    reserved--;
+    running.insert(pid);
+}
+
+void MemoryBudget::finished(pid_t pid, unsigned long peakRSS) {
+    {
+        lock_guard<mutex> guard(lock);
+        running.erase(pid);
+        peaks.push_back(peakRSS);
+    }
+    released.notify_all();
+}
+
+// The resident set size of the given process, or 0 if it has already exited
+unsigned long MemoryBudget::currentRSS(pid_t pid) {
+    static const unsigned long pageSizeKB = sysconf(_SC_PAGESIZE) / 1024;
+
+    // statm: size resident shared text lib data dt (all in pages)
+    ifstream statm("/proc/" + to_string(pid) + "/statm");
+    unsigned long size = 0;
+    unsigned long resident = 0;
+    if (!(statm >> size >> resident)) {
+        return 0;
+    }
+    return resident * pageSizeKB;
+}
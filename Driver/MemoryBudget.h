@@ -0,0 +1,45 @@
+#pragma once
+
+#include <condition_variable> // for condition_variable
+#include <mutex> // for mutex
+#include <unordered_set> // for unordered_set
+#include <vector> // for vector
+
+#include <sys/types.h> // for pid_t
+
+// Admission control for extraction jobs so that the clang child processes
+// running at the same time don't use more memory than the given budget.
+//
+// The peak RSS of every finished job is recorded and used to estimate how much
+// the next job will need. A running child is charged the larger of its current
+// RSS and that estimate. A new job is only started if the projected total fits
+// in the budget, or if nothing else is running (so we always make progress).
+//
+// All sizes are in kilobytes. A budget of 0 disables admission control.
+class MemoryBudget {
+    unsigned long budget;
+    // Used until we have seen at least one job finish
+    unsigned long initialEstimate;
+
+    std::mutex lock;
+    std::condition_variable released;
+    // Jobs that were admitted but have not been forked yet
+    unsigned int reserved;
+    std::unordered_set<pid_t> running;
+    std::vector<unsigned long> peaks;
+
+    unsigned long estimate() const;
+    unsigned long projectedUsage() const;
+
+  public:
+    MemoryBudget(unsigned long budget, unsigned int maxJobs);
+
+    // Blocks until there is enough memory for another job
+    void admit();
+    // The admitted job is now running in the given child process
+    void started(pid_t pid);
+    // The child process exited with the given peak RSS (from wait4)
+    void finished(pid_t pid, unsigned long peakRSS);
+
+    static unsigned long currentRSS(pid_t pid);
+};
@@ -0,0 +1,46 @@
+#include "NamePattern.h"
+
+#include <iostream> // for cerr, endl
+
+using namespace std;
+
+NamePattern::NamePattern(const string &pattern, Mode mode) : pattern{pattern}, mode{mode}, valid{true} {
+    try {
+        regex.assign(pattern, regex::ECMAScript | regex::optimize);
+    } catch (const regex_error &e) {
+        cerr << "Rex Warning: Invalid name pattern '" << pattern << "' (" << e.what()
+             << "). No names will match it." << endl;
+        valid = false;
+    }
+}
+
+bool NamePattern::empty() const {
+    return pattern.empty();
+}
+
+const string &NamePattern::getPattern() const {
+    return pattern;
+}
+
+bool NamePattern::matches(const string &name) const {
+    if (!valid) return false;
+
+    auto found = results.find(name);
+    if (found != results.end()) {
+        return found->second;
+    }
+    bool result = mode == SEARCH ? regex_search(name, regex) : regex_match(name, regex);
+    results.emplace(name, result);
+    return result;
+}
+
+bool NamePattern::matches(const string &name, string &matched) const {
+    if (!valid) return false;
+
+    smatch match;
+    bool result = mode == SEARCH ? regex_search(name, match, regex) : regex_match(name, match, regex);
+    if (result) {
+        matched = match.str();
+    }
+    return result;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <regex> // for regex
+#include <string> // for string
+#include <unordered_map> // for unordered_map
+
+// A name pattern from the extraction config (e.g. nameMatch or
+// callbackFuncRegex), compiled once.
+//
+// The walker checks the same few identifiers over and over, so every answer is
+// cached by name and the regex only ever runs once per distinct name.
+class NamePattern {
+public:
+    enum Mode {
+        // The pattern matches anywhere in the name (regex_search)
+        SEARCH,
+        // The pattern must match the whole name (regex_match)
+        FULL_MATCH,
+    };
+
+private:
+    std::string pattern;
+    Mode mode;
+    // False if the pattern could not be compiled, in which case nothing matches
+    bool valid;
+    std::regex regex;
+    mutable std::unordered_map<std::string, bool> results;
+
+public:
+    NamePattern(const std::string &pattern, Mode mode);
+
+    bool empty() const;
+    const std::string &getPattern() const;
+
+    bool matches(const std::string &name) const;
+    // Like matches, but also returns the part of the name the pattern matched.
+    // Not cached, callers that need the text cache it themselves.
+    bool matches(const std::string &name, std::string &matched) const;
+};
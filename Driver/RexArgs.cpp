@@ -48,6 +48,10 @@ void RexArgs::validate() const {
     if (inputPaths.empty()) {
         throw validation_error("Must provide at least one source file/directory");
     }
+
+    if (reachabilityIndex && snapshotPath.empty()) {
+        throw validation_error("--reachability needs a snapshot to index (see --snapshot)");
+    }
 }
 string RexArgs::configToString(RexArgs::ConfigType type)
 {
@@ -154,6 +158,14 @@ RexArgs RexArgs::processArgs(int argc, const char **argv) {
             "Names cannot start with -(dash). "
             "Linking will be performed if this argument is provided. "
             "This option conflicts with --output,-o and --neo4j,-n.");
+    add_opt("snapshot,s", po::value<fs::path>(&args.snapshotPath)->default_value("")->implicit_value("./out.rexsnap"),
+            "Name of a graph snapshot file to write after linking. The snapshot is a compact, read-only form of "
+            "the linked graph that can be memory mapped by later analyses instead of parsing the output. "
+            "Linking will be performed if this argument is provided. Can be combined with any other output.");
+    add_opt("reachability", po::value<bool>(&args.reachabilityIndex)->default_value(false)->implicit_value(true),
+            "Flag for writing a reachability index over call, write, varWrite, parWrite and varInfFunc edges "
+            "next to the snapshot (as <snapshot>.rexreach), so that `query --from --to` can answer "
+            "whether one node reaches another without walking the graph. Requires --snapshot,-s.");
      add_opt("barebones,b", po::value<bool>(&args.clangOnly)->default_value(false)->implicit_value(true),
         "Flag for running a barebones version of Rex that only walks AST.");
      add_opt("incremental,i", po::value<bool>(&args.incremental)->default_value(false)->implicit_value(true),
@@ -188,8 +200,34 @@ RexArgs RexArgs::processArgs(int argc, const char **argv) {
               "Flag for turning Variability on without setting other variability options. ");
     add_opt("cfg", po::value<bool>(&args.buildCFG)->default_value(false)->implicit_value(true),
              "Flag for building and including CFG information");
+    add_opt("stream-link", po::value<bool>(&args.streamLink)->default_value(false)->implicit_value(true),
+             "Flag for linking object files as soon as their extraction job finishes, "
+             "overlapping linking with extraction. Nodes and edges may be interleaved in the output.");
+    add_opt("prune-ignored", po::value<bool>(&args.pruneIgnored)->default_value(false)->implicit_value(true),
+             "Flag for skipping namespaces, classes and functions that are entirely in ignored or system "
+             "headers instead of walking them. Referenced declarations from those headers still get nodes.");
+    add_opt("lean-frontend", po::value<bool>(&args.leanFrontend)->default_value(false)->implicit_value(true),
+             "Flag for having clang skip parsing function bodies in ignored or system headers. Signatures, "
+             "types and template bodies are kept, but other functions from those headers are extracted as "
+             "declarations only.");
+    add_opt("mem-budget", po::value<unsigned long>(&args.memBudget)->default_value(0),
+             "Memory budget in megabytes shared by all concurrent jobs. A job is only started if the "
+             "projected memory use of the running jobs plus the new one fits in the budget. "
+             "0 means no limit.");
+    add_opt("job-timeout", po::value<unsigned int>(&args.jobTimeout)->default_value(0),
+             "Wall-clock limit in seconds for a single job. Jobs that run past it are killed and "
+             "retried once without CFG and variability. 0 means no limit.");
+    add_opt("trace", po::value<fs::path>(&args.tracePath)->default_value("")->implicit_value("./trace.json"),
+             "Name of a Chrome trace event file (viewable in Perfetto or chrome://tracing) to write a timeline "
+             "of every job and linking phase to.");
+    add_opt("job-mem-limit", po::value<unsigned long>(&args.jobMemLimit)->default_value(0),
+             "Address space limit in megabytes for a single job. Jobs that run out of memory are "
+             "retried once without CFG and variability. 0 means no limit.");
      add_opt("extract_All_PCs,A", po::value<bool>(&vOpts->extractAll)->default_value(false)->implicit_value(true),
               "Flag for choosing to extract all conditions as presence conditions, including function calls.");
+     add_opt("bdd", po::value<bool>(&vOpts->bdd)->default_value(false)->implicit_value(true),
+              "Flag for simplifying presence conditions with binary decision diagrams, so that a fact seen "
+              "under several conditions gets one minimal condition instead of a growing disjunction.");
 
     // HACK: Prevent positional options from showing up in help message
     // See: https://stackoverflow.com/a/39934380/551904
@@ -240,6 +278,12 @@ RexArgs RexArgs::processArgs(int argc, const char **argv) {
         // file will end up wherever clang decides the current directory should be.
         args.outputPath = fs::absolute(args.outputPath);
     }
+    if (!args.tracePath.empty()) {
+        args.tracePath = fs::absolute(args.tracePath);
+    }
+    if (!args.snapshotPath.empty()) {
+        args.snapshotPath = fs::absolute(args.snapshotPath);
+    }
 
     // get absolute path of the header file locations
     vector<boost::filesystem::path> absolutePaths = vector<boost::filesystem::path>();
@@ -309,6 +353,38 @@ bool RexArgs::shouldBuildCFG() const{
     return buildCFG;
 }
 
+bool RexArgs::shouldStreamLink() const{
+    return streamLink;
+}
+
+bool RexArgs::shouldPruneIgnored() const{
+    return pruneIgnored;
+}
+
+bool RexArgs::useLeanFrontend() const{
+    return leanFrontend;
+}
+
+// The memory budget for concurrent jobs in megabytes. 0 if there is no budget.
+unsigned long RexArgs::getMemoryBudget() const{
+    return memBudget;
+}
+
+// The wall-clock limit for a single job in seconds. 0 if there is no limit.
+unsigned int RexArgs::getJobTimeout() const{
+    return jobTimeout;
+}
+
+// The address space limit for a single job in megabytes. 0 if there is no limit.
+unsigned long RexArgs::getJobMemoryLimit() const{
+    return jobMemLimit;
+}
+
+// The destination path of the trace event timeline. Empty if no path was provided.
+const boost::filesystem::path &RexArgs::getTracePath() const{
+    return tracePath;
+}
+
 VariabilityOptions RexArgs::getVariabilityOptions() const
 {
     const ConfigOption &opt = config.get(configToString(VARIABILITY));
@@ -342,3 +418,12 @@ const boost::filesystem::path &RexArgs::getNeo4jCypherPath() const{
 const std::vector<boost::filesystem::path> &RexArgs::getNeo4jCsvPaths() const{
     return neo4jCsvPaths;
 }
+
+// The destination path of the graph snapshot. Empty if no path was provided.
+const boost::filesystem::path &RexArgs::getSnapshotPath() const{
+    return snapshotPath;
+}
+
+bool RexArgs::shouldBuildReachabilityIndex() const{
+    return reachabilityIndex;
+}
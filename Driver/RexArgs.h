@@ -14,10 +14,19 @@ class RexArgs {
     boost::filesystem::path outputPath;
     boost::filesystem::path neo4jCypherPath;
     std::vector<boost::filesystem::path> neo4jCsvPaths;
+    boost::filesystem::path snapshotPath;
+    bool reachabilityIndex;
 	std::string prog;
 	bool clangOnly;
     bool incremental; 
 	bool buildCFG;
+    bool streamLink;
+    bool pruneIgnored;
+    bool leanFrontend;
+    unsigned long memBudget;
+    unsigned int jobTimeout;
+    unsigned long jobMemLimit;
+    boost::filesystem::path tracePath;
     
     // This enapsulates the configuration options that we support
     // for extraction, e.g. Variability Options
@@ -47,12 +56,21 @@ class RexArgs {
     const boost::filesystem::path &getOutputPath() const;
   const boost::filesystem::path &getNeo4jCypherPath() const;
   const std::vector<boost::filesystem::path> &getNeo4jCsvPaths() const;
+    const boost::filesystem::path &getSnapshotPath() const;
+    bool shouldBuildReachabilityIndex() const;
 
     const std::string getProg() const;
     bool isBareBones() const;
     bool isIncremental() const;
     
     bool shouldBuildCFG() const;
+    bool shouldStreamLink() const;
+    bool shouldPruneIgnored() const;
+    bool useLeanFrontend() const;
+    unsigned long getMemoryBudget() const;
+    unsigned int getJobTimeout() const;
+    unsigned long getJobMemoryLimit() const;
+    const boost::filesystem::path &getTracePath() const;
 
     VariabilityOptions getVariabilityOptions() const;
     LanguageFeatureOptions getLanguageFeaturesOptions() const;
@@ -26,18 +26,27 @@
 /////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 #include <chrono>   // high_resolution_clock
+#include <condition_variable> // condition_variable
+#include <deque>    // deque
+#include <exception> // exception_ptr, current_exception, rethrow_exception
 #include <iostream> // cout
 #include <mutex>    // mutex
 #include <string>   // string, getline
 #include <thread>   // thread
 #include <vector>   // vector
 #include <sys/wait.h> 
+#include <sys/resource.h> // rusage
+#include <cerrno>   // errno
+#include <csignal>  // kill
 
 #include <boost/filesystem.hpp>
 
 #include "Analysis.h"
 #include "RexArgs.h"
+#include "RexQuery.h"
 #include "IgnoreMatcher.h"
+#include "MemoryBudget.h"
+#include "TraceWriter.h"
 #include "ToolRunner.h"
 #include "ThrowsWithTrace.h"
 #include "../Linker/Linker.h"
@@ -45,9 +54,13 @@
 #include "../Linker/TAWriter.h"
 #include "../Linker/CSVWriter.h"
 #include "../Linker/CypherWriter.h"
+#include "../Linker/GraphSnapshot.h"
+#include "../Linker/ReachabilityIndex.h"
+#include "../Linker/TeeWriter.h"
 
 #include <semaphore.h>
 #include <fcntl.h>
+#include <unistd.h> // pipe2
 
 #include <chrono>
 #include <ctime>  
@@ -75,6 +88,44 @@ fs::path *globFailLogPath;
 fs::ofstream *infoLogWriter;
 fs::path *infoLogPath;
 
+// Hands the .tao files of finished jobs from the extraction workers over to
+// the streaming linker thread.
+class ObjectFileQueue {
+    mutex lock;
+    condition_variable ready;
+    deque<fs::path> files;
+    bool closed = false;
+
+  public:
+    void push(const fs::path &path) {
+        {
+            lock_guard<mutex> guard(lock);
+            files.push_back(path);
+        }
+        ready.notify_one();
+    }
+
+    // No more files will be pushed after this
+    void close() {
+        {
+            lock_guard<mutex> guard(lock);
+            closed = true;
+        }
+        ready.notify_all();
+    }
+
+    // Blocks until a file is available. Returns false once the queue has been
+    // closed and every file has been handed out.
+    bool pop(fs::path &path) {
+        unique_lock<mutex> guard(lock);
+        ready.wait(guard, [this]() { return closed || !files.empty(); });
+        if (files.empty()) return false;
+        path = files.front();
+        files.pop_front();
+        return true;
+    }
+};
+
 // This is intended for handling errors with
 // extraction processes ONLY. Do not use this
 // signal handler for anything else
@@ -94,10 +145,188 @@ void handleSignal(int signum)
 }
 
 
+// Run a single job in a child process and wait for it to finish.
+//
+// The child is limited to the address space given by --job-mem-limit and is
+// killed if it runs for longer than --job-timeout. limitHit is set if either of
+// those happened. If degraded is true, the job is run without building the CFG
+// and without variability.
+//
+// The child reports its telemetry back through a pipe. Anything it could not
+// report (e.g. because it crashed) is left at zero.
+static Analysis::Job::Status runJob(const Analysis::Job &job, const IgnoreMatcher &ignored, const RexArgs &args,
+                                    bool degraded, MemoryBudget &memBudget,
+                                    const fs::path &failLogPath, fs::ofstream &failLogWriter,
+                                    bool &limitHit, JobTelemetry &telemetry) {
+    limitHit = false;
+    telemetry = JobTelemetry{};
+
+    // Wait until there is enough memory to run another job
+    memBudget.admit();
+
+    // Non-blocking since other workers fork at the same time and their
+    // children inherit our write end, so we may never see EOF on it
+    int telemetryPipe[2];
+    if (pipe2(telemetryPipe, O_NONBLOCK) != 0) {
+        telemetryPipe[0] = telemetryPipe[1] = -1;
+    }
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+    // Anything other than an exit status counts as a failure
+    int childStatus = -1;
+	pid_t child_pid = fork();
+    //pid_t child_pid = 0;
+	if(child_pid == 0)
+	{
+		// In child process
+		close(telemetryPipe[0]);
+		ToolRunner::limitAddressSpace(args.getJobMemoryLimit());
+		ToolRunner jobRunner(job, ignored, args, degraded, &telemetry);
+		int exitStatus;
+		try
+		{
+			exitStatus = jobRunner.run();
+		}
+		catch(const exception &e)
+		{
+			sem_t *failureLogMutex = sem_open("failLogSem", 0);
+			sem_wait(failureLogMutex);
+			failLogWriter.open(failLogPath, ios::app);
+			failLogWriter << "Failure on " << job.sourcePath.string() << ": " << e.what() << endl;
+			const boost::stacktrace::stacktrace* st = boost::get_error_info<traced>(e);
+			if (st) 
+			{
+				failLogWriter << *st << endl;
+			}
+			else
+			{
+				failLogWriter << "Stack unavailable. Did you try throw_with_trace?" << endl;
+			}
+			failLogWriter.close();
+			sem_post(failureLogMutex);
+			raise(SIGTERM);
+		}
+		catch(...)
+		{
+			sem_t *failureLogMutex = sem_open("failLogSem", 0);
+			sem_wait(failureLogMutex);
+			failLogWriter.open(failLogPath, ios::app);
+			failLogWriter << "Unknown Failure on " << job.sourcePath.string() << endl;
+			failLogWriter.close();
+			sem_post(failureLogMutex);
+			raise(SIGTERM);
+		}
+		// Small enough to be written atomically
+		(void) !write(telemetryPipe[1], &telemetry, sizeof(telemetry));
+		exit(exitStatus);
+	}
+
+	close(telemetryPipe[1]);
+	memBudget.started(child_pid);
+	// waitpid/wait4 have no timeout, so when a timeout is set the child is
+	// polled instead and killed once it runs past the deadline
+	unsigned int timeout = args.getJobTimeout();
+	chrono::steady_clock::time_point deadline = chrono::steady_clock::now() + chrono::seconds(timeout);
+	struct rusage childUsage = {};
+	while (true)
+	{
+		pid_t waited = wait4(child_pid, &childStatus, timeout ? WNOHANG : 0, &childUsage);
+		if (waited == child_pid || (waited < 0 && errno != EINTR))
+		{
+			break;
+		}
+		if (timeout && chrono::steady_clock::now() >= deadline)
+		{
+			cerr << "Rex Warning: " << job.sourcePath.string() << " timed out after " << timeout << " seconds" << endl;
+			kill(child_pid, SIGKILL);
+			wait4(child_pid, &childStatus, 0, &childUsage);
+			limitHit = true;
+			break;
+		}
+		this_thread::sleep_for(chrono::milliseconds(100));
+	}
+	// ru_maxrss is the peak RSS of the child in kilobytes
+	memBudget.finished(child_pid, childUsage.ru_maxrss);
+
+	// The child has exited, so whatever it managed to report is in the pipe
+	if (read(telemetryPipe[0], &telemetry, sizeof(telemetry)) != sizeof(telemetry)) {
+		telemetry = JobTelemetry{};
+	}
+	close(telemetryPipe[0]);
+	chrono::duration<double, milli> totalTime = chrono::steady_clock::now() - start;
+	telemetry.totalMs = totalTime.count();
+	telemetry.startUs = TraceWriter::toMicroseconds(start);
+	telemetry.maxRSS = childUsage.ru_maxrss;
+
+	// Child process exits gracefully
+	if(!limitHit && WIFEXITED(childStatus))
+	{
+		// No Compilation Errors
+		if(WEXITSTATUS(childStatus) == EXIT_SUCCESS)
+		{
+			return Analysis::Job::Status::SUCCESS;
+		}
+		// Ran out of memory under --job-mem-limit
+		if(WEXITSTATUS(childStatus) == ToolRunner::OUT_OF_MEMORY_EXIT)
+		{
+			cerr << "Rex Warning: " << job.sourcePath.string() << " ran out of memory" << endl;
+			limitHit = true;
+			return Analysis::Job::Status::FAIL;
+		}
+		// Compilation Errors
+		return Analysis::Job::Status::COMPLETE_WITH_ERROR;
+	}
+	// Child process crashed, was killed or an exception was raised
+	return Analysis::Job::Status::FAIL;
+}
+
+// Add the phases of the link to the trace, if there is one
+static LinkTracer linkTracer(TraceWriter *trace) {
+    if (!trace) {
+        return nullptr;
+    }
+    return [trace](const string &phase, TraceWriter::Clock::time_point start, TraceWriter::Clock::time_point end,
+                   const string &detail) {
+        trace->addSpan(phase, "link", TraceWriter::LINKER_TRACK, start, end, detail);
+    };
+}
+
+// Add a single run of a job to the trace, along with the phases its child
+// process reported (if it got that far)
+static void traceJob(TraceWriter &trace, unsigned int track, const Analysis::Job &job, bool degraded) {
+    const JobTelemetry &telemetry = job.telemetry;
+    string name = job.sourcePath.filename().string();
+    if (degraded) {
+        name += " (degraded)";
+    }
+    TraceWriter::Clock::time_point start = TraceWriter::fromMicroseconds(telemetry.startUs);
+    TraceWriter::Clock::time_point end = start + chrono::microseconds((long long) (telemetry.totalMs * 1000));
+    trace.addSpan(name, "job", track, start, end, job.sourcePath.string());
+    if (!telemetry.reported) {
+        return;
+    }
+
+    TraceWriter::Clock::time_point walkStart = TraceWriter::fromMicroseconds(telemetry.walkStartUs);
+    TraceWriter::Clock::time_point writeStart = TraceWriter::fromMicroseconds(telemetry.writeStartUs);
+    trace.addSpan("clang", "job", track, TraceWriter::fromMicroseconds(telemetry.parseStartUs),
+                  telemetry.walkStartUs ? walkStart : writeStart);
+    if (telemetry.walkStartUs) {
+        trace.addSpan("walk", "job", track, walkStart,
+                      walkStart + chrono::microseconds((long long) (telemetry.walkMs * 1000)));
+    }
+    trace.addSpan("write", "job", track, writeStart,
+                  writeStart + chrono::microseconds((long long) (telemetry.writeMs * 1000)));
+}
+
 // Run all of the given jobs in parallel.
 //
+// If linkQueue is not null, the object file of every job that produced one is
+// pushed onto it as soon as that job finishes. If trace is not null, every job
+// is added to it on the track of the worker that ran it.
+//
 // Returns true if all clang invocations succeeded without any errors
-static bool runParallelJobs(const RexArgs &args, Analysis &analysis, const IgnoreMatcher &ignored) {
+static bool runParallelJobs(const RexArgs &args, Analysis &analysis, const IgnoreMatcher &ignored,
+                            ObjectFileQueue *linkQueue, TraceWriter *trace) {
     // Goal: Achieve maximum concurrency by having a simple job "queue" that
     // allows threads to take the next job as soon as they are ready.
     //
@@ -112,6 +341,8 @@ static bool runParallelJobs(const RexArgs &args, Analysis &analysis, const Ignor
     unsigned int nextJob = 0;
     bool allSuccess = true;
 
+    // Budget is given in megabytes but RSS is tracked in kilobytes
+    MemoryBudget memBudget(args.getMemoryBudget() * 1024, nthreads);
 
 	fs::path failLogPath(args.getOutputPath().parent_path());
 	failLogPath /= "logs";
@@ -133,8 +364,13 @@ static bool runParallelJobs(const RexArgs &args, Analysis &analysis, const Ignor
     cout << "Instantiating " << nthreads << " workers" << endl;
     for (unsigned int i = 0; i < nthreads; i++) {
         cout << "Spawning worker thread #" << (i + 1) << endl;
+        // Track 0 is the linker
+        unsigned int track = i + 1;
+        if (trace) {
+            trace->nameTrack(track, "Worker #" + to_string(track));
+        }
         threads.push_back(thread(
-            [&sharedState, &nextJob, &allSuccess, &analysis, &ignored, &args, &failLogPath, &failLogWriter]() {
+            [&sharedState, &nextJob, &allSuccess, &analysis, &ignored, &args, &failLogPath, &failLogWriter, &memBudget, linkQueue, trace, track]() {
                 // true if the last job that was run was successful
                 bool lastSuccess = true;
                 while (true) {
@@ -152,78 +388,41 @@ static bool runParallelJobs(const RexArgs &args, Analysis &analysis, const Ignor
                     cout << "Analyzing " << myJob.sourcePath << endl;
                     currJob = &myJob;
                     sharedState.unlock();
-                    
-                    int childStatus;
-					pid_t child_pid = fork();
-                    //pid_t child_pid = 0;
-					if(child_pid == 0)
-					{
-						// In child process
-						ToolRunner jobRunner(myJob, ignored, args);
-						int exitStatus;				
-						try
-						{
-							exitStatus = jobRunner.run();
-						}
-						catch(const exception &e)
-						{
-							sem_t *failureLogMutex = sem_open("failLogSem", 0);
-							sem_wait(failureLogMutex);
-							failLogWriter.open(failLogPath, ios::app);
-							failLogWriter << "Failure on " << myJob.sourcePath.string() << ": " << e.what() << endl;
-							const boost::stacktrace::stacktrace* st = boost::get_error_info<traced>(e);
-							if (st) 
-							{
-								failLogWriter << *st << endl;
-							}
-							else
-							{
-								failLogWriter << "Stack unavailable. Did you try throw_with_trace?" << endl;
-							}
-							failLogWriter.close();
-							sem_post(failureLogMutex);
-							raise(SIGTERM);
-						}
-						catch(...)
-						{
-							sem_t *failureLogMutex = sem_open("failLogSem", 0);
-							sem_wait(failureLogMutex);
-							failLogWriter.open(failLogPath, ios::app);
-							failLogWriter << "Unknown Failure on " << myJob.sourcePath.string() << endl;
-							failLogWriter.close();
-							sem_post(failureLogMutex);
-							raise(SIGTERM);
-						}
-						exit(exitStatus);
-					}
-					else
-					{						
-						// This suspends execution of the calling thread (and not process) until the
-						// child process with id 'child_pid' has terminated. If the child process has already terminated, 
-						// then the call returns immediately
-						waitpid(child_pid, &childStatus, 0);
-						// Child process exits gracefully
-						if(WIFEXITED(childStatus))
-						{
-							// No Compilation Errors
-							if(WEXITSTATUS(childStatus) == EXIT_SUCCESS)
-							{
-								myJob.status = Analysis::Job::Status::SUCCESS;
-							}
-							// Compilation Errors
-							else
-							{
-							    myJob.status = Analysis::Job::Status::COMPLETE_WITH_ERROR;
-							}
-						}
-						// Child process crashed or an exception was raised
-						else
-						{
-							myJob.status = Analysis::Job::Status::FAIL;
-							lastSuccess = false;
-						}						
-					
-					}
+
+                    // Jobs that hit their resource limits are retried once
+                    // with the expensive parts of extraction turned off
+                    bool limitHit = false;
+                    myJob.status = runJob(myJob, ignored, args, false, memBudget, failLogPath, failLogWriter, limitHit, myJob.telemetry);
+                    if (trace) {
+                        traceJob(*trace, track, myJob, false);
+                    }
+                    if (limitHit) {
+                        cerr << "Rex Warning: " << myJob.sourcePath.string() << " hit its resource limits. "
+                             << "Retrying without CFG and variability." << endl;
+                        Analysis::Job::Status retryStatus = runJob(myJob, ignored, args, true, memBudget, failLogPath, failLogWriter, limitHit, myJob.telemetry);
+                        if (trace) {
+                            traceJob(*trace, track, myJob, true);
+                        }
+                        if (retryStatus == Analysis::Job::Status::FAIL || limitHit) {
+                            myJob.status = Analysis::Job::Status::FAIL;
+                        } else {
+                            myJob.status = Analysis::Job::Status::COMPLETE_DEGRADED;
+                        }
+                    }
+
+                    // A degraded retry that completed still produced an
+                    // object file, it is only reported separately
+                    if (myJob.status == Analysis::Job::Status::FAIL) {
+                        lastSuccess = false;
+                    } else if (myJob.status == Analysis::Job::Status::COMPLETE_DEGRADED) {
+                        cerr << "Rex Warning: " << myJob.sourcePath.string()
+                             << " completed without CFG and variability" << endl;
+                    }
+
+                    if (linkQueue && myJob.status != Analysis::Job::Status::FAIL)
+                    {
+                        linkQueue->push(myJob.objectFilePath);
+                    }
                 }
             }
         ));
@@ -239,8 +438,121 @@ static bool runParallelJobs(const RexArgs &args, Analysis &analysis, const Ignor
 }
 
 
+// Run all of the jobs while linking their object files into the given writer
+// as they finish. Any extra object files are linked first.
+//
+// extractEnd is set to the time at which the last job finished, and allSuccess
+// to whether all clang invocations succeeded without any errors.
+//
+// Anything thrown while linking (e.g. a malformed .tao file) is rethrown once
+// extraction is over, so the link fails without cutting extraction short.
+template<class Writer>
+static void runStreamingLink(const RexArgs &args, Analysis &analysis, const IgnoreMatcher &ignored,
+                             Writer &writer, chrono::high_resolution_clock::time_point &extractEnd,
+                             bool &allSuccess, TraceWriter *trace) {
+    StreamingLinker<Writer> linker(writer, linkTracer(trace));
+    ObjectFileQueue linkQueue;
+    // No jobs have run yet, so this is just the extra object files
+    for (const fs::path &taoFile : analysis.getAllObjectFiles()) {
+        linkQueue.push(taoFile);
+    }
+
+    exception_ptr linkError;
+    thread linkThread([&linker, &linkQueue, &linkError]() {
+        fs::path taoFile;
+        try {
+            while (linkQueue.pop(taoFile)) {
+                linker.addObjectFile(taoFile);
+            }
+        } catch (...) {
+            // The queue is unbounded, so the workers can keep pushing files
+            // that are never linked
+            linkError = current_exception();
+        }
+    });
+
+    allSuccess = runParallelJobs(args, analysis, ignored, &linkQueue, trace);
+    extractEnd = chrono::high_resolution_clock::now();
+
+    linkQueue.close();
+    linkThread.join();
+    if (linkError) {
+        rethrow_exception(linkError);
+    }
+    cout << "Finishing link of " << analysis.getAllObjectFiles().size() << " object files..." << endl;
+    linker.finish();
+}
+
+// Freeze the linked graph and write it to the snapshot path, followed by its
+// reachability index if one was asked for.
+//
+// Throws runtime_error if either can't be written.
+static void writeSnapshot(const SnapshotWriter &snapshot, const RexArgs &args, TraceWriter *trace) {
+    const fs::path &path = args.getSnapshotPath();
+    TraceWriter::Clock::time_point start = TraceWriter::Clock::now();
+    {
+        fs::ofstream snapshotFile(path, ios::binary);
+        snapshot.write(snapshotFile);
+        if (!snapshotFile) {
+            throw runtime_error("Unable to write snapshot " + path.string());
+        }
+    }
+    endLinkPhase("Wrote Snapshot", start, linkTracer(trace));
+
+    if (args.shouldBuildReachabilityIndex()) {
+        start = TraceWriter::Clock::now();
+        fs::path indexPath = reachabilityIndexPath(path);
+        try {
+            // Built from the written snapshot so that both number the nodes the same way
+            GraphSnapshot graph(path);
+            ReachabilityIndex index = ReachabilityIndex::build(graph);
+            fs::ofstream indexFile(indexPath, ios::binary);
+            index.write(indexFile);
+            if (!indexFile) {
+                throw runtime_error("Unable to write " + indexPath.string());
+            }
+        } catch (runtime_error &e) {
+            // Don't leave an index behind that doesn't match the snapshot
+            boost::system::error_code removeError;
+            fs::remove(indexPath, removeError);
+            throw runtime_error(string("Reachability index not written: ") + e.what());
+        }
+        endLinkPhase("Wrote Reachability Index", start, linkTracer(trace));
+    }
+}
+
+// Call link with the given writer. If a snapshot was asked for, it is built
+// from the same link and written once link returns.
+template<class Writer, class Link>
+static void linkWithSnapshot(Writer &writer, const RexArgs &args, TraceWriter *trace, Link &&link) {
+    // Attribute values read during the link are freed once it is written
+    RexAttributes::InternScope values;
+    if (args.getSnapshotPath().empty()) {
+        link(writer);
+        return;
+    }
+    SnapshotWriter snapshot;
+    TeeWriter<Writer, SnapshotWriter> both(writer, snapshot);
+    link(both);
+    writeSnapshot(snapshot, args, trace);
+}
+
+// Call link with only a snapshot writer and write the snapshot
+template<class Link>
+static void linkSnapshot(const RexArgs &args, TraceWriter *trace, Link &&link) {
+    RexAttributes::InternScope values;
+    SnapshotWriter snapshot;
+    link(snapshot);
+    writeSnapshot(snapshot, args, trace);
+}
+
 int main(int argc, const char **argv) {
     using namespace std::chrono;
+
+    // Subcommands come before any of the extraction options
+    if (argc > 1 && string(argv[1]) == "query") {
+        return runQuery(argc, argv);
+    }
     
 	sem_open(FAIL_LOG_SEM_NAME, O_CREAT, 0644, 1);
 	
@@ -248,10 +560,13 @@ int main(int argc, const char **argv) {
     const fs::path &outputPath = args.getOutputPath();
     const fs::path &neo4jCypherPath = args.getNeo4jCypherPath();
     vector<fs::path> neo4jCsvPaths = args.getNeo4jCsvPaths();
+    const fs::path &snapshotPath = args.getSnapshotPath();
 
     bool outputTA = !outputPath.empty();
     bool outputCypher = !neo4jCypherPath.empty();
     bool outputCSVs = !neo4jCsvPaths.empty();
+    // Not an output format, a snapshot can be written alongside any of them
+    bool outputSnapshot = !snapshotPath.empty();
 
     int linkingOptions = 0;
     if (outputTA) { linkingOptions++; }
@@ -264,7 +579,9 @@ int main(int argc, const char **argv) {
       return 1;
     }
 
-    bool performLinking = linkingOptions == 1;
+    bool performLinking = linkingOptions == 1 || outputSnapshot;
+    // Nothing to overlap with if there is nothing to extract
+    bool streamLinking = false;
 
     if (outputCSVs) {
       if (neo4jCsvPaths.size() > 2) {
@@ -280,6 +597,28 @@ int main(int argc, const char **argv) {
     if (!performLinking && analysis.hasExtraObjectFiles()) {
         cerr << "Rex Warning: Provided .tao files even though not linking (no output filename)" << endl;
     }
+    if (args.shouldStreamLink()) {
+        if (performLinking) {
+            streamLinking = analysis.hasJobs();
+        } else {
+            cerr << "Rex Warning: Ignoring --stream-link since no output format was selected" << endl;
+        }
+    }
+
+    // Output streams are opened up front so that streaming linking can write
+    // to them while extraction is still running
+    fs::ofstream outputFile;
+    fs::ofstream nodesFile;
+    fs::ofstream edgesFile;
+    // When streaming, set to when extraction finished and linking took over
+    high_resolution_clock::time_point extractEnd;
+
+    // Only collect a timeline if one was asked for
+    TraceWriter traceWriter;
+    TraceWriter *trace = args.getTracePath().empty() ? nullptr : &traceWriter;
+    if (trace) {
+        trace->nameTrack(TraceWriter::LINKER_TRACK, "Linker");
+    }
 
     // create information.log file in output path
     fs::path infoLogPath(args.getOutputPath().parent_path());
@@ -306,6 +645,8 @@ int main(int argc, const char **argv) {
     infoLogWriter << endl;
     infoCSVWriter << ",";
 
+    // Set if linking threw, in which case the output is incomplete
+    bool linkFailed = false;
     if (analysis.hasJobs()) {
         // Time how long extration takes
         high_resolution_clock::time_point start = high_resolution_clock::now();
@@ -318,12 +659,50 @@ int main(int argc, const char **argv) {
             ignored.addSourceDir(sourceDir);
         }
 
-        if (!runParallelJobs(args, analysis, ignored)) {
+        bool allSuccess = true;
+        if (!streamLinking) {
+            allSuccess = runParallelJobs(args, analysis, ignored, nullptr, trace);
+            extractEnd = high_resolution_clock::now();
+        } else {
+            auto streamLink = [&](auto &writer) {
+                runStreamingLink(args, analysis, ignored, writer, extractEnd, allSuccess, trace);
+            };
+            try {
+                if (outputTA) {
+                    outputFile.open(outputPath);
+                    TAWriter taFile(outputFile);
+                    linkWithSnapshot(taFile, args, trace, streamLink);
+                } else if (outputCSVs) {
+                    nodesFile.open(neo4jCsvPaths[0]);
+                    edgesFile.open(neo4jCsvPaths[1]);
+                    CSVWriter csvFiles(nodesFile, edgesFile);
+                    linkWithSnapshot(csvFiles, args, trace, streamLink);
+                } else if (outputCypher) {
+                    outputFile.open(neo4jCypherPath);
+                    CypherWriter cypherFile(outputFile);
+                    linkWithSnapshot(cypherFile, args, trace, streamLink);
+                } else {
+                    linkSnapshot(args, trace, streamLink);
+                }
+            } catch (exception &e) {
+                cerr << "Rex Error: Linking failed: " << e.what() << endl;
+                infoLogWriter << "Linking failed: " << e.what() << endl;
+                linkFailed = true;
+            }
+        }
+
+        if (!allSuccess) {
             cout << "Rex Warning: Some files failed to compile. You may want to re-run after fixing the errors." << endl;
         }
+        unsigned int numDegraded = analysis.countJobs(Analysis::Job::COMPLETE_DEGRADED);
+        if (numDegraded > 0) {
+            cout << "Rex Warning: " << numDegraded << " files hit their resource limits and were extracted "
+                 << "without CFG and variability. See logs/telemetry.csv." << endl;
+            infoLogWriter << "Degraded: " << numDegraded << " files extracted without CFG and variability" << endl;
+        }
 
         // print extraction time in command line
-        high_resolution_clock::time_point end = high_resolution_clock::now();
+        high_resolution_clock::time_point end = extractEnd;
         //auto duration = duration_cast<std::chrono::milliseconds>(end - start).count();
         std::chrono::duration<double, std::milli> duration = end - start;
         auto end_sys = std::chrono::system_clock::now();
@@ -334,36 +713,59 @@ int main(int argc, const char **argv) {
         infoLogWriter << std::ctime(&end_time)  << "Completed in " << duration.count() << " milliseconds" << endl;
         infoCSVWriter << duration.count() << ",";
         infoLogWriter << endl;
+
+        // Per-job timings and sizes go next to the failure log
+        analysis.writeDiagnostics(args.getOutputPath().parent_path() / "logs");
     }
 
     if (performLinking) {
-        // Time how long linking takes
-        high_resolution_clock::time_point start = high_resolution_clock::now();
+        // Time how long linking takes. When streaming, linking already ran
+        // alongside extraction so this is only the time spent after it.
+        high_resolution_clock::time_point start = streamLinking ? extractEnd : high_resolution_clock::now();
         auto start_sys = std::chrono::system_clock::now();
         std::time_t start_time = std::chrono::system_clock::to_time_t(start_sys);
         infoLogWriter << "Starting Linking: " << std::ctime(&start_time);
 
-        const vector<fs::path> taoFiles = analysis.getAllObjectFiles();
-        cout << "Linking " << taoFiles.size() << " object files..." << endl;
-
-        if (outputTA) {
-          fs::ofstream outputFile(outputPath);
-          TAWriter taFile(outputFile);
-          linkObjectFiles(taoFiles, taFile);
-        }
-
-        if (outputCSVs) {
-          fs::ofstream nodesFile(neo4jCsvPaths[0]);
-          fs::ofstream edgesFile(neo4jCsvPaths[1]);
-          CSVWriter csvFiles(nodesFile, edgesFile);
-          linkObjectFiles(taoFiles, csvFiles);
-        }
-
-        if (outputCypher) {
-          fs::ofstream outputFile(neo4jCypherPath);
-          CypherWriter cypherFile(outputFile);
-          linkObjectFiles(taoFiles, cypherFile);
+        if (!streamLinking) {
+            const vector<fs::path> taoFiles = analysis.getAllObjectFiles();
+            cout << "Linking " << taoFiles.size() << " object files..." << endl;
+
+            auto link = [&taoFiles, trace](auto &writer) {
+              linkObjectFiles(taoFiles, writer, linkTracer(trace));
+            };
+
+            try {
+              if (outputTA) {
+                outputFile.open(outputPath);
+                TAWriter taFile(outputFile);
+                linkWithSnapshot(taFile, args, trace, link);
+              }
+
+              if (outputCSVs) {
+                nodesFile.open(neo4jCsvPaths[0]);
+                edgesFile.open(neo4jCsvPaths[1]);
+                CSVWriter csvFiles(nodesFile, edgesFile);
+                linkWithSnapshot(csvFiles, args, trace, link);
+              }
+
+              if (outputCypher) {
+                outputFile.open(neo4jCypherPath);
+                CypherWriter cypherFile(outputFile);
+                linkWithSnapshot(cypherFile, args, trace, link);
+              }
+
+              if (linkingOptions == 0) {
+                linkSnapshot(args, trace, link);
+              }
+            } catch (exception &e) {
+              cerr << "Rex Error: Linking failed: " << e.what() << endl;
+              infoLogWriter << "Linking failed: " << e.what() << endl;
+              linkFailed = true;
+            }
         }
+        outputFile.close();
+        nodesFile.close();
+        edgesFile.close();
 
         // print linking time in commandline
         high_resolution_clock::time_point end = high_resolution_clock::now();
@@ -379,7 +781,12 @@ int main(int argc, const char **argv) {
         infoCSVWriter << duration.count() << endl;
     }
 
+    if (trace) {
+        trace->write(args.getTracePath());
+        cout << "Wrote trace to " << args.getTracePath().string() << endl;
+    }
+
     infoLogWriter.close();
     infoCSVWriter.close();
-    return 0;
+    return linkFailed ? 1 : 0;
 }
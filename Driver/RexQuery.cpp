@@ -0,0 +1,167 @@
+#include "RexQuery.h"
+
+#include <chrono> // high_resolution_clock
+#include <exception> // exception
+#include <iostream> // cout, cerr, endl
+#include <thread> // hardware_concurrency
+#include <vector> // vector
+
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp> // fs::ifstream, fs::ofstream
+#include <boost/program_options.hpp>
+
+#include "../Linker/GraphSnapshot.h"
+#include "../Linker/ReachabilityIndex.h"
+#include "../Query/PathQuery.h"
+#include "../Query/RelationScript.h"
+
+using namespace std;
+namespace fs = boost::filesystem;
+namespace po = boost::program_options;
+
+static void printHelp(const char *program_name, const po::options_description &desc) {
+    cerr << "Usage: " << program_name << " query [OPTIONS] <snapshot> <resultCSV>" << endl;
+    cerr << "       " << program_name << " query [OPTIONS] --script <script>... <snapshot>" << endl;
+    cerr << "       " << program_name << " query --from <ID> --to <ID> <snapshot>" << endl;
+    cerr << endl;
+    cerr << "Find the behaviour alteration paths in a graph snapshot (see --snapshot)" << endl;
+    cerr << "whose facts can happen in that order according to the CFG. This is" << endl;
+    cerr << "the same check as stack_based.py, without a Neo4j server." << endl;
+    cerr << endl;
+    cerr << "With --script, run a script in the relational part of grok (composition," << endl;
+    cerr << "union, difference, closure, ...) on the snapshot instead and print its results." << endl;
+    cerr << "Scripts given more than once run in order and share their variables." << endl;
+    cerr << endl;
+    cerr << "With --from and --to, look up whether one node reaches the other in the" << endl;
+    cerr << "reachability index written next to the snapshot (see --reachability)." << endl;
+    cerr << endl;
+
+    cerr << desc;
+}
+
+int runQuery(int argc, const char **argv) {
+    unsigned int cpus = max(thread::hardware_concurrency(), 1u);
+    PathQuery::Options options;
+    options.jobs = cpus;
+    fs::path snapshotPath;
+    fs::path resultPath;
+    vector<fs::path> scriptPaths;
+    string fromID;
+    string toID;
+
+    po::options_description desc("OPTIONS");
+    auto add_opt = desc.add_options();
+    add_opt("help,h", "Produce this help message");
+    add_opt("jobs,j", po::value<unsigned int>(&options.jobs)->default_value(cpus),
+            "The number of threads checking paths or evaluating a script at the same time.");
+    add_opt("max-length", po::value<unsigned int>(&options.maxLength)->default_value(0),
+            "Only consider paths with at most this many call, write and varWrite edges. "
+            "0 means no limit.");
+    add_opt("script", po::value<vector<fs::path>>(&scriptPaths),
+            "Run this relational script (see Query/RelationScript.h) instead of the path check. "
+            "Can be given more than once.");
+    add_opt("from", po::value<string>(&fromID), "ID of the node to check reachability from. Requires --to.");
+    add_opt("to", po::value<string>(&toID), "ID of the node to check reachability to. Requires --from.");
+
+    // HACK: Prevent positional options from showing up in help message
+    // See: https://stackoverflow.com/a/39934380/551904
+    po::options_description pos_desc;
+    pos_desc.add_options()("snapshot", po::value<fs::path>(&snapshotPath), "The graph snapshot to query");
+    pos_desc.add_options()("result", po::value<fs::path>(&resultPath), "The CSV file to write valid paths to");
+    po::options_description full_desc;
+    full_desc.add(desc).add(pos_desc);
+
+    po::positional_options_description pos_opts;
+    pos_opts.add("snapshot", 1);
+    pos_opts.add("result", 1);
+
+    po::variables_map vm;
+    try {
+        // The parser skips the first argument, which here is "query"
+        auto parsed = po::command_line_parser(argc - 1, argv + 1).options(full_desc).positional(pos_opts).run();
+        po::store(parsed, vm);
+        po::notify(vm);
+
+        if (vm.count("help")) {
+            printHelp(argv[0], desc);
+            return 0;
+        }
+        if (snapshotPath.empty()) {
+            throw po::error("Must provide a snapshot");
+        }
+        if (fromID.empty() != toID.empty()) {
+            throw po::error("--from and --to must be used together");
+        }
+        if (!resultPath.empty() + !scriptPaths.empty() + !fromID.empty() != 1) {
+            throw po::error("Must provide exactly one of a result CSV file, a script or --from and --to");
+        }
+        if (options.jobs < 1) {
+            throw po::error("Cannot have 0 jobs");
+        }
+    } catch (exception &e) {
+        cerr << "Error while parsing command line arguments:" << endl;
+        cerr << e.what() << endl
+             << endl;
+        printHelp(argv[0], desc);
+        return 1;
+    }
+
+    using namespace std::chrono;
+    high_resolution_clock::time_point start = high_resolution_clock::now();
+    try {
+        GraphSnapshot graph(snapshotPath);
+        duration<double, milli> loadTime = high_resolution_clock::now() - start;
+        // Scripts print their results to stdout, so that they can be piped into
+        // the TriageCheck helper scripts like the output of grok
+        ostream &log = resultPath.empty() ? cerr : cout;
+        log << "Loaded " << graph.numNodes() << " nodes and " << graph.numEdges() << " edges in "
+            << loadTime.count() << " milliseconds" << endl;
+
+        if (!scriptPaths.empty()) {
+            RelationScript relationScript(graph, options.jobs);
+            for (const fs::path &scriptPath : scriptPaths) {
+                fs::ifstream script(scriptPath);
+                if (!script.is_open()) {
+                    cerr << "Rex Error: Unable to open " << scriptPath.string() << endl;
+                    return 1;
+                }
+                try {
+                    relationScript.run(script, cout);
+                } catch (runtime_error &e) {
+                    throw runtime_error(scriptPath.string() + ", " + e.what());
+                }
+            }
+
+            duration<double, milli> scriptTime = high_resolution_clock::now() - start;
+            cerr << "Finished script in " << scriptTime.count() << " milliseconds" << endl;
+            return 0;
+        }
+
+        if (!fromID.empty()) {
+            ReachabilityIndex index(reachabilityIndexPath(snapshotPath), graph);
+            uint32_t from = graph.findNode(fromID);
+            uint32_t to = graph.findNode(toID);
+            if (from == GraphSnapshot::NO_NODE || to == GraphSnapshot::NO_NODE) {
+                cerr << "Rex Error: No node with ID " << (from == GraphSnapshot::NO_NODE ? fromID : toID) << endl;
+                return 1;
+            }
+            cout << fromID << (index.reaches(from, to) ? " reaches " : " does not reach ") << toID << endl;
+            return 0;
+        }
+
+        fs::ofstream resultCSV(resultPath);
+        if (!resultCSV.is_open()) {
+            cerr << "Rex Error: Unable to open " << resultPath.string() << endl;
+            return 1;
+        }
+        PathQuery query(graph);
+        query.run(options, cout, resultCSV);
+    } catch (runtime_error &e) {
+        cerr << "Rex Error: " << e.what() << endl;
+        return 1;
+    }
+
+    duration<double, milli> queryTime = high_resolution_clock::now() - start;
+    cout << "Finished query in " << queryTime.count() << " milliseconds" << endl;
+    return 0;
+}
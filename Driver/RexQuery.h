@@ -0,0 +1,8 @@
+#pragma once
+
+// Runs `Rex query`, which analyzes a graph snapshot written by --snapshot
+// instead of extracting anything. Takes the full command line, starting with
+// the program name followed by "query".
+//
+// Returns the exit status of the program.
+int runQuery(int argc, const char **argv);
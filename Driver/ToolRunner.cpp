@@ -2,10 +2,16 @@
 
 #include <vector>
 #include <iostream>
+#include <chrono>
+#include <new> // set_new_handler
+
+#include <sys/resource.h> // setrlimit
+#include <unistd.h> // _exit
 
 #include <boost/filesystem/fstream.hpp> // fs::ofstream
 #include <clang/Tooling/CommonOptionsParser.h>
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/ErrorHandling.h"
 #include <clang/Tooling/Tooling.h>
 
 #include "../Graph/TAGraph.h"
@@ -58,8 +64,36 @@ static string extractPackageName(const vector<CompileCommand> &compCommands) {
     return packageName;
 }
 
-ToolRunner::ToolRunner(const Analysis::Job &job, const IgnoreMatcher &ignored, const RexArgs &args):
-    job{job}, ignored{ignored}, args{args} {}
+ToolRunner::ToolRunner(const Analysis::Job &job, const IgnoreMatcher &ignored, const RexArgs &args, bool degraded,
+                       JobTelemetry *telemetry):
+    job{job}, ignored{ignored}, args{args}, degraded{degraded}, telemetry{telemetry} {}
+
+static void exitOutOfMemory() {
+    // Nothing fancy here, we may not be able to allocate anything
+    static const char message[] = "Rex Warning: Job ran out of memory\n";
+    (void) !write(STDERR_FILENO, message, sizeof(message) - 1);
+    _exit(ToolRunner::OUT_OF_MEMORY_EXIT);
+}
+
+void ToolRunner::limitAddressSpace(unsigned long megabytes) {
+    if (megabytes == 0) {
+        return;
+    }
+    struct rlimit limit;
+    limit.rlim_cur = megabytes * 1024 * 1024;
+    limit.rlim_max = limit.rlim_cur;
+    if (setrlimit(RLIMIT_AS, &limit) != 0) {
+        cerr << "Rex Warning: Unable to limit job memory to " << megabytes << " MB" << endl;
+        return;
+    }
+    // Both operator new and LLVM's own allocators need to report failures as
+    // running out of memory so the job can be retried instead of crashing
+    set_new_handler(exitOutOfMemory);
+    // The type of the reason argument differs between LLVM versions
+    llvm::install_bad_alloc_error_handler([](void *, auto, bool) {
+        exitOutOfMemory();
+    });
+}
 
 // Run the given analysis job through clang
 //
@@ -165,10 +199,23 @@ int ToolRunner::run() const {
 
     // Need to pass a graph from here because there is no way to retrieve
     // anything once ClangTool has run (as far as we know)
-    TAGraph graph;
-    WalkerConfig config(graph, ignored, featureName, args.isBareBones(), args.shouldBuildCFG(), args.getVariabilityOptions(), args.getLanguageFeaturesOptions(), args.getGuidedExtractionOptions(), args.getROSFeaturesOptions());
+    //
+    // Jobs run in their own process, which exits as soon as we return, so the
+    // graph is deliberately never destroyed. Tearing down every node and edge
+    // would only delay the exit.
+    TAGraph &graph = *new TAGraph;
+    // A degraded run turns off the features that are most likely to blow up
+    // on pathological files so we can at least keep the rest of the facts
+    bool buildCFG = args.shouldBuildCFG() && !degraded;
+    VariabilityOptions vOpts = degraded ? VariabilityOptions{} : args.getVariabilityOptions();
+    WalkerConfig config(graph, ignored, featureName, args.isBareBones(), buildCFG, vOpts, args.getLanguageFeaturesOptions(), args.getGuidedExtractionOptions(), args.getROSFeaturesOptions());
+    config.pruneIgnored = args.shouldPruneIgnored();
+    config.leanFrontend = args.useLeanFrontend();
+    config.telemetry = telemetry;
     ROSFrontendActionFactory factory(config);
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
     int code = tool.run(&factory);
+    chrono::steady_clock::time_point end = chrono::steady_clock::now();
 
 	// Store the generated graph in out special object file format
 	TAObjectWriter objFileContents(graph);
@@ -179,5 +226,19 @@ int ToolRunner::run() const {
     }
     objFile << objFileContents;
     cout << "Wrote " << job.sourcePath.string() << " to " << job.objectFilePath.string() << endl;
+
+    if (telemetry) {
+        // The walker records its own time, everything else clang did counts as parsing
+        chrono::duration<double, milli> toolTime = end - start;
+        chrono::duration<double, milli> writeTime = chrono::steady_clock::now() - end;
+        telemetry->parseMs = toolTime.count() - telemetry->walkMs;
+        telemetry->writeMs = writeTime.count();
+        telemetry->parseStartUs = chrono::duration_cast<chrono::microseconds>(start.time_since_epoch()).count();
+        telemetry->writeStartUs = chrono::duration_cast<chrono::microseconds>(end.time_since_epoch()).count();
+        telemetry->numNodes = graph.keptNodes();
+        telemetry->numEdges = graph.establishedEdgesSize();
+        telemetry->numUnestablishedEdges = graph.unestablishedEdgesSize();
+        telemetry->reported = true;
+    }
     return code;
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Analysis.h"
+#include "JobTelemetry.h"
 #include <string>
 
 class IgnoreMatcher;
@@ -12,9 +13,22 @@ class ToolRunner {
     const Analysis::Job &job;
     const IgnoreMatcher &ignored;
     const RexArgs &args;
+    // Skip the expensive parts of extraction (CFG, variability)
+    bool degraded;
+    // Where to record timings and counts, if anywhere
+    JobTelemetry *telemetry;
 
   public:
-    ToolRunner(const Analysis::Job &job, const IgnoreMatcher &ignored,  const RexArgs &args);
+    // Exit status of a job that ran out of memory under limitAddressSpace
+    static const int OUT_OF_MEMORY_EXIT = 75;
+
+    ToolRunner(const Analysis::Job &job, const IgnoreMatcher &ignored,  const RexArgs &args, bool degraded = false,
+               JobTelemetry *telemetry = nullptr);
 
     int run() const;
+
+    // Limit the address space of the current process to the given number of
+    // megabytes. Running out of memory afterwards exits with OUT_OF_MEMORY_EXIT.
+    // Does nothing if megabytes is 0.
+    static void limitAddressSpace(unsigned long megabytes);
 };
@@ -0,0 +1,69 @@
+#include "TraceWriter.h"
+
+#include <boost/filesystem/fstream.hpp> // fs::ofstream
+
+#include "../JSON/json.h"
+
+using namespace std;
+namespace fs = boost::filesystem;
+
+TraceWriter::TraceWriter() : origin{Clock::now()} {}
+
+void TraceWriter::nameTrack(unsigned int track, const string &name) {
+    lock_guard<mutex> guard(lock);
+    trackNames.emplace_back(track, name);
+}
+
+void TraceWriter::addSpan(const string &name, const string &category, unsigned int track,
+                          Clock::time_point start, Clock::time_point end, const string &detail) {
+    lock_guard<mutex> guard(lock);
+    spans.push_back(Span{name, category, track, start, end, detail});
+}
+
+// Writes every span as a complete ("X") event. Timestamps are in microseconds
+// relative to when this TraceWriter was created.
+void TraceWriter::write(const fs::path &path) {
+    lock_guard<mutex> guard(lock);
+
+    Json::Value events(Json::arrayValue);
+    for (const auto &track : trackNames) {
+        Json::Value event;
+        event["name"] = "thread_name";
+        event["ph"] = "M";
+        event["pid"] = 1;
+        event["tid"] = track.first;
+        event["args"]["name"] = track.second;
+        events.append(event);
+    }
+    for (const Span &span : spans) {
+        Json::Value event;
+        event["name"] = span.name;
+        event["cat"] = span.category;
+        event["ph"] = "X";
+        event["pid"] = 1;
+        event["tid"] = span.track;
+        event["ts"] = Json::Int64(toMicroseconds(span.start) - toMicroseconds(origin));
+        event["dur"] = Json::Int64(toMicroseconds(span.end) - toMicroseconds(span.start));
+        if (!span.detail.empty()) {
+            event["args"]["detail"] = span.detail;
+        }
+        events.append(event);
+    }
+
+    Json::Value trace;
+    trace["traceEvents"] = events;
+    trace["displayTimeUnit"] = "ms";
+
+    fs::ofstream out(path);
+    Json::StreamWriterBuilder builder;
+    builder["indentation"] = "";
+    out << Json::writeString(builder, trace) << endl;
+}
+
+long long TraceWriter::toMicroseconds(Clock::time_point time) {
+    return chrono::duration_cast<chrono::microseconds>(time.time_since_epoch()).count();
+}
+
+TraceWriter::Clock::time_point TraceWriter::fromMicroseconds(long long micros) {
+    return Clock::time_point(chrono::duration_cast<Clock::duration>(chrono::microseconds(micros)));
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <chrono> // for steady_clock
+#include <mutex> // for mutex
+#include <string> // for string
+#include <vector> // for vector
+
+#include <boost/filesystem.hpp> // for path
+
+// Collects spans for a timeline of a Rex run and writes them out in the Chrome
+// trace event format (viewable in Perfetto or chrome://tracing).
+//
+// Each span belongs to a track, which shows up as a separate row in the
+// viewer. Spans may be added from any thread.
+class TraceWriter {
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    // Tracks that aren't extraction workers
+    static const unsigned int LINKER_TRACK = 0;
+
+  private:
+    struct Span {
+        std::string name;
+        std::string category;
+        unsigned int track;
+        Clock::time_point start;
+        Clock::time_point end;
+        std::string detail;
+    };
+
+    Clock::time_point origin;
+    std::mutex lock;
+    std::vector<Span> spans;
+    std::vector<std::pair<unsigned int, std::string>> trackNames;
+
+  public:
+    TraceWriter();
+
+    void nameTrack(unsigned int track, const std::string &name);
+    void addSpan(const std::string &name, const std::string &category, unsigned int track,
+                 Clock::time_point start, Clock::time_point end, const std::string &detail = "");
+
+    void write(const boost::filesystem::path &path);
+
+    // Time points have to cross process boundaries as plain integers
+    static long long toMicroseconds(Clock::time_point time);
+    static Clock::time_point fromMicroseconds(long long micros);
+};
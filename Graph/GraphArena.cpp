@@ -0,0 +1,93 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// GraphArena.cpp
+//
+// Bump allocator for the nodes and edges of a TAGraph.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "GraphArena.h"
+#include <functional>
+#include <new>
+using namespace std;
+
+GraphArena *GraphArena::current = nullptr;
+
+GraphArena::GraphArena() : next{nullptr}, end{nullptr}, previous{current} {
+    current = this;
+}
+
+GraphArena::~GraphArena() {
+    if (current == this) {
+        current = previous;
+    }
+    for (auto &chunk : chunks) {
+        ::operator delete(const_cast<char *>(chunk.first));
+    }
+}
+
+/**
+ * Allocates memory suitably aligned for any graph element.
+ * @param size The number of bytes needed.
+ * @return The allocated memory.
+ */
+void *GraphArena::allocate(size_t size) {
+    const size_t align = alignof(max_align_t);
+    size = (size + align - 1) & ~(align - 1);
+
+    if (size > (size_t) (end - next)) {
+        // Anything too big for a chunk gets one of its own so the rest of the
+        // current chunk isn't wasted
+        if (size > CHUNK_SIZE / 4) {
+            char *chunk = static_cast<char *>(::operator new(size));
+            chunks.emplace(chunk, chunk + size);
+            return chunk;
+        }
+        next = static_cast<char *>(::operator new(CHUNK_SIZE));
+        end = next + CHUNK_SIZE;
+        chunks.emplace(next, end);
+    }
+
+    void *ptr = next;
+    next += size;
+    return ptr;
+}
+
+/**
+ * Checks whether the given memory came from this arena.
+ * @param ptr The memory to check.
+ * @return Whether the arena owns it.
+ */
+bool GraphArena::owns(const void *ptr) const {
+    const char *p = static_cast<const char *>(ptr);
+    auto chunk = chunks.upper_bound(p);
+    if (chunk == chunks.begin()) {
+        return false;
+    }
+    --chunk;
+    return less<const char *>()(p, chunk->second);
+}
+
+void *GraphArena::allocateElement(size_t size) {
+    return current ? current->allocate(size) : ::operator new(size);
+}
+
+void GraphArena::freeElement(void *ptr) {
+    for (GraphArena *arena = current; arena; arena = arena->previous) {
+        if (arena->owns(ptr)) {
+            return;
+        }
+    }
+    ::operator delete(ptr);
+}
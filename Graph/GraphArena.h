@@ -0,0 +1,63 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// GraphArena.h
+//
+// Bump allocator for the nodes and edges of a TAGraph.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef REX_GRAPHARENA_H
+#define REX_GRAPHARENA_H
+
+#include <cstddef>
+#include <map>
+
+// A translation unit produces hundreds of thousands of small nodes and edges
+// that all live exactly as long as their graph. Instead of allocating them one
+// by one, they are carved out of large chunks that are only ever released all
+// at once, when the arena is destroyed.
+//
+// While an arena exists it is the current one, and RexNode and RexEdge are
+// allocated from it (see allocateElement), so `new RexNode(...)` keeps working
+// everywhere. Arenas must be destroyed in the reverse order of their creation.
+class GraphArena {
+public:
+    GraphArena();
+    ~GraphArena();
+    GraphArena(const GraphArena &) = delete;
+    GraphArena &operator=(const GraphArena &) = delete;
+
+    void *allocate(std::size_t size);
+    bool owns(const void *ptr) const;
+
+    // Allocates from the current arena, or the heap if there is none
+    static void *allocateElement(std::size_t size);
+    // Frees memory from allocateElement. Memory owned by an arena is left for
+    // the arena to release.
+    static void freeElement(void *ptr);
+
+private:
+    static const std::size_t CHUNK_SIZE = 256 * 1024;
+
+    // Start to end of every chunk, ordered so owns() is a single lookup
+    std::map<const char *, const char *> chunks;
+    char *next;
+    char *end;
+    // The current arena before this one was created
+    GraphArena *previous;
+
+    static GraphArena *current;
+};
+
+#endif // REX_GRAPHARENA_H
@@ -0,0 +1,106 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// NameHash.h
+//
+// Compile-time perfect hash for the fixed lists
+// of type and attribute names.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef REX_NAMEHASH_H
+#define REX_NAMEHASH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Maps each of N names to its index in the list they were given in.
+//
+// The constructor searches for a seed under which no two names share a slot,
+// so when it is evaluated at compile time (i.e. the NameHash is constexpr),
+// looking up a name only costs hashing it and one string comparison.
+template<std::size_t N>
+class NameHash {
+    // At least four slots per name so that a seed is found quickly
+    static constexpr unsigned int bitsFor(std::size_t n) {
+        unsigned int bits = 1;
+        while ((std::size_t(1) << bits) < 4 * n) {
+            bits++;
+        }
+        return bits;
+    }
+    static constexpr unsigned int BITS = bitsFor(N);
+    static constexpr std::size_t SLOTS = std::size_t(1) << BITS;
+
+    const char *names[N];
+    uint64_t seed;
+    // Index + 1 of the name in each slot, 0 if the slot is empty
+    uint16_t slots[SLOTS];
+
+    // FNV-1a
+    static constexpr uint64_t hash(const char *s, std::size_t length) {
+        uint64_t h = 0xcbf29ce484222325ull;
+        for (std::size_t i = 0; i < length; i++) {
+            h = (h ^ static_cast<unsigned char>(s[i])) * 0x100000001b3ull;
+        }
+        return h;
+    }
+
+    static constexpr std::size_t length(const char *s) {
+        std::size_t n = 0;
+        while (s[n]) {
+            n++;
+        }
+        return n;
+    }
+
+    constexpr std::size_t slotOf(uint64_t h) const {
+        return ((h ^ seed) * 0x9e3779b97f4a7c15ull) >> (64 - BITS);
+    }
+
+    constexpr bool tryFill(const uint64_t (&hashes)[N]) {
+        for (std::size_t i = 0; i < SLOTS; i++) {
+            slots[i] = 0;
+        }
+        for (std::size_t i = 0; i < N; i++) {
+            std::size_t slot = slotOf(hashes[i]);
+            if (slots[slot] != 0) {
+                return false;
+            }
+            slots[slot] = i + 1;
+        }
+        return true;
+    }
+
+public:
+    constexpr explicit NameHash(const char *const (&names)[N]) : names{}, seed{0}, slots{} {
+        uint64_t hashes[N] = {};
+        for (std::size_t i = 0; i < N; i++) {
+            this->names[i] = names[i];
+            hashes[i] = hash(names[i], length(names[i]));
+        }
+        // Names must be distinct or this never ends
+        while (!tryFill(hashes)) {
+            seed++;
+        }
+    }
+
+    // The index of the given name, or -1 if it isn't one of the names
+    int find(const std::string &name) const {
+        unsigned int slot = slots[slotOf(hash(name.data(), name.size()))];
+        return slot != 0 && name == names[slot - 1] ? slot - 1 : -1;
+    }
+};
+
+#endif // REX_NAMEHASH_H
@@ -0,0 +1,141 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// RexAttributes.cpp
+//
+// Attribute keys and the flat attribute storage
+// shared by nodes, edges and the linker.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "RexAttributes.h"
+#include "NameHash.h"
+#include <algorithm>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_set>
+using namespace std;
+
+static constexpr const char *attributeNames[] = {
+#define REX_ATTRIBUTE_NAME(key, name) name,
+    REX_ATTRIBUTES(REX_ATTRIBUTE_NAME)
+#undef REX_ATTRIBUTE_NAME
+};
+static constexpr NameHash<RexAttribute::NUM_KEYS> attributeHash{attributeNames};
+
+/**
+ * Converts an attribute key to its name.
+ * @param key The attribute key.
+ * @return The name of the attribute.
+ */
+const char *RexAttribute::keyToString(Key key) {
+    if (key >= NUM_KEYS) {
+        throw domain_error("Unknown attribute key");
+    }
+    return attributeNames[key];
+}
+
+/**
+ * Converts an attribute name to its key.
+ * @param s The name of the attribute.
+ * @return The attribute key.
+ */
+RexAttribute::Key RexAttribute::stringToKey(const string &s) {
+    int key = attributeHash.find(s);
+    if (key < 0) {
+        throw domain_error("Unknown attribute: " + s);
+    }
+    return static_cast<Key>(key);
+}
+
+template<class Entry>
+static typename vector<Entry>::iterator findEntry(vector<Entry> &entries, RexAttribute::Key key) {
+    return lower_bound(entries.begin(), entries.end(), key, [](const Entry &entry, RexAttribute::Key key) {
+        return entry.key < key;
+    });
+}
+
+template<class Entry>
+static typename vector<Entry>::const_iterator findEntry(const vector<Entry> &entries, RexAttribute::Key key) {
+    return findEntry(const_cast<vector<Entry> &>(entries), key);
+}
+
+void RexAttributes::set(RexAttribute::Key key, const string &value) {
+    auto entry = findEntry(singleAttrs, key);
+    if (entry != singleAttrs.end() && entry->key == key) {
+        entry->value = intern(value);
+    } else {
+        singleAttrs.insert(entry, Single{key, intern(value)});
+    }
+}
+
+void RexAttributes::add(RexAttribute::Key key, const string &value) {
+    auto entry = findEntry(multiAttrs, key);
+    if (entry == multiAttrs.end() || entry->key != key) {
+        entry = multiAttrs.insert(entry, Multi{key, {}});
+    }
+    entry->values.push_back(intern(value));
+}
+
+const string *RexAttributes::get(RexAttribute::Key key) const {
+    auto entry = findEntry(singleAttrs, key);
+    return entry != singleAttrs.end() && entry->key == key ? entry->value : nullptr;
+}
+
+const vector<const string *> *RexAttributes::getAll(RexAttribute::Key key) const {
+    auto entry = findEntry(multiAttrs, key);
+    return entry != multiAttrs.end() && entry->key == key ? &entry->values : nullptr;
+}
+
+const vector<RexAttributes::Single> &RexAttributes::singles() const {
+    return singleAttrs;
+}
+
+const vector<RexAttributes::Multi> &RexAttributes::multis() const {
+    return multiAttrs;
+}
+
+bool RexAttributes::empty() const {
+    return singleAttrs.empty() && multiAttrs.empty();
+}
+
+void RexAttributes::clear() {
+    singleAttrs.clear();
+    multiAttrs.clear();
+}
+
+// The innermost scope open on this thread
+static thread_local RexAttributes::InternScope *currentScope = nullptr;
+
+RexAttributes::InternScope::InternScope() : outer{currentScope} {
+    currentScope = this;
+}
+
+RexAttributes::InternScope::~InternScope() {
+    currentScope = outer;
+}
+
+const string *RexAttributes::InternScope::intern(const string &value) {
+    return &*values.insert(value).first;
+}
+
+const string *RexAttributes::intern(const string &value) {
+    if (currentScope) {
+        return currentScope->intern(value);
+    }
+    // Never shrinks, the same values keep coming back for the whole job
+    static unordered_set<string> values;
+    static mutex valuesMutex;
+    lock_guard<mutex> lock(valuesMutex);
+    return &*values.insert(value).first;
+}
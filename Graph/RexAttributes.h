@@ -0,0 +1,136 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// RexAttributes.h
+//
+// Attribute keys and the flat attribute storage
+// shared by nodes, edges and the linker.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef REX_REXATTRIBUTES_H
+#define REX_REXATTRIBUTES_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+// Every attribute that can be recorded on a node or an edge, as (key, name).
+// Both RexAttribute::Key and the TASchemeAttribute name constants are
+// generated from this list.
+//
+// NOTE: Keep this sorted by name. Attributes are stored and written in key
+// order, which then matches the order of their names.
+#define REX_ATTRIBUTES(X) \
+    X(LINE_NUMBER, "LINE_NUMBER") \
+    X(ROS_TOPIC_BUFFER_SIZE, "bufferSize") \
+    X(ROS_CALLBACK, "callbackFunc") \
+    X(CFG_CALLING_FUNCTION_ID, "callingFunctionID") \
+    X(CFG_INVOKE, "cfgInvoke") \
+    X(CFG_RETURN, "cfgReturn") \
+    X(CLASS_STYLE, "class_style") \
+    X(COLOR, "color") \
+    X(PRESENCE_CONDITION, "condition") \
+    X(FILE, "file") \
+    X(FILENAME, "filename") \
+    X(FILENAME_DECLARE, "filenameDeclare") \
+    X(CFG_FUNCTION, "function") \
+    X(ROS_IS_CALLBACK, "isCallbackFunc") \
+    X(IS_CONTROL_FLOW, "isControlFlow") \
+    X(ROS_TIMER_IS_ONESHOT, "isOneshot") \
+    X(IS_PARAM, "isParam") \
+    X(IS_PUBLISHER, "isPublisher") \
+    X(IS_STATIC, "isStatic") \
+    X(IS_SUBSCRIBER, "isSubscriber") \
+    X(IS_UNDER_CONTROL, "isUnderControl") \
+    X(LABEL, "label") \
+    X(LINE, "line") \
+    X(NO_DEF, "noDef") \
+    X(ROS_NUM_ATTRIBUTES, "numAttributes") \
+    X(ROS_PUBLISHER_DATA, "pubData") \
+    X(ROS_PUBLISHER_TYPE, "publisherType") \
+    X(ROS_NUMBER, "rosNumber") \
+    X(ROS_TIMER_DURATION, "timerDuration")
+
+class RexAttribute {
+public:
+    enum Key : uint8_t {
+#define REX_ATTRIBUTE_KEY(key, name) key,
+        REX_ATTRIBUTES(REX_ATTRIBUTE_KEY)
+#undef REX_ATTRIBUTE_KEY
+        // This must always be the last variant
+        NUM_KEYS
+    };
+    static const char *keyToString(Key key);
+    static Key stringToKey(const std::string &s);
+};
+
+// The attributes of a single node or edge.
+//
+// Facts only have a handful of attributes each, so they are kept in two small
+// vectors sorted by key instead of maps. Values are interned, since the same
+// labels, file names and flags are repeated on thousands of facts.
+class RexAttributes {
+public:
+    // Owns the values interned by its thread while it is open, and frees them
+    // once closed. Without one, values are kept for the rest of the process,
+    // which suits a walker job but not the linker, so every link opens its own
+    // around reading the object files and writing the output. Attributes must
+    // not outlive the scope they were set in.
+    class InternScope {
+        std::unordered_set<std::string> values;
+        InternScope *outer;
+
+    public:
+        InternScope();
+        ~InternScope();
+        InternScope(const InternScope &) = delete;
+        InternScope &operator=(const InternScope &) = delete;
+
+        const std::string *intern(const std::string &value);
+    };
+
+    struct Single {
+        RexAttribute::Key key;
+        const std::string *value;
+    };
+    struct Multi {
+        RexAttribute::Key key;
+        std::vector<const std::string *> values;
+    };
+
+    // Sets an attribute that only has one value, replacing any previous value
+    void set(RexAttribute::Key key, const std::string &value);
+    // Adds a value to an attribute that has multiple values
+    void add(RexAttribute::Key key, const std::string &value);
+
+    // nullptr if the attribute isn't set
+    const std::string *get(RexAttribute::Key key) const;
+    const std::vector<const std::string *> *getAll(RexAttribute::Key key) const;
+
+    // In order of their keys
+    const std::vector<Single> &singles() const;
+    const std::vector<Multi> &multis() const;
+
+    bool empty() const;
+    void clear();
+
+private:
+    std::vector<Single> singleAttrs;
+    std::vector<Multi> multiAttrs;
+
+    static const std::string *intern(const std::string &value);
+};
+
+#endif // REX_REXATTRIBUTES_H
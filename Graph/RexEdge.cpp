@@ -28,122 +28,72 @@
 /////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 #include "RexEdge.h"
+#include "GraphArena.h"
+#include "NameHash.h"
 #include <iostream>
 #include <stdexcept>
 #include "../Walker/CondScope.h"
+#include "../Walker/CondBDD.h"
 
 using namespace std;
 
+void *RexEdge::operator new(size_t size) {
+    return GraphArena::allocateElement(size);
+}
+
+void RexEdge::operator delete(void *ptr) {
+    GraphArena::freeElement(ptr);
+}
+
+static constexpr const char *edgeTypeNames[] = {
+#define REX_EDGE_TYPE_NAME(type, name, source, destination) name,
+    REX_EDGE_TYPES(REX_EDGE_TYPE_NAME)
+#undef REX_EDGE_TYPE_NAME
+};
+static constexpr NameHash<RexEdge::NUM_EDGE_TYPES> edgeTypeHash{edgeTypeNames};
+
 /**
  * Converts an edge type to a string representation.
  * @param type The edge type.
  * @return The string representation.
  */
 const char *RexEdge::typeToString(RexEdge::EdgeType type) {
-    switch (type) {
-        case CONTAINS: return "contain";
-        case REFERENCES: return "reference";
-        case CALLS: return "call";
-        case READS: return "read";
-        case WRITES: return "write";
-        case ADVERTISE: return "advertise";
-        case SUBSCRIBE: return "subscribe";
-        case PUBLISH: return "publish";
-        case VAR_WRITES: return "varWrite";
-        case PAR_WRITES: return "parWrite";
-        case RET_WRITES: return "retWrite";
-        case VAR_INFLUENCE: return "varInfluence";
-        case VAR_INFLUENCE_FUNC: return "varInfFunc";
-        case SET_TIME: return "time";
-        case PUBLISH_VARIABLE: return "pubVar";
-        case PUBLISH_TARGET: return "pubTarget";
-        case OBJ: return "obj";
-        case MUTATE: return "mutate";
-        case NEXT_CFG_BLOCK: return "nextCFGBlock";
-        case RET_CFG_BLOCK: return "retCFGBlock";
-        case FUNCTION_CFG_LINK: return "functionCFGLink";
-        case VW_SOURCE: return "varWriteSource";
-        case VW_DESTINATION: return "varWriteDestination";
-        case PW_SOURCE: return "parWriteSource";
-        case PW_DESTINATION: return "parWriteDestination";
-        case RW_SOURCE: return "retWriteSource";
-        case RW_DESTINATION: return "retWriteDestination";
-        case W_SOURCE: return "writeSource";
-        case W_DESTINATION: return "writeDestination";
-        case VIF_SOURCE: return "varInfFuncSource";
-        case VIF_DESTINATION: return "varInfFuncDestination";
-        case VI_SOURCE: return "varInfluenceSource";
-        case VI_DESTINATION: return "varInfluenceDestination";
-        case C_SOURCE: return "callSource";
-        case C_DESTINATION: return "callDestination";
-        case PV_SOURCE: return "pubVarSource";
-        case PV_DESTINATION: return "pubVarDestination";
-        case PT_SOURCE: return "pubTargetSource";
-        case PT_DESTINATION: return "pubTargetDestination";
-        case SUB_SOURCE: return "subscribeSource";
-        case SUB_DESTINATION: return "subscribeDestination";
-        case PUB_SOURCE: return "publishSource";
-        case PUB_DESTINATION: return "publishDestination";
-//	case LINE_NUMBER: return "lineNumber";
-        // No default case because we want the compiler to warn us when this
-        // enum changes and a case isn't covered
+    if (type >= NUM_EDGE_TYPES) {
+        throw domain_error("Unknown edge type");
+    }
+    return edgeTypeNames[type];
+}
 
-        // Should never happen
-        case NUM_EDGE_TYPES: throw "unreachable";
+RexEdge::EdgeType RexEdge::stringToType(const std::string &s) {
+    int type = edgeTypeHash.find(s);
+    if (type < 0) {
+        throw domain_error("Unknown edge type");
     }
+    return static_cast<EdgeType>(type);
+}
 
-    throw domain_error("Unknown edge type");
+RexNode::NodeType RexEdge::sourceType(RexEdge::EdgeType type) {
+    static constexpr RexNode::NodeType sources[] = {
+#define REX_EDGE_TYPE_SOURCE(type, name, source, destination) RexNode::source,
+        REX_EDGE_TYPES(REX_EDGE_TYPE_SOURCE)
+#undef REX_EDGE_TYPE_SOURCE
+    };
+    if (type >= NUM_EDGE_TYPES) {
+        throw domain_error("Unknown edge type");
+    }
+    return sources[type];
 }
 
-RexEdge::EdgeType RexEdge::stringToType(const std::string &s) {
-    // Unfortunately there is no way to write this code so that the compiler
-    // will warn us to update it. You just have to remember to do that when you
-    // add a new type.
-    if (s == "contain") return CONTAINS;
-    else if (s == "reference") return REFERENCES;
-    else if (s == "call") return CALLS;
-    else if (s == "read") return READS;
-    else if (s == "write") return WRITES;
-    else if (s == "advertise") return ADVERTISE;
-    else if (s == "subscribe") return SUBSCRIBE;
-    else if (s == "publish") return PUBLISH;
-    else if (s == "varWrite") return VAR_WRITES;
-    else if (s == "parWrite") return PAR_WRITES;
-    else if (s == "retWrite") return RET_WRITES;
-    else if (s == "varInfluence") return VAR_INFLUENCE;
-    else if (s == "varInfFunc") return VAR_INFLUENCE_FUNC;
-    else if (s == "time") return SET_TIME;
-    else if (s == "pubVar") return PUBLISH_VARIABLE;
-    else if (s == "pubTarget") return PUBLISH_TARGET;
-    else if (s == "obj") return OBJ;
-    else if (s == "mutate") return MUTATE;
-    else if (s == "nextCFGBlock") return NEXT_CFG_BLOCK;
-    else if (s == "retCFGBlock") return RET_CFG_BLOCK;
-    else if (s == "functionCFGLink") return FUNCTION_CFG_LINK;
-    else if (s == "varWriteSource") return VW_SOURCE;
-    else if (s == "varWriteDestination") return VW_DESTINATION;
-    else if (s == "parWriteSource") return PW_SOURCE;
-    else if (s == "parWriteDestination") return PW_DESTINATION;
-    else if (s == "retWriteSource") return RW_SOURCE;
-    else if (s == "retWriteDestination") return RW_DESTINATION;
-    else if (s == "writeSource") return W_SOURCE;
-    else if (s == "writeDestination") return W_DESTINATION;
-    else if (s == "varInfFuncSource") return VIF_SOURCE;
-    else if (s == "varInfFuncDestination") return VIF_DESTINATION;
-    else if (s == "varInfluenceSource") return VI_SOURCE;
-    else if (s == "varInfluenceDestination") return VI_DESTINATION;
-    else if (s == "callSource") return C_SOURCE;
-    else if (s == "callDestination") return C_DESTINATION;
-    else if (s == "pubVarSource") return PV_SOURCE;
-    else if (s == "pubVarDestination") return PV_DESTINATION;
-    else if (s == "pubTargetSource") return PT_SOURCE;
-    else if (s == "pubTargetDestination") return PT_DESTINATION;
-    else if (s == "subscribeSource") return SUB_SOURCE;
-    else if (s == "subscribeDestination") return SUB_DESTINATION;
-    else if (s == "publishSource") return PUB_SOURCE;
-    else if (s == "publishDestination") return PUB_DESTINATION;
-//    else if (s == "lineNumber") return LINE_NUMBER;	    
-    else throw domain_error("Unknown edge type");
+RexNode::NodeType RexEdge::destinationType(RexEdge::EdgeType type) {
+    static constexpr RexNode::NodeType destinations[] = {
+#define REX_EDGE_TYPE_DESTINATION(type, name, source, destination) RexNode::destination,
+        REX_EDGE_TYPES(REX_EDGE_TYPE_DESTINATION)
+#undef REX_EDGE_TYPE_DESTINATION
+    };
+    if (type >= NUM_EDGE_TYPES) {
+        throw domain_error("Unknown edge type");
+    }
+    return destinations[type];
 }
 
 /**
@@ -153,9 +103,7 @@ RexEdge::EdgeType RexEdge::stringToType(const std::string &s) {
  * @param type The edge type.
  */
 RexEdge::RexEdge(RexNode *src, RexNode *dst, RexEdge::EdgeType type)
-    : sourceNode{src}, destNode{dst},
-      sourceID{src->getID()}, destID{dst->getID()},
-      type{type} {}
+    : sourceNode{src}, destNode{dst}, type{type} {}
 
 /**
  * Creates an unestablished edge based on two Rex nodes.
@@ -175,8 +123,7 @@ RexEdge::RexEdge(string srcID, string dstID, RexEdge::EdgeType type)
  * @param type The edge type.
  */
 RexEdge::RexEdge(RexNode *src, string dstID, RexEdge::EdgeType type)
-    : sourceNode{src}, destNode{nullptr},
-      sourceID{src->getID()}, destID{dstID},
+    : sourceNode{src}, destNode{nullptr}, destID{dstID},
       type{type} {}
 
 /**
@@ -186,8 +133,7 @@ RexEdge::RexEdge(RexNode *src, string dstID, RexEdge::EdgeType type)
  * @param type The edge type.
  */
 RexEdge::RexEdge(string srcID, RexNode *dst, RexEdge::EdgeType type)
-    : sourceNode{nullptr}, destNode{dst},
-      sourceID{srcID}, destID{dst->getID()},
+    : sourceNode{nullptr}, destNode{dst}, sourceID{srcID},
       type{type} {}
 
 /**
@@ -248,11 +194,11 @@ unsigned int RexEdge::getNumAttributes() const {
 }
 
 unsigned int RexEdge::getNumSingleAttributes() const {
-    return singleAttributes.size();
+    return attributes.singles().size();
 }
 
 unsigned int RexEdge::getNumMultiAttributes() const {
-    return multiAttributes.size();
+    return attributes.multis().size();
 }
 
 /**
@@ -260,8 +206,8 @@ unsigned int RexEdge::getNumMultiAttributes() const {
  * @param key The key of the attribute.
  * @param value The value of the attribute.
  */
-void RexEdge::addSingleAttribute(std::string key, std::string value) {
-    singleAttributes[key] = value;
+void RexEdge::addSingleAttribute(RexAttribute::Key key, const std::string &value) {
+    attributes.set(key, value);
 }
 
 /**
@@ -269,87 +215,58 @@ void RexEdge::addSingleAttribute(std::string key, std::string value) {
  * @param key The key of the attribute.
  * @param value The value of the attribute.
  */
-void RexEdge::addMultiAttribute(string key, string value) {
-    multiAttributes[key].push_back(value);
+void RexEdge::addMultiAttribute(RexAttribute::Key key, const std::string &value) {
+    attributes.add(key, value);
 }
 
 /**
- * Gets a mapping of single attributes by ID
- * @return The mapping of attributes by ID
+ * Gets the attributes.
+ * @return The attributes, in order of their keys.
  */
-const std::map<std::string, std::string> &RexEdge::getSingleAttributes() const {
-    return singleAttributes;
-}
-
-/**
- * Gets a mapping of multi attributes by ID.
- * @return a mapping of multi attributes by ID..
- */
-const std::map<std::string, std::vector<std::string>> &RexEdge::getMultiAttributes() const {
-    return multiAttributes;
+const RexAttributes &RexEdge::getAttributes() const {
+    return attributes;
 }
 
 
 // Variability aware
-RexEdge::~RexEdge() {
-    delete cond;
-}
-
+RexEdge::~RexEdge() {}
 
-/**
- * Sets the condID of the edge.
- * @param ID The condID of this node.
- */
-void RexEdge::setCondID(string ID) {
-    condID = ID;
-}
 
 /**
- * Sets the cond for this node.
- * @param rc - a heap allocated RexCond that this function gets to own
+ * Sets the cond for this edge. The cond is written to the condition table of
+ * the .tao file and the edge only refers to it by ID.
+ * @param rc - a shared RexCond (see RexCond::intern)
  */
-void RexEdge::setCond(RexCond *rc) {
+void RexEdge::setCond(const RexCond *rc) {
     if (!rc) return;
     if (!cond) {
         cond = rc;
     } else {
         addDisjunction(rc);
-    } 
-    if (cond) singleAttributes["condition"] = cond->to_string();
+    }
 }
 
 /**
  * Updates the cond for this edge with a disjunction. If no cond is set
  * then this becomes the cond, if a cond is set then the cond for this
  * edge becomes a disjunction of the current cond and the parameter
- * @param rc - a heap allocated RexCond that this function gets to own
+ * @param rc - a shared RexCond (see RexCond::intern)
  */
-void RexEdge::addDisjunction(RexCond *rc) {
+void RexEdge::addDisjunction(const RexCond *rc) {
     if (!rc) return;
-    if (!cond) {
-        cond = RexBinaryOp::makeBinaryOp("||", new RexTrue{}, rc);
-    } else {
-        if (!cond->equivalent(rc)) {
-            cond = RexBinaryOp::makeBinaryOp("||", cond, rc);
-        } else {
-            delete rc;
-        }
+    if (CondBDD::isEnabled()) {
+        cond = CondBDD::disjunction(cond ? cond : RexTrue::makeTrue(), rc);
+    } else if (!cond) {
+        cond = RexBinaryOp::makeBinaryOp("||", RexTrue::makeTrue(), rc);
+    } else if (!cond->equivalent(rc)) {
+        cond = RexBinaryOp::makeBinaryOp("||", cond, rc);
     }
-    if (cond) singleAttributes["condition"] = cond->to_string();
-}
-
-/**
- * Gets the condID of the edge.
- * @return The condID.
- */
-string RexEdge::getCondID() {
-    return condID;
 }
 
 /**
  * Gets the corresponding RexCond
  * @return pointer to this edge's RexCond. May be the nullptr.
  */
-RexCond *RexEdge::getCond() {
+const RexCond *RexEdge::getCond() const {
     return cond;
 }
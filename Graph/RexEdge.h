@@ -30,68 +30,81 @@
 #ifndef REX_REXEDGE_H
 #define REX_REXEDGE_H
 
+#include "RexAttributes.h"
 #include "RexNode.h"
+#include <cstddef>
 #include <string>
 
 class RexCond;
 
+// Every edge type as (type, name, source, destination). The source and
+// destination are the node types the edge connects in the TA scheme. The
+// EdgeType enum, the conversions to and from names and the edge section of the
+// scheme (TASchema.cpp) are all generated from this.
+#define REX_EDGE_TYPES(X) \
+    X(CONTAINS, "contain", ROOT, ROOT) \
+    X(OBJ, "obj", VARIABLE, CLASS) \
+    X(MUTATE, "mutate", FUNCTION, VARIABLE) \
+    X(VAR_WRITES, "varWrite", VARIABLE, VARIABLE) \
+    X(PAR_WRITES, "parWrite", VARIABLE, VARIABLE) \
+    X(RET_WRITES, "retWrite", VARIABLE, VARIABLE) \
+    X(REFERENCES, "reference", NODE_HANDLE, ROS_MSG) \
+    X(CALLS, "call", ROOT, ROOT) \
+    X(READS, "read", VARIABLE, FUNCTION) \
+    X(WRITES, "write", FUNCTION, VARIABLE) \
+    X(ADVERTISE, "advertise", PUBLISHER, TOPIC) \
+    X(SUBSCRIBE, "subscribe", TOPIC, SUBSCRIBER) \
+    X(PUBLISH, "publish", PUBLISHER, TOPIC) \
+    X(VAR_INFLUENCE, "varInfluence", VARIABLE, ROS_MSG) \
+    X(VAR_INFLUENCE_FUNC, "varInfFunc", VARIABLE, FUNCTION) \
+    X(SET_TIME, "time", TIMER, FUNCTION) \
+    X(PUBLISH_VARIABLE, "pubVar", VARIABLE, TOPIC) \
+    X(PUBLISH_TARGET, "pubTarget", TOPIC, VARIABLE) \
+    /* If function `f` calls function `g` in f's CFG node `n`, add relation */ \
+    /* INVOKES `n` `e`, where `e` is g's CFG entry node */ \
+    X(NEXT_CFG_BLOCK, "nextCFGBlock", CFG_BLOCK, CFG_BLOCK) \
+    X(RET_CFG_BLOCK, "retCFGBlock", CFG_BLOCK, CFG_BLOCK) \
+    X(FUNCTION_CFG_LINK, "functionCFGLink", FUNCTION, CFG_BLOCK) \
+    /* Edges for linking facts to CFG Basic Block nodes */ \
+    X(VW_SOURCE, "varWriteSource", VARIABLE, CFG_BLOCK) \
+    X(VW_DESTINATION, "varWriteDestination", VARIABLE, CFG_BLOCK) \
+    X(PW_SOURCE, "parWriteSource", VARIABLE, CFG_BLOCK) \
+    X(PW_DESTINATION, "parWriteDestination", VARIABLE, CFG_BLOCK) \
+    X(RW_SOURCE, "retWriteSource", VARIABLE, CFG_BLOCK) \
+    X(RW_DESTINATION, "retWriteDestination", VARIABLE, CFG_BLOCK) \
+    X(W_SOURCE, "writeSource", FUNCTION, CFG_BLOCK) \
+    X(W_DESTINATION, "writeDestination", VARIABLE, CFG_BLOCK) \
+    X(VIF_SOURCE, "varInfFuncSource", VARIABLE, CFG_BLOCK) \
+    X(VIF_DESTINATION, "varInfFuncDestination", FUNCTION, CFG_BLOCK) \
+    X(VI_SOURCE, "varInfluenceSource", VARIABLE, CFG_BLOCK) \
+    X(VI_DESTINATION, "varInfluenceDestination", ROS_MSG, CFG_BLOCK) \
+    X(C_SOURCE, "callSource", FUNCTION, CFG_BLOCK) \
+    X(C_DESTINATION, "callDestination", FUNCTION, CFG_BLOCK) \
+    X(PV_SOURCE, "pubVarSource", VARIABLE, CFG_BLOCK) \
+    X(PV_DESTINATION, "pubVarDestination", TOPIC, CFG_BLOCK) \
+    X(PT_SOURCE, "pubTargetSource", TOPIC, CFG_BLOCK) \
+    X(PT_DESTINATION, "pubTargetDestination", VARIABLE, CFG_BLOCK) \
+    X(SUB_SOURCE, "subscribeSource", TOPIC, CFG_BLOCK) \
+    X(SUB_DESTINATION, "subscribeDestination", SUBSCRIBER, CFG_BLOCK) \
+    X(PUB_SOURCE, "publishSource", PUBLISHER, CFG_BLOCK) \
+    X(PUB_DESTINATION, "publishDestination", TOPIC, CFG_BLOCK)
+
 class RexEdge {
   public:
-    // Node Type Information
+    // Edge Type Information
     enum EdgeType {
-        CONTAINS,
-        OBJ,
-        MUTATE,
-        VAR_WRITES,
-        PAR_WRITES,
-        RET_WRITES,
-        REFERENCES,
-        CALLS,
-        READS,
-        WRITES,
-        ADVERTISE,
-        SUBSCRIBE,
-        PUBLISH,
-        VAR_INFLUENCE,
-        VAR_INFLUENCE_FUNC,
-        SET_TIME,
-        PUBLISH_VARIABLE,
-        PUBLISH_TARGET,
-        // If function `f` calls function `g` in f's CFG node `n`, add relation
-        // INVOKES `n` `e`, where `e` is g's CFG entry node
-        NEXT_CFG_BLOCK,
-        RET_CFG_BLOCK,
-        FUNCTION_CFG_LINK,
-        // Edges for linking facts to CFG Basic Block nodes
-        VW_SOURCE,
-        VW_DESTINATION,
-        PW_SOURCE,
-        PW_DESTINATION,
-        RW_SOURCE,
-        RW_DESTINATION,
-        W_SOURCE,
-        W_DESTINATION,
-        VIF_SOURCE,
-        VIF_DESTINATION,
-        VI_SOURCE,
-        VI_DESTINATION,
-        C_SOURCE,
-        C_DESTINATION,
-        PV_SOURCE,
-        PV_DESTINATION,
-        PT_SOURCE,
-        PT_DESTINATION,
-        SUB_SOURCE,
-        SUB_DESTINATION,
-        PUB_SOURCE,
-        PUB_DESTINATION,
-//	LINE_NUMBER,
+#define REX_EDGE_TYPE(type, name, source, destination) type,
+        REX_EDGE_TYPES(REX_EDGE_TYPE)
+#undef REX_EDGE_TYPE
         // This must always be the last variant. It is used to help us know how
         // many edges types there are when we output the TA schema.
         NUM_EDGE_TYPES
     };
     static const char *typeToString(EdgeType type);
     static EdgeType stringToType(const std::string &s);
+    // The node types the edge type connects in the TA scheme
+    static RexNode::NodeType sourceType(EdgeType type);
+    static RexNode::NodeType destinationType(EdgeType type);
 
     // For sorting:
     // An "EdgeLike" is any type that has similar getters to RexEdge
@@ -105,6 +118,10 @@ class RexEdge {
         return lhs < rhs;
     }
 
+    // Allocated from the current GraphArena, if there is one
+    static void *operator new(std::size_t size);
+    static void operator delete(void *ptr);
+
     // Constructor/Destructor
     RexEdge(RexNode *src, RexNode *dst, EdgeType type);
     RexEdge(std::string srcID, std::string dstID, EdgeType type);
@@ -125,34 +142,30 @@ class RexEdge {
     unsigned int getNumAttributes() const;
     unsigned int getNumSingleAttributes() const;
     unsigned int getNumMultiAttributes() const;
-    void addSingleAttribute(std::string key, std::string value);
-    void addMultiAttribute(std::string key, std::string value);
-    const std::map<std::string, std::string> &getSingleAttributes() const;
-    const std::map<std::string, std::vector<std::string>> &getMultiAttributes() const;
+    void addSingleAttribute(RexAttribute::Key key, const std::string &value);
+    void addMultiAttribute(RexAttribute::Key key, const std::string &value);
+    const RexAttributes &getAttributes() const;
     
     // Variability Aware
-    void setCondID(std::string name);
-    void setCond(RexCond *);
-    void addDisjunction(RexCond *);
-    std::string getCondID();
-    RexCond *getCond();
+    void setCond(const RexCond *);
+    void addDisjunction(const RexCond *);
+    const RexCond *getCond() const;
     ~RexEdge();
 
   private:
     RexNode *sourceNode;
     RexNode *destNode;
 
+    // Only set for an end without a node, the node has the ID otherwise
     std::string sourceID;
     std::string destID;
 
     EdgeType type;
 
-    std::map<std::string, std::string> singleAttributes;
-    std::map<std::string, std::vector<std::string>> multiAttributes;
+    RexAttributes attributes;
     
     // Variability aware
-    RexCond *cond = nullptr;
-    std::string condID;
+    const RexCond *cond = nullptr;
 };
 
 #endif // REX_REXEDGE_H
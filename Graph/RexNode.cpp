@@ -28,65 +28,57 @@
 /////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 #include "RexNode.h"
+#include "GraphArena.h"
+#include "NameHash.h"
 #include "../Walker/CondScope.h"
 #include <iostream>
 using namespace std;
 
+void *RexNode::operator new(size_t size) {
+    return GraphArena::allocateElement(size);
+}
+
+void RexNode::operator delete(void *ptr) {
+    GraphArena::freeElement(ptr);
+}
+
+static constexpr const char *nodeTypeNames[] = {
+#define REX_NODE_TYPE_NAME(type, name, parent) name,
+    REX_NODE_TYPES(REX_NODE_TYPE_NAME)
+#undef REX_NODE_TYPE_NAME
+};
+static constexpr NameHash<RexNode::NUM_NODE_TYPES> nodeTypeHash{nodeTypeNames};
+
 /**
  * Converts an node type to a string representation.
  * @param type The node type.
  * @return The string representation.
  */
 const char *RexNode::typeToString(RexNode::NodeType type) {
-    switch (type) {
-        case ROOT: return "cRoot";
-        case ASG_NODE: return "cAsgNds";
-        case ROS_MSG: return "rosMsg";
-        case FUNCTION: return "cFunction";
-        case VARIABLE: return "cVariable";
-        case CLASS: return "cClass";
-        case STRUCT: return "cStruct";
-        case UNION: return "cUnion";
-        case ENUM: return "cEnum";
-        case RETURN: return "cReturn";
-        case TOPIC: return "rosTopic";
-        case PUBLISHER: return "rosPublisher";
-        case SUBSCRIBER: return "rosSubscriber";
-        case TIMER: return "rosTimer";
-        case NODE_HANDLE: return "rosNodeHandle";
-        case CFG_BLOCK: return "cCFGBlock";
-
-        // No default case because we want the compiler to warn us when this
-        // enum changes and a case isn't covered
+    if (type >= NUM_NODE_TYPES) {
+        throw domain_error("Unknown node type");
     }
-
-    throw domain_error("Unknown node type");
+    return nodeTypeNames[type];
 }
 
 RexNode::NodeType RexNode::stringToType(const std::string &s) {
-    // Unfortunately there is no way to write this code so that the compiler
-    // will warn us to update it. You just have to remember to do that when you
-    // add a new type.
-
-    if (s == "cRoot") return ROOT;
-    else if (s == "cAsgNds") return ASG_NODE;
-    else if (s == "rosMsg") return ROS_MSG;
-    else if (s == "cFunction") return FUNCTION;
-    else if (s == "cVariable") return VARIABLE;
-    else if (s == "cClass") return CLASS;
-    else if (s == "cStruct") return STRUCT;
-    else if (s == "cUnion") return UNION;
-    else if (s == "cEnum") return ENUM;
-    else if (s == "cReturn") return RETURN;
-    else if (s == "rosTopic") return TOPIC;
-    else if (s == "rosPublisher") return PUBLISHER;
-    else if (s == "rosSubscriber") return SUBSCRIBER;
-    else if (s == "rosTimer") return TIMER;
-    else if (s == "rosNodeHandle") return NODE_HANDLE;
-    else if (s == "cCFGBlock") return CFG_BLOCK;
-    else {
+    int type = nodeTypeHash.find(s);
+    if (type < 0) {
         throw domain_error("Unknown node type: " + s);
     }
+    return static_cast<NodeType>(type);
+}
+
+RexNode::NodeType RexNode::parentType(RexNode::NodeType type) {
+    static constexpr NodeType parents[] = {
+#define REX_NODE_TYPE_PARENT(type, name, parent) parent,
+        REX_NODE_TYPES(REX_NODE_TYPE_PARENT)
+#undef REX_NODE_TYPE_PARENT
+    };
+    if (type >= NUM_NODE_TYPES) {
+        throw domain_error("Unknown node type");
+    }
+    return parents[type];
 }
 
 // Creates a Rex node with the given ID and type. Set shouldKeep to true if
@@ -117,19 +109,11 @@ bool RexNode::keep() const {
 RexNode::NodeType RexNode::getType() const { return type; }
 
 /**
- * Gets a mapping of single attributes by ID
- * @return The mapping of attributes by ID
+ * Gets the attributes.
+ * @return The attributes, in order of their keys.
  */
-const std::map<std::string, std::string> &RexNode::getSingleAttributes() const {
-    return singleAttributes;
-}
-
-/**
- * Gets a mapping of multi attributes by ID.
- * @return a mapping of multi attributes by ID..
- */
-const std::map<std::string, std::vector<std::string>> &RexNode::getMultiAttributes() const {
-    return multiAttributes;
+const RexAttributes &RexNode::getAttributes() const {
+    return attributes;
 }
 
 /**
@@ -141,11 +125,11 @@ unsigned int RexNode::getNumAttributes() const {
 }
 
 unsigned int RexNode::getNumSingleAttributes() const {
-    return singleAttributes.size();
+    return attributes.singles().size();
 }
 
 unsigned int RexNode::getNumMultiAttributes() const {
-    return multiAttributes.size();
+    return attributes.multis().size();
 }
 
 /**
@@ -154,9 +138,9 @@ unsigned int RexNode::getNumMultiAttributes() const {
  * @param key The key.
  * @param value The value.
  */
-void RexNode::addSingleAttribute(std::string key, std::string value) {
+void RexNode::addSingleAttribute(RexAttribute::Key key, const std::string &value) {
     // Overwrite the value if any is already present
-    singleAttributes[key] = value;
+    attributes.set(key, value);
 }
 
 /**
@@ -165,31 +149,29 @@ void RexNode::addSingleAttribute(std::string key, std::string value) {
  * @param key The key.
  * @param value The value.
  */
-void RexNode::addMultiAttribute(std::string key, std::string value) {
+void RexNode::addMultiAttribute(RexAttribute::Key key, const std::string &value) {
     // Add the new value to the list.
-    multiAttributes[key].push_back(value);
+    attributes.add(key, value);
 }
 
 
 // Variability Aware
-RexNode::~RexNode(){ 
-    delete cond;
-}
+RexNode::~RexNode(){}
 
 /**
  * Gets the corresponding RexCond
  * @return pointer to this nodes RexCond. May be the nullptr.
  */
-RexCond *RexNode::getCond() {
+const RexCond *RexNode::getCond() const {
     return cond;
 }
 
 /**
- * Sets the cond for this node.
- * @param rc - a heap allocated RexCond that this function gets to own
+ * Sets the cond for this node. The cond is written to the condition table of
+ * the .tao file and the node only refers to it by ID.
+ * @param rc - a shared RexCond (see RexCond::intern)
  */
-void RexNode::setCond(RexCond *rc) {
+void RexNode::setCond(const RexCond *rc) {
     if (!rc) return;
     cond = rc;
-    if (cond) singleAttributes["condition"] = cond->to_string(); 
 }
\ No newline at end of file
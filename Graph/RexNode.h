@@ -30,47 +30,59 @@
 #ifndef REX_REXNODE_H
 #define REX_REXNODE_H
 
-#include <map>
+#include "RexAttributes.h"
+#include <cstddef>
 #include <string>
-#include <vector>
 
 class RexCond;
 
+// Every node type as (type, name, parent). The parent is where the type falls
+// in the inheritance hierarchy of the TA scheme, or the type itself if it is
+// not part of it. The NodeType enum, the conversions to and from names and the
+// $INHERIT section of the scheme (TASchema.cpp) are all generated from this.
+//
+// NOTE: When adding to this list, you may also want to consider which
+// attributes it is allowed to have (TASchemeAttribute.cpp)
+#define REX_NODE_TYPES(X) \
+    /* Parent node types (inner nodes on the inheritance tree) */ \
+    \
+    /* Root of the inheritance hierarchy, do not use directly */ \
+    X(ROOT, "cRoot", ROOT) \
+    /* Nodes that are a regular part of the C++ AST, do not use directly */ \
+    X(ASG_NODE, "cAsgNds", ROOT) \
+    /* Nodes that have to do with ROS pub/sub, do not use directly */ \
+    X(ROS_MSG, "rosMsg", ROOT) \
+    \
+    /* Specific node types (leaf nodes on the inheritance tree) */ \
+    \
+    X(FUNCTION, "cFunction", ASG_NODE) \
+    X(VARIABLE, "cVariable", ASG_NODE) \
+    X(CLASS, "cClass", ASG_NODE) \
+    X(STRUCT, "cStruct", ASG_NODE) \
+    X(UNION, "cUnion", ASG_NODE) \
+    X(ENUM, "cEnum", ASG_NODE) \
+    X(RETURN, "cReturn", ASG_NODE) \
+    X(TOPIC, "rosTopic", ROS_MSG) \
+    X(PUBLISHER, "rosPublisher", ROS_MSG) \
+    X(SUBSCRIBER, "rosSubscriber", ROS_MSG) \
+    X(TIMER, "rosTimer", ROS_MSG) \
+    X(NODE_HANDLE, "rosNodeHandle", ROS_MSG) \
+    X(CFG_BLOCK, "cCFGBlock", CFG_BLOCK)
+
 class RexNode {
   public:
     // Node Type Information
-    //
-    // NOTE: When adding to this enum, you may also want to consider specifying
-    // where it falls in the inheritance hierarchy (TASchema.cpp) and which
-    // attributes it is allowed to have (TASchemeAttribute.cpp)
     enum NodeType {
-        // Parent node types (inner nodes on the inheritance tree)
-
-        // Root of the inheritance hierarchy, do not use directly
-        ROOT,
-        // Nodes that are a regular part of the C++ AST, do not use directly
-        ASG_NODE,
-        // Nodes that have to do with ROS pub/sub, do not use directly
-        ROS_MSG,
-
-        // Specific node types (leaf nodes on the inheritance tree)
-
-        FUNCTION,
-        VARIABLE,
-        CLASS,
-        STRUCT,
-        UNION,
-        ENUM,
-        RETURN,
-        TOPIC,
-        PUBLISHER,
-        SUBSCRIBER,
-        TIMER,
-        NODE_HANDLE,
-        CFG_BLOCK,
+#define REX_NODE_TYPE(type, name, parent) type,
+        REX_NODE_TYPES(REX_NODE_TYPE)
+#undef REX_NODE_TYPE
+        // This must always be the last variant
+        NUM_NODE_TYPES
     };
     static const char *typeToString(NodeType type);
     static NodeType stringToType(const std::string &s);
+    // The parent of the type in the TA inheritance hierarchy (see REX_NODE_TYPES)
+    static NodeType parentType(NodeType type);
 
     // For sorting:
     // A "NodeLike" is any type that has similar getters to RexNode
@@ -82,6 +94,10 @@ class RexNode {
         return left.getID() < right.getID();
     }
 
+    // Allocated from the current GraphArena, if there is one
+    static void *operator new(std::size_t size);
+    static void operator delete(void *ptr);
+
     // Constructor/Destructor
     RexNode(std::string id, NodeType type, bool shouldKeep);
 
@@ -89,19 +105,18 @@ class RexNode {
     NodeType getType() const;
     bool keep() const;
     const std::string &getID() const;
-    const std::map<std::string, std::string> &getSingleAttributes() const;
-    const std::map<std::string, std::vector<std::string>> &getMultiAttributes() const;
+    const RexAttributes &getAttributes() const;
     unsigned int getNumAttributes() const;
     unsigned int getNumSingleAttributes() const;
     unsigned int getNumMultiAttributes() const;
 
     // Attribute Managers
-    void addSingleAttribute(std::string key, std::string value);
-    void addMultiAttribute(std::string key, std::string value);
+    void addSingleAttribute(RexAttribute::Key key, const std::string &value);
+    void addMultiAttribute(RexAttribute::Key key, const std::string &value);
     
     // Variability Aware
-    RexCond *getCond();
-    void setCond(RexCond *);
+    const RexCond *getCond() const;
+    void setCond(const RexCond *);
     ~RexNode();
 
   private:
@@ -110,11 +125,10 @@ class RexNode {
     // Used to filter the nodes included in .tao files
     bool shouldKeep;
 
-    std::map<std::string, std::string> singleAttributes;
-    std::map<std::string, std::vector<std::string>> multiAttributes;
+    RexAttributes attributes;
     
     // Variability Aware
-    RexCond *cond = nullptr;
+    const RexCond *cond = nullptr;
 };
 
 #endif // REX_REXNODE_H
\ No newline at end of file
@@ -25,6 +25,7 @@
 /////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 #include "TAGraph.h"
+#include <functional>
 #include <iostream>
 using namespace std;
 
@@ -74,59 +75,23 @@ ConstRexNodeIterator ConstRexNodes::end() const {
 
 /**** Edge Iterator ****/
 
-ConstRexEdgeIterator::ConstRexEdgeIterator(
-    const edge_map &edges,
-    inner_iterator it
-): edges{edges}, it{it} {
-    if (it != edges.cend()) {
-        elem_it = it->second.cbegin();
-    }
-}
+ConstRexEdgeIterator::ConstRexEdgeIterator(ConstRexEdgeIterator::inner_iterator it): it{it} {}
 
 const RexEdge &ConstRexEdgeIterator::operator*() const {
-    return **elem_it;
+    return **it;
 }
 
 const RexEdge *ConstRexEdgeIterator::operator->() const {
-    return *elem_it;
+    return *it;
 }
 
 bool ConstRexEdgeIterator::operator!=(const ConstRexEdgeIterator &other) const {
-    // Need to make sure that iterators for different `edge_map` instances are
-    // not compared as equal. Taking the address of `edges` because we don't
-    // want to do a deep comparison every time.
-    if (&edges != &other.edges) {
-        return true;
-    }
-
-    // Once either side is at the end, comparing `elem_it` no longer has any
-    // meaning because there is no element that could possibly be there.
-    if (it == edges.cend() || other.it == other.edges.cend()) {
-        return it != other.it;
-    }
-
-    // Still have some elements left to go, so we can compare them
-    return (it != other.it) || (elem_it != other.elem_it);
+    return it != other.it;
 }
 
 // Prefix increment
 ConstRexEdgeIterator &ConstRexEdgeIterator::operator++() {
-    ++elem_it;
-
-    // If we're past the end of `elem_it`, see if we can still advance `it`.
-    // Need to do this in a while loop because every element in `it` doesn't
-    // necessarily have something to contribute to `elem_it`
-    while (it != edges.cend() && elem_it == it->second.cend()) {
-        ++it;
-        // Need to do a second check here because even if `it` wasn't at the end
-        // before, it might be there now
-        if (it != edges.cend()) {
-            elem_it = it->second.cbegin();
-        }
-    }
-
-    // If the above code found something, `elem_it` will have a new element.
-    // Otherwise, ¯\_(ツ)_/¯
+    ++it;
     return *this;
 }
 
@@ -140,11 +105,11 @@ ConstRexEdgeIterator ConstRexEdgeIterator::operator++(int) {
 ConstRexEdges::ConstRexEdges(const TAGraph &graph): graph{graph} {}
 
 ConstRexEdgeIterator ConstRexEdges::begin() const {
-    return ConstRexEdgeIterator(graph.edgeSrcList, graph.edgeSrcList.cbegin());
+    return ConstRexEdgeIterator(graph.edgeList.cbegin());
 }
 
 ConstRexEdgeIterator ConstRexEdges::end() const {
-    return ConstRexEdgeIterator(graph.edgeSrcList, graph.edgeSrcList.cend());
+    return ConstRexEdgeIterator(graph.edgeList.cend());
 }
 
 /**** TAGraph ****/
@@ -152,16 +117,15 @@ ConstRexEdgeIterator ConstRexEdges::end() const {
 TAGraph::TAGraph() {}
 
 /**
- * Destructor. Deletes all nodes and edges.
+ * Destructor. Deletes all nodes and edges. Those from the arena are only
+ * destroyed, their memory is released along with the arena.
  */
 TAGraph::~TAGraph() {
     for (auto &entry : idList) {
         delete entry.second;
     }
-    for (auto &entry : edgeSrcList) {
-        for (auto &vecEntry : entry.second) {
-            delete vecEntry;
-        }
+    for (RexEdge *edge : edgeList) {
+        delete edge;
     }
 }
 
@@ -181,10 +145,12 @@ void TAGraph::addNode(RexNode *node) {
  * @param edge  The edge to add.
  */
 void TAGraph::addEdge(RexEdge *edge) {
-    if (hasEdge(edge->getSourceID(), edge->getDestinationID(), edge->getType()))
+    EdgeKey key{internID(edge->getSourceID()), internID(edge->getDestinationID()), (uint8_t) edge->getType()};
+    if (!edgeIndex.emplace(key, edgeList.size()).second)
         return;
-    edgeSrcList[edge->getSourceID()].push_back(edge);
-    edgeDstList[edge->getDestinationID()].push_back(edge);
+    edgeSrcs.push_back(key.src);
+    edgeDsts.push_back(key.dst);
+    edgeList.push_back(edge);
 }
 
 /**
@@ -193,12 +159,9 @@ void TAGraph::addEdge(RexEdge *edge) {
  * @param nodeID The ID to check.
  * @return The pointer to the node (or nullptr)
  */
-RexNode *TAGraph::findNode(const std::string &nodeID) {
-    try {
-        return idList.at(nodeID);
-    } catch (out_of_range &) {
-        return nullptr;
-    }
+RexNode *TAGraph::findNode(const std::string &nodeID) const {
+    auto node = idList.find(nodeID);
+    return node == idList.end() ? nullptr : node->second;
 }
 
 /**
@@ -213,18 +176,16 @@ RexEdge *TAGraph::findEdge(
     const std::string &srcID,
     const std::string &dstID,
     RexEdge::EdgeType type
-) {
-    // Gets the edges for a source.
-    vector<RexEdge *> &edges = edgeSrcList[srcID];
-    for (auto &edge : edges) {
-        if (edge->getSourceID() == srcID &&
-            edge->getDestinationID() == dstID &&
-            edge->getType() == type) {
-            return edge;
-        }
+) const {
+    // If either ID was never used by an edge, there can't be a match
+    IDHandle src = findIDHandle(srcID);
+    IDHandle dst = src == NO_ID ? NO_ID : findIDHandle(dstID);
+    if (dst == NO_ID) {
+        return nullptr;
     }
 
-    return nullptr;
+    auto edge = edgeIndex.find(EdgeKey{src, dst, (uint8_t) type});
+    return edge == edgeIndex.end() ? nullptr : edgeList[edge->second];
 }
 
 /**
@@ -232,12 +193,8 @@ RexEdge *TAGraph::findEdge(
  * @param srcID The source ID.
  * @return A vector of matched nodes.
  */
-const std::vector<RexEdge *> &TAGraph::findEdgesBySrcID(const std::string &srcID) {
-    try {
-        return edgeSrcList.at(srcID);
-    } catch (out_of_range &) {
-        return emptyVec;
-    }    
+std::vector<RexEdge *> TAGraph::findEdgesBySrcID(const std::string &srcID) const {
+    return findAdjacentEdges(srcID, edgeSrcs, outEdges);
 }
 
 /**
@@ -245,12 +202,8 @@ const std::vector<RexEdge *> &TAGraph::findEdgesBySrcID(const std::string &srcID
  * @param srcID The destination ID.
  * @return A vector of matched nodes.
  */
-const std::vector<RexEdge *> &TAGraph::findEdgesByDstID(const std::string &dstID) {
-    try {
-        return edgeDstList.at(dstID);
-    } catch (out_of_range &) {
-        return emptyVec;
-    }  
+std::vector<RexEdge *> TAGraph::findEdgesByDstID(const std::string &dstID) const {
+    return findAdjacentEdges(dstID, edgeDsts, inEdges);
 }
 
 /**
@@ -258,7 +211,7 @@ const std::vector<RexEdge *> &TAGraph::findEdgesByDstID(const std::string &dstID
  * @param nodeID The ID of the node.
  * @return Whether the node exists.
  */
-bool TAGraph::hasNode(const std::string &nodeID) {
+bool TAGraph::hasNode(const std::string &nodeID) const {
     return findNode(nodeID) != nullptr;
 }
 
@@ -269,10 +222,79 @@ bool TAGraph::hasNode(const std::string &nodeID) {
  * @type type The edge type.
  * @return Whether the edge exists.
  */
-bool TAGraph::hasEdge(const std::string &srcID, const std::string &dstID, RexEdge::EdgeType type) {
+bool TAGraph::hasEdge(const std::string &srcID, const std::string &dstID, RexEdge::EdgeType type) const {
     return findEdge(srcID, dstID, type) != nullptr;
 }
 
+bool TAGraph::EdgeKey::operator==(const EdgeKey &other) const {
+    return src == other.src && dst == other.dst && type == other.type;
+}
+
+size_t TAGraph::EdgeKeyHash::operator()(const EdgeKey &key) const {
+    size_t h = hash<uint32_t>{}(key.src);
+    h ^= hash<uint32_t>{}(key.dst) + 0x9e3779b9 + (h << 6) + (h >> 2);
+    h ^= hash<uint8_t>{}(key.type) + 0x9e3779b9 + (h << 6) + (h >> 2);
+    return h;
+}
+
+TAGraph::IDHandle TAGraph::findIDHandle(const string &id) const {
+    auto handle = idHandles.find(id);
+    return handle == idHandles.end() ? NO_ID : handle->second;
+}
+
+TAGraph::IDHandle TAGraph::internID(const string &id) {
+    return idHandles.emplace(id, idHandles.size()).first->second;
+}
+
+/**
+ * Finds the edges with the given ID at one end, in the order they were added.
+ * @param id The ID to look for.
+ * @param ends The handle at that end of every edge (edgeSrcs or edgeDsts).
+ * @param adjacency The adjacency of those ends, rebuilt if it is out of date.
+ * @return The edges that were found.
+ */
+vector<RexEdge *> TAGraph::findAdjacentEdges(const string &id, const vector<IDHandle> &ends,
+                                             Adjacency &adjacency) const {
+    vector<RexEdge *> found;
+    IDHandle handle = findIDHandle(id);
+    if (handle == NO_ID) {
+        return found;
+    }
+
+    // Rebuilding whenever the number of edges doubles keeps lookups during
+    // the walk from costing a full rebuild each
+    uint32_t indexed = adjacency.edges.size();
+    if (ends.size() - indexed > indexed) {
+        vector<uint32_t> &offsets = adjacency.offsets;
+        offsets.assign(idHandles.size() + 1, 0);
+        for (IDHandle end : ends) {
+            offsets[end + 1]++;
+        }
+        for (size_t i = 1; i < offsets.size(); i++) {
+            offsets[i] += offsets[i - 1];
+        }
+        vector<uint32_t> next(offsets.begin(), offsets.end() - 1);
+        adjacency.edges.resize(ends.size());
+        for (uint32_t edge = 0; edge < ends.size(); edge++) {
+            adjacency.edges[next[ends[edge]]++] = edge;
+        }
+        indexed = ends.size();
+    }
+
+    // IDs interned since the last rebuild have no edges in the adjacency yet
+    if (handle + 1 < adjacency.offsets.size()) {
+        for (uint32_t i = adjacency.offsets[handle]; i < adjacency.offsets[handle + 1]; i++) {
+            found.push_back(edgeList[adjacency.edges[i]]);
+        }
+    }
+    for (uint32_t edge = indexed; edge < ends.size(); edge++) {
+        if (ends[edge] == handle) {
+            found.push_back(edgeList[edge]);
+        }
+    }
+    return found;
+}
+
 // Returns the total number of nodes that are marked to be kept in the object file
 unsigned int TAGraph::keptNodes() const {
     unsigned int count = 0;
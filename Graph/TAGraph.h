@@ -30,11 +30,14 @@
 #ifndef REX_TAGRAPH_H
 #define REX_TAGRAPH_H
 
+#include "GraphArena.h"
 #include "RexEdge.h"
 #include "RexNode.h"
+#include <cstdint>
 #include <mutex>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 class TAGraph {
@@ -70,19 +73,10 @@ public:
 
     class ConstRexEdges; // Need to forward declare
     class ConstRexEdgeIterator {
-        // This iterator needs to iterate both through the edges map and the
-        // vector of edges within it
-
-        typedef std::unordered_map<std::string, std::vector<RexEdge *>> edge_map;
-        typedef edge_map::const_iterator inner_iterator;
-        typedef std::vector<RexEdge *> edge_list;
-        typedef edge_list::const_iterator element_iterator;
-
-        const edge_map &edges;
+        typedef std::vector<RexEdge *>::const_iterator inner_iterator;
         inner_iterator it;
-        element_iterator elem_it;
 
-        ConstRexEdgeIterator(const edge_map &edges, inner_iterator it);
+        explicit ConstRexEdgeIterator(inner_iterator it);
     public:
         const RexEdge &operator*() const;
         const RexEdge *operator->() const;
@@ -115,14 +109,14 @@ public:
     virtual void addEdge(RexEdge *edge);
 
     // Find Methods
-    RexNode *findNode(const std::string &nodeID);
-    RexEdge *findEdge(const std::string &srcID, const std::string &dstID, RexEdge::EdgeType type);
-    const std::vector<RexEdge *> &findEdgesBySrcID(const std::string &srcID);
-    const std::vector<RexEdge *> &findEdgesByDstID(const std::string &dstID);
+    RexNode *findNode(const std::string &nodeID) const;
+    RexEdge *findEdge(const std::string &srcID, const std::string &dstID, RexEdge::EdgeType type) const;
+    std::vector<RexEdge *> findEdgesBySrcID(const std::string &srcID) const;
+    std::vector<RexEdge *> findEdgesByDstID(const std::string &dstID) const;
 
     // Element Exist Methods
-    bool hasNode(const std::string &nodeID);
-    bool hasEdge(const std::string &srcID, const std::string &dstID, RexEdge::EdgeType type);
+    bool hasNode(const std::string &nodeID) const;
+    bool hasEdge(const std::string &srcID, const std::string &dstID, RexEdge::EdgeType type) const;
 
     // Size/Counting methods
     unsigned int keptNodes() const;
@@ -136,11 +130,56 @@ public:
     ConstRexEdges edges() const;
 
 private:
+    // Every node and edge created while the graph exists is allocated here
+    GraphArena arena;
+
     // Member variables
     std::unordered_map<std::string, RexNode *> idList;
-    std::unordered_map<std::string, std::vector<RexEdge *>> edgeSrcList;
-    std::unordered_map<std::string, std::vector<RexEdge *>> edgeDstList;
-    std::vector<RexEdge *> emptyVec; // for out of range situations
+
+    // Every ID used by an edge is interned once and referred to by a 32-bit
+    // handle, whether or not a node with that ID exists
+    typedef uint32_t IDHandle;
+    static const IDHandle NO_ID = UINT32_MAX;
+    std::unordered_map<std::string, IDHandle> idHandles;
+
+    // The edges, stored as parallel arrays indexed by edge number in the order
+    // they were added. The RexEdge carries the type, attributes and condition.
+    std::vector<IDHandle> edgeSrcs;
+    std::vector<IDHandle> edgeDsts;
+    std::vector<RexEdge *> edgeList;
+
+    // Index of every edge by (source, destination, type). Hub nodes can have
+    // thousands of edges, so scanning for duplicates on every addEdge would
+    // make adding edges quadratic.
+    struct EdgeKey {
+        IDHandle src;
+        IDHandle dst;
+        uint8_t type;
+
+        bool operator==(const EdgeKey &other) const;
+    };
+    struct EdgeKeyHash {
+        std::size_t operator()(const EdgeKey &key) const;
+    };
+    std::unordered_map<EdgeKey, uint32_t, EdgeKeyHash> edgeIndex;
+
+    // CSR adjacency of the first edges.size() edges: the edges with handle h
+    // at one end are edges[offsets[h]] up to edges[offsets[h + 1]].
+    //
+    // Edges are still being added while the walkers look up adjacent edges, so
+    // the adjacency is only rebuilt once the edges added since outnumber the
+    // ones in it. Those newer edges are scanned instead.
+    struct Adjacency {
+        std::vector<uint32_t> offsets;
+        std::vector<uint32_t> edges;
+    };
+    mutable Adjacency outEdges;
+    mutable Adjacency inEdges;
+
+    IDHandle findIDHandle(const std::string &id) const;
+    IDHandle internID(const std::string &id);
+    std::vector<RexEdge *> findAdjacentEdges(const std::string &id, const std::vector<IDHandle> &ends,
+                                             Adjacency &adjacency) const;
 };
 
 #endif // REX_TAGRAPH_H
@@ -4,12 +4,49 @@
 #include "TASchemeAttribute.h"
 
 #include <algorithm>
+#include <stdexcept>
 
 using namespace std;
 
 // pair<attr name, isMulti>
 static vector<pair<string,bool>> allNodeAttrs;
 static vector<pair<string,bool>> allEdgeAttrs;
+// The key of each of those attributes, NUM_KEYS for the ones that only exist
+// in the schema and are never recorded
+static vector<RexAttribute::Key> allNodeAttrKeys;
+static vector<RexAttribute::Key> allEdgeAttrKeys;
+
+static vector<RexAttribute::Key> keysOf(const vector<pair<string,bool>> &attrs) {
+    vector<RexAttribute::Key> keys;
+    for (auto &attr : attrs) {
+        try {
+            keys.push_back(RexAttribute::stringToKey(attr.first));
+        } catch (const domain_error &) {
+            keys.push_back(RexAttribute::NUM_KEYS);
+        }
+    }
+    return keys;
+}
+
+static void writeAttribute(ostream &out, const TAOAttrs &attrs, const pair<string,bool> &attr, RexAttribute::Key key) {
+    if (attr.first == TASchemeAttribute::PRESENCE_CONDITION && attrs.condition) {
+        out << ConditionTable::name(attrs.condition);
+    } else if (key == RexAttribute::NUM_KEYS) {
+        return;
+    } else if (!attr.second /* !isMulti */ && attrs.attributes.get(key)) {
+        out << *attrs.attributes.get(key);
+    } else if (attr.second /* isMulti */ && attrs.attributes.getAll(key)) {
+        bool first = true;
+        for (auto &val : *attrs.attributes.getAll(key)) {
+            if (!first) {
+                out << "-"; // array delimiter
+            } else {
+                first = false;
+            }
+            out << *val;
+        }
+    }
+}
 
 CSVWriter::CSVWriter(std::ostream &nodes, std::ostream &edges)
   : nodes{ nodes }, edges{ edges } {
@@ -20,6 +57,7 @@ CSVWriter::CSVWriter(std::ostream &nodes, std::ostream &edges)
     }
     sort(allNodeAttrs.begin(), allNodeAttrs.end());
     allNodeAttrs.erase(unique(allNodeAttrs.begin(), allNodeAttrs.end()), allNodeAttrs.end());
+    allNodeAttrKeys = keysOf(allNodeAttrs);
 
     for (const auto &entity : TASchemeAttribute::allEdgeAttrs()) {
       for (const auto &attr : entity.getAllowedAttributes()) {
@@ -28,6 +66,7 @@ CSVWriter::CSVWriter(std::ostream &nodes, std::ostream &edges)
     }
     sort(allEdgeAttrs.begin(), allEdgeAttrs.end());
     allEdgeAttrs.erase(unique(allEdgeAttrs.begin(), allEdgeAttrs.end()), allEdgeAttrs.end());
+    allEdgeAttrKeys = keysOf(allEdgeAttrs);
 
     nodes << "id:ID"
           << "\t"
@@ -71,22 +110,9 @@ CSVWriter &CSVWriter::operator<<(const TAONodeAttrs &attrs) {
     nodes << attrs.id
         << '\t'
         << RexNode::typeToString(attrs.type);
-    for (auto &attr : allNodeAttrs) {
+    for (size_t i = 0; i < allNodeAttrs.size(); i++) {
         nodes << '\t';
-        if (!attr.second /* !isMulti */ && attrs.singleAttrs.count(attr.first)) {
-            // cannot use operator[] because attrs is passed in as a constant
-            nodes << attrs.singleAttrs.at(attr.first);
-        } else if (attr.second /* isMulti */ && attrs.multiAttrs.count(attr.first)) {
-            bool first = true;
-            for (auto &val : attrs.multiAttrs.at(attr.first)) {
-                if (!first) {
-                    nodes << "-"; // array delimiter
-                } else {
-                    first = false;
-                }
-                nodes << val;
-            }
-        }
+        writeAttribute(nodes, attrs, allNodeAttrs[i], allNodeAttrKeys[i]);
     }
     nodes << endl;
     return *this;
@@ -98,24 +124,29 @@ CSVWriter &CSVWriter::operator<<(const TAOEdgeAttrs &attrs) {
         << attrs.edge.destId
         << "\t"
         << RexEdge::typeToString(attrs.edge.type);
-    for (auto &attr : allEdgeAttrs) {
+    for (size_t i = 0; i < allEdgeAttrs.size(); i++) {
         edges << '\t';
-        if (!attr.second /* !isMulti */ && attrs.singleAttrs.count(attr.first)) {
-            // cannot use operator[] because attrs is passed in as a constant
-            edges << attrs.singleAttrs.at(attr.first);
-        } else if (attr.second /* isMulti */ && attrs.multiAttrs.count(attr.first)) {
-            bool first = true;
-            for (auto &val : attrs.multiAttrs.at(attr.first)) {
-                if (!first) {
-                    edges << "-"; // array delimiter
-                } else {
-                    first = false;
-                }
-                edges << val;
-            }
-        }
+        writeAttribute(edges, attrs, allEdgeAttrs[i], allEdgeAttrKeys[i]);
     }
     edges << endl;
     return *this;
 }
 
+// Each condition is a node labelled "condition" whose condition column holds
+// its text (instead of an ID)
+CSVWriter &CSVWriter::operator<<(const ConditionTable &conditions) {
+    for (unsigned int id = 1; id <= conditions.size(); id++) {
+        if (!conditions.isUsed(id)) continue;
+        nodes << ConditionTable::name(id)
+            << '\t'
+            << TASchemeAttribute::PRESENCE_CONDITION;
+        for (auto &attr : allNodeAttrs) {
+            nodes << '\t';
+            if (attr.first == TASchemeAttribute::PRESENCE_CONDITION) {
+                nodes << conditions.getCondition(id);
+            }
+        }
+        nodes << endl;
+    }
+    return *this;
+}
@@ -5,6 +5,7 @@
 #include <exception> // exception
 
 #include "TAObjectFile.h"
+#include "ConditionTable.h"
 
 class CSVWriter {
   std::ostream &nodes;
@@ -17,7 +18,12 @@ public:
   CSVWriter &operator<<(const TAONode &node);
   CSVWriter &operator<<(const TAOEdge &fact);
 
+  // Attributes refer to conditions by ID, the table is written at the end
+  void useConditions(const ConditionTable &) {}
+
   // Fact Attribute Section
   CSVWriter &operator<<(const TAONodeAttrs &attrs);
   CSVWriter &operator<<(const TAOEdgeAttrs &attrs);
+  // Written as extra rows in the nodes file
+  CSVWriter &operator<<(const ConditionTable &conditions);
 };
@@ -0,0 +1,81 @@
+#include "ConditionTable.h"
+
+#include <stdexcept> // for runtime_error
+
+#include "TAObjectFile.h"
+
+using namespace std;
+
+unsigned int ConditionTable::intern(const string &condition) {
+    auto found = ids.find(condition);
+    if (found != ids.end()) {
+        return found->second;
+    }
+    conditions.push_back(condition);
+    used.push_back(false);
+    unsigned int id = conditions.size();
+    ids.emplace(condition, id);
+    return id;
+}
+
+void ConditionTable::readFile(istream &in, unsigned int size) {
+    fileIDs.emplace_back(size + 1, 0);
+    vector<unsigned int> &idsInFile = fileIDs.back();
+
+    TAOCondition condition;
+    for (unsigned int i = 0; i < size; i++) {
+        in >> condition;
+        if (condition.id == 0 || condition.id > size) {
+            throw runtime_error("Condition ID out of range in .tao file");
+        }
+        idsInFile[condition.id] = intern(condition.condition);
+    }
+}
+
+unsigned int ConditionTable::getID(unsigned int file, unsigned int fileID) const {
+    if (fileID == 0) return 0;
+    const vector<unsigned int> &idsInFile = fileIDs.at(file);
+    if (fileID >= idsInFile.size()) {
+        throw runtime_error("Attribute refers to a condition that is not in its .tao file");
+    }
+    return idsInFile[fileID];
+}
+
+unsigned int ConditionTable::disjunction(unsigned int left, unsigned int right) {
+    // An unconditional fact stays unconditional
+    if (left == 0 || right == 0) return 0;
+    if (left == right) return left;
+    if (right < left) swap(left, right);
+
+    auto key = make_pair(left, right);
+    auto found = disjunctions.find(key);
+    if (found != disjunctions.end()) {
+        return found->second;
+    }
+    // Written the same way as a RexBinaryOp
+    unsigned int id = intern("(" + conditions[left - 1] + "||" + conditions[right - 1] + ")");
+    disjunctions.emplace(key, id);
+    return id;
+}
+
+void ConditionTable::markUsed(unsigned int id) {
+    if (id != 0) {
+        used[id - 1] = true;
+    }
+}
+
+bool ConditionTable::isUsed(unsigned int id) const {
+    return id != 0 && used[id - 1];
+}
+
+unsigned int ConditionTable::size() const {
+    return conditions.size();
+}
+
+const string &ConditionTable::getCondition(unsigned int id) const {
+    return conditions.at(id - 1);
+}
+
+string ConditionTable::name(unsigned int id) {
+    return "cond" + to_string(id);
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <istream> // istream
+#include <map> // map
+#include <string> // string
+#include <unordered_map> // unordered_map
+#include <utility> // pair
+#include <vector> // vector
+
+// The presence conditions of every linked .tao file.
+//
+// Each .tao file has its own table of conditions, and its node and edge
+// attributes refer to them by an ID local to that file. As the files are read,
+// their conditions are deduplicated into this table and the local IDs are
+// translated to IDs in it. When the attributes of a fact are merged across
+// files, their conditions are OR-ed, since the fact exists if it exists in any
+// of them.
+//
+// ID 0 means that a fact is unconditional. Writers only emit the conditions
+// that were actually referenced by a written fact (see markUsed).
+class ConditionTable {
+    // Indexed by ID - 1
+    std::vector<std::string> conditions;
+    std::vector<bool> used;
+    std::unordered_map<std::string, unsigned int> ids;
+    // For each file (by index), its IDs translated to ours
+    std::vector<std::vector<unsigned int>> fileIDs;
+    std::map<std::pair<unsigned int, unsigned int>, unsigned int> disjunctions;
+
+    unsigned int intern(const std::string &condition);
+
+  public:
+    // Read the condition table at the current position of a .tao file. Files
+    // must be read in the order of the indexes passed to getID.
+    void readFile(std::istream &in, unsigned int size);
+
+    // Our ID for the given ID in a file
+    unsigned int getID(unsigned int file, unsigned int fileID) const;
+    // The condition that holds if either of the given ones does
+    unsigned int disjunction(unsigned int left, unsigned int right);
+
+    void markUsed(unsigned int id);
+    bool isUsed(unsigned int id) const;
+
+    // The number of conditions (IDs are 1 to size())
+    unsigned int size() const;
+    const std::string &getCondition(unsigned int id) const;
+
+    // How a condition is referred to in the linked output
+    static std::string name(unsigned int id);
+};
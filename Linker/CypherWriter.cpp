@@ -23,6 +23,19 @@ CypherWriter &CypherWriter::operator<<(const TAONode &node) {
   return *this;
 }
 
+CypherWriter &CypherWriter::operator<<(const ConditionTable &conditions) {
+  for (unsigned int id = 1; id <= conditions.size(); id++) {
+    if (!conditions.isUsed(id)) continue;
+    out << "CREATE ("
+        << ":" << TASchemeAttribute::PRESENCE_CONDITION
+        << " "
+        << "{id:" << quote(ConditionTable::name(id)) << ", "
+        << TASchemeAttribute::PRESENCE_CONDITION << ":" << quote(conditions.getCondition(id)) << "}"
+        << ");\n";
+  }
+  return *this;
+}
+
 CypherWriter &CypherWriter::operator<<(const TAOEdge &edge) {
   out << "MATCH"
       << "(from {id:" + quote(edge.sourceId) + "}),"
@@ -63,34 +76,40 @@ void CypherWriter::writeAttrsCommon(const string& id, const TAOAttrs& attrs)
 {
   bool first = true;
 
+  if (attrs.condition) {
+    out << " " << id << "." << TASchemeAttribute::PRESENCE_CONDITION << " = "
+        << quote(ConditionTable::name(attrs.condition));
+    first = false;
+  }
+
   // SINGLE ATTRIBUTES
-  for (auto &entry : attrs.singleAttrs) {
+  for (auto &entry : attrs.attributes.singles()) {
     if (first) {
       out << " ";
       first = false;
     } else {
       out << ", ";
     }
-    out << id << "." << entry.first << " = " << quote(entry.second);
+    out << id << "." << RexAttribute::keyToString(entry.key) << " = " << quote(*entry.value);
   }
 
   // MULTI ATTRIBUTES
-  for (auto &entry : attrs.multiAttrs) {
+  for (auto &entry : attrs.attributes.multis()) {
     if (first) {
       out << " ";
       first = false;
     } else {
       out << ", ";
     }
-    out << id << "." << entry.first << " = [";
+    out << id << "." << RexAttribute::keyToString(entry.key) << " = [";
 
     bool firstVal = true;
-    for (auto &attr: entry.second) {
+    for (auto &attr: entry.values) {
       if (!firstVal) {
           out << ", ";
       }
       firstVal = false;
-      out << quote(attr);
+      out << quote(*attr);
     }
     out << "]";
   }
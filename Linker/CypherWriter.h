@@ -5,6 +5,7 @@
 #include <exception> // exception
 
 #include "TAObjectFile.h"
+#include "ConditionTable.h"
 
 
 class CypherWriter {
@@ -17,8 +18,13 @@ public:
   CypherWriter &operator<<(const TAONode &node);
   CypherWriter &operator<<(const TAOEdge &fact);
 
+  // Attributes refer to conditions by ID, the table is written at the end
+  void useConditions(const ConditionTable &) {}
+
   // Fact Attribute Section
   CypherWriter &operator<<(const TAONodeAttrs &attrs);
   CypherWriter &operator<<(const TAOEdgeAttrs &attrs);
+  // Each condition becomes a node with its text as the condition property
+  CypherWriter &operator<<(const ConditionTable &conditions);
   void writeAttrsCommon(const std::string& id, const TAOAttrs& attrs);
 };
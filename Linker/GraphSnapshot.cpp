@@ -0,0 +1,616 @@
+#include "GraphSnapshot.h"
+
+#include <algorithm> // sort, stable_sort, lower_bound, equal_range
+#include <cstring> // memcmp, memcpy, strcmp
+#include <iostream> // cerr, endl
+#include <numeric> // iota
+#include <stdexcept> // runtime_error
+
+#include <fcntl.h> // open
+#include <sys/mman.h> // mmap, munmap
+#include <sys/stat.h> // fstat
+#include <unistd.h> // close
+
+using namespace std;
+
+const char SnapshotHeader::MAGIC[8] = {'R', 'E', 'X', 'S', 'N', 'A', 'P', '\0'};
+const uint32_t GraphSnapshot::NO_NODE;
+
+static const size_t SECTION_ALIGN = 8;
+
+// The names stored after the node IDs, in the order they are stored in
+static vector<const char *> allNames() {
+    vector<const char *> names;
+    for (int type = 0; type < RexNode::NUM_NODE_TYPES; type++) {
+        names.push_back(RexNode::typeToString(static_cast<RexNode::NodeType>(type)));
+    }
+    for (int type = 0; type < RexEdge::NUM_EDGE_TYPES; type++) {
+        names.push_back(RexEdge::typeToString(static_cast<RexEdge::EdgeType>(type)));
+    }
+    for (int key = 0; key < RexAttribute::NUM_KEYS; key++) {
+        names.push_back(RexAttribute::keyToString(static_cast<RexAttribute::Key>(key)));
+    }
+    return names;
+}
+
+void SnapshotWriter::addAttrs(vector<Attr> &attrs, uint32_t item, const RexAttributes &attributes) {
+    for (auto &entry : attributes.singles()) {
+        attrs.push_back(Attr{item, entry.key, entry.value});
+    }
+    for (auto &entry : attributes.multis()) {
+        for (auto &value : entry.values) {
+            attrs.push_back(Attr{item, entry.key, value});
+        }
+    }
+}
+
+SnapshotWriter &SnapshotWriter::operator<<(const TAONode &node) {
+    if (nodeNumbers.emplace(node.id, nodeIDs.size()).second) {
+        nodeIDs.push_back(node.id);
+        nodeTypes.push_back(node.type);
+    }
+    return *this;
+}
+
+SnapshotWriter &SnapshotWriter::operator<<(const TAOEdge &edge) {
+    auto source = nodeNumbers.find(edge.sourceId);
+    auto destination = nodeNumbers.find(edge.destId);
+    // The linker only writes established edges, so this should never happen
+    if (source == nodeNumbers.end() || destination == nodeNumbers.end()) {
+        cerr << "Rex Warning: Leaving unestablished edge out of the snapshot: "
+             << edge.sourceId << " -> " << edge.destId << endl;
+        return *this;
+    }
+    edges.push_back(Edge{source->second, destination->second, static_cast<uint8_t>(edge.type)});
+    return *this;
+}
+
+SnapshotWriter &SnapshotWriter::operator<<(const TAONodeAttrs &attrs) {
+    if (attrs.empty())
+        return *this;
+    auto node = nodeNumbers.find(attrs.id);
+    if (node == nodeNumbers.end())
+        return *this;
+
+    addAttrs(nodeAttrs, node->second, attrs.attributes);
+    if (attrs.condition) {
+        nodeConditions.emplace_back(node->second, attrs.condition);
+    }
+    return *this;
+}
+
+SnapshotWriter &SnapshotWriter::operator<<(const TAOEdgeAttrs &attrs) {
+    if (attrs.empty())
+        return *this;
+    auto source = nodeNumbers.find(attrs.edge.sourceId);
+    auto destination = nodeNumbers.find(attrs.edge.destId);
+    if (source == nodeNumbers.end() || destination == nodeNumbers.end())
+        return *this;
+
+    uint32_t entry = attributedEdges.size();
+    attributedEdges.push_back(Edge{source->second, destination->second, static_cast<uint8_t>(attrs.edge.type)});
+    addAttrs(edgeAttrs, entry, attrs.attributes);
+    if (attrs.condition) {
+        edgeConditions.emplace_back(entry, attrs.condition);
+    }
+    return *this;
+}
+
+SnapshotWriter &SnapshotWriter::operator<<(const ConditionTable &conditions) {
+    for (unsigned int id = 1; id <= conditions.size(); id++) {
+        if (conditions.isUsed(id)) {
+            this->conditions[id] = conditions.getCondition(id);
+        }
+    }
+    return *this;
+}
+
+// Sorts attributes into columns, returning the offset of each column
+static vector<uint64_t> toColumns(vector<pair<RexAttribute::Key, pair<uint32_t, uint32_t>>> &attrs) {
+    // Stable so that the values of a multi-valued attribute keep their order
+    stable_sort(attrs.begin(), attrs.end(), [](const pair<RexAttribute::Key, pair<uint32_t, uint32_t>> &left,
+                                               const pair<RexAttribute::Key, pair<uint32_t, uint32_t>> &right) {
+        return left.first != right.first ? left.first < right.first : left.second.first < right.second.first;
+    });
+    vector<uint64_t> offsets(RexAttribute::NUM_KEYS + 1, 0);
+    for (auto &attr : attrs) {
+        offsets[attr.first + 1]++;
+    }
+    for (int key = 0; key < RexAttribute::NUM_KEYS; key++) {
+        offsets[key + 1] += offsets[key];
+    }
+    return offsets;
+}
+
+void SnapshotWriter::write(ostream &out) const {
+    const uint32_t numNodes = nodeIDs.size();
+    const uint32_t numEdges = edges.size();
+
+    // Number the nodes by ID
+    vector<uint32_t> byID(numNodes);
+    iota(byID.begin(), byID.end(), 0);
+    sort(byID.begin(), byID.end(), [this](uint32_t left, uint32_t right) {
+        return nodeIDs[left] < nodeIDs[right];
+    });
+    vector<uint32_t> number(numNodes);
+    for (uint32_t node = 0; node < numNodes; node++) {
+        number[byID[node]] = node;
+    }
+
+    // The string table, with every distinct value stored once
+    vector<pair<const char *, size_t>> strings;
+    strings.reserve(numNodes);
+    for (uint32_t node : byID) {
+        strings.emplace_back(nodeIDs[node].c_str(), nodeIDs[node].size());
+    }
+    for (const char *name : allNames()) {
+        strings.emplace_back(name, strlen(name));
+    }
+    unordered_map<const string *, uint32_t> valueNumbers;
+    auto valueNumber = [&strings, &valueNumbers](const string *value) {
+        auto inserted = valueNumbers.emplace(value, strings.size());
+        if (inserted.second) {
+            strings.emplace_back(value->c_str(), value->size());
+        }
+        return inserted.first->second;
+    };
+
+    // Sort the edges of each node by type and then by the other end
+    vector<Edge> outEdges;
+    outEdges.reserve(numEdges);
+    for (const Edge &edge : edges) {
+        outEdges.push_back(Edge{number[edge.source], number[edge.destination], edge.type});
+    }
+    auto outOrder = [](const Edge &left, const Edge &right) {
+        if (left.source != right.source) return left.source < right.source;
+        if (left.type != right.type) return left.type < right.type;
+        return left.destination < right.destination;
+    };
+    sort(outEdges.begin(), outEdges.end(), outOrder);
+
+    vector<uint32_t> inEdges(numEdges);
+    iota(inEdges.begin(), inEdges.end(), 0);
+    sort(inEdges.begin(), inEdges.end(), [&outEdges](uint32_t left, uint32_t right) {
+        const Edge &l = outEdges[left];
+        const Edge &r = outEdges[right];
+        if (l.destination != r.destination) return l.destination < r.destination;
+        if (l.type != r.type) return l.type < r.type;
+        return l.source < r.source;
+    });
+
+    vector<uint32_t> outOffsets(numNodes + 1, 0);
+    vector<uint32_t> inOffsets(numNodes + 1, 0);
+    for (const Edge &edge : outEdges) {
+        outOffsets[edge.source + 1]++;
+        inOffsets[edge.destination + 1]++;
+    }
+    for (uint32_t node = 0; node < numNodes; node++) {
+        outOffsets[node + 1] += outOffsets[node];
+        inOffsets[node + 1] += inOffsets[node];
+    }
+
+    vector<uint32_t> typeOffsets(RexNode::NUM_NODE_TYPES + 1, 0);
+    vector<uint8_t> types(numNodes);
+    for (uint32_t node = 0; node < numNodes; node++) {
+        types[node] = nodeTypes[byID[node]];
+        typeOffsets[types[node] + 1]++;
+    }
+    for (int type = 0; type < RexNode::NUM_NODE_TYPES; type++) {
+        typeOffsets[type + 1] += typeOffsets[type];
+    }
+    // Nodes are already in ID order, so this keeps them that way
+    vector<uint32_t> typeNodes(numNodes);
+    vector<uint32_t> nextOfType(typeOffsets.begin(), typeOffsets.end() - 1);
+    for (uint32_t node = 0; node < numNodes; node++) {
+        typeNodes[nextOfType[types[node]]++] = node;
+    }
+
+    // The function attribute of each CFG block, or the function containing it
+    // for blocks from object files that predate the attribute
+    vector<uint32_t> functions(numNodes, GraphSnapshot::NO_NODE);
+    for (const Edge &edge : outEdges) {
+        if (edge.type == RexEdge::CONTAINS && types[edge.source] == RexNode::FUNCTION &&
+            types[edge.destination] == RexNode::CFG_BLOCK) {
+            functions[edge.destination] = edge.source;
+        }
+    }
+    for (const Attr &attr : nodeAttrs) {
+        if (attr.key == RexAttribute::CFG_FUNCTION) {
+            auto function = nodeNumbers.find(*attr.value);
+            if (function != nodeNumbers.end()) {
+                functions[number[attr.item]] = number[function->second];
+            }
+        }
+    }
+
+    // Attributes as (key, (node or edge, value))
+    vector<pair<RexAttribute::Key, pair<uint32_t, uint32_t>>> nodeColumns;
+    for (const Attr &attr : nodeAttrs) {
+        nodeColumns.push_back({attr.key, {number[attr.item], valueNumber(attr.value)}});
+    }
+    for (auto &condition : nodeConditions) {
+        nodeColumns.push_back({RexAttribute::PRESENCE_CONDITION,
+                               {number[condition.first], valueNumber(&conditions.at(condition.second))}});
+    }
+
+    // Edges with attributes that aren't in the graph are left out
+    vector<uint32_t> edgeNumbers;
+    for (const Edge &edge : attributedEdges) {
+        Edge renumbered{number[edge.source], number[edge.destination], edge.type};
+        auto found = lower_bound(outEdges.begin(), outEdges.end(), renumbered, outOrder);
+        bool exists = found != outEdges.end() && !outOrder(renumbered, *found);
+        edgeNumbers.push_back(exists ? found - outEdges.begin() : UINT32_MAX);
+    }
+    vector<pair<RexAttribute::Key, pair<uint32_t, uint32_t>>> edgeColumns;
+    for (const Attr &attr : edgeAttrs) {
+        if (edgeNumbers[attr.item] != UINT32_MAX) {
+            edgeColumns.push_back({attr.key, {edgeNumbers[attr.item], valueNumber(attr.value)}});
+        }
+    }
+    for (auto &condition : edgeConditions) {
+        if (edgeNumbers[condition.first] != UINT32_MAX) {
+            edgeColumns.push_back({RexAttribute::PRESENCE_CONDITION,
+                                   {edgeNumbers[condition.first], valueNumber(&conditions.at(condition.second))}});
+        }
+    }
+    vector<uint64_t> nodeColumnOffsets = toColumns(nodeColumns);
+    vector<uint64_t> edgeColumnOffsets = toColumns(edgeColumns);
+
+    vector<uint64_t> stringOffsets;
+    stringOffsets.reserve(strings.size() + 1);
+    uint64_t stringBytes = 0;
+    for (auto &s : strings) {
+        stringOffsets.push_back(stringBytes);
+        stringBytes += s.second + 1;
+    }
+    stringOffsets.push_back(stringBytes);
+
+    // Lay out every section before writing anything
+    SnapshotHeader header{};
+    memcpy(header.magic, SnapshotHeader::MAGIC, sizeof(header.magic));
+    header.version = SnapshotHeader::VERSION;
+    header.numNodeTypes = RexNode::NUM_NODE_TYPES;
+    header.numEdgeTypes = RexEdge::NUM_EDGE_TYPES;
+    header.numAttributes = RexAttribute::NUM_KEYS;
+    header.numNodes = numNodes;
+    header.numEdges = numEdges;
+    header.numStrings = strings.size();
+
+    const uint64_t sizes[SnapshotHeader::NUM_SECTIONS] = {
+        stringOffsets.size() * sizeof(uint64_t),
+        stringBytes,
+        numNodes * sizeof(uint8_t),
+        typeOffsets.size() * sizeof(uint32_t),
+        numNodes * sizeof(uint32_t),
+        numNodes * sizeof(uint32_t),
+        outOffsets.size() * sizeof(uint32_t),
+        numEdges * sizeof(uint8_t),
+        numEdges * sizeof(uint32_t),
+        numEdges * sizeof(uint32_t),
+        inOffsets.size() * sizeof(uint32_t),
+        numEdges * sizeof(uint8_t),
+        numEdges * sizeof(uint32_t),
+        numEdges * sizeof(uint32_t),
+        nodeColumnOffsets.size() * sizeof(uint64_t),
+        nodeColumns.size() * sizeof(uint32_t),
+        nodeColumns.size() * sizeof(uint32_t),
+        edgeColumnOffsets.size() * sizeof(uint64_t),
+        edgeColumns.size() * sizeof(uint32_t),
+        edgeColumns.size() * sizeof(uint32_t),
+    };
+    auto aligned = [](uint64_t offset) {
+        return (offset + SECTION_ALIGN - 1) & ~(SECTION_ALIGN - 1);
+    };
+    uint64_t offset = aligned(sizeof(SnapshotHeader));
+    for (int section = 0; section < SnapshotHeader::NUM_SECTIONS; section++) {
+        header.sections[section] = offset;
+        offset = aligned(offset + sizes[section]);
+    }
+    header.fileSize = offset;
+
+    uint64_t written = 0;
+    auto writeBytes = [&out, &written](const void *data, uint64_t size) {
+        out.write(static_cast<const char *>(data), size);
+        written += size;
+    };
+    auto pad = [&writeBytes, &written, &aligned]() {
+        static const char zeros[SECTION_ALIGN] = {};
+        writeBytes(zeros, aligned(written) - written);
+    };
+    auto writeColumn = [&writeBytes, &pad](const vector<pair<RexAttribute::Key, pair<uint32_t, uint32_t>>> &column,
+                                           bool items) {
+        for (auto &attr : column) {
+            writeBytes(items ? &attr.second.first : &attr.second.second, sizeof(uint32_t));
+        }
+        pad();
+    };
+
+    writeBytes(&header, sizeof(header));
+    pad();
+
+    writeBytes(stringOffsets.data(), sizes[SnapshotHeader::STRING_OFFSETS]);
+    pad();
+    for (auto &s : strings) {
+        writeBytes(s.first, s.second + 1);
+    }
+    pad();
+
+    writeBytes(types.data(), sizes[SnapshotHeader::NODE_TYPES]);
+    pad();
+    writeBytes(typeOffsets.data(), sizes[SnapshotHeader::TYPE_OFFSETS]);
+    pad();
+    writeBytes(typeNodes.data(), sizes[SnapshotHeader::TYPE_NODES]);
+    pad();
+    writeBytes(functions.data(), sizes[SnapshotHeader::NODE_FUNCTIONS]);
+    pad();
+
+    writeBytes(outOffsets.data(), sizes[SnapshotHeader::OUT_OFFSETS]);
+    pad();
+    for (const Edge &edge : outEdges) {
+        writeBytes(&edge.type, sizeof(uint8_t));
+    }
+    pad();
+    for (const Edge &edge : outEdges) {
+        writeBytes(&edge.destination, sizeof(uint32_t));
+    }
+    pad();
+    for (const Edge &edge : outEdges) {
+        writeBytes(&edge.source, sizeof(uint32_t));
+    }
+    pad();
+
+    writeBytes(inOffsets.data(), sizes[SnapshotHeader::IN_OFFSETS]);
+    pad();
+    for (uint32_t edge : inEdges) {
+        writeBytes(&outEdges[edge].type, sizeof(uint8_t));
+    }
+    pad();
+    for (uint32_t edge : inEdges) {
+        writeBytes(&outEdges[edge].source, sizeof(uint32_t));
+    }
+    pad();
+    writeBytes(inEdges.data(), sizes[SnapshotHeader::IN_EDGES]);
+    pad();
+
+    writeBytes(nodeColumnOffsets.data(), sizes[SnapshotHeader::NODE_ATTR_OFFSETS]);
+    pad();
+    writeColumn(nodeColumns, true);
+    writeColumn(nodeColumns, false);
+
+    writeBytes(edgeColumnOffsets.data(), sizes[SnapshotHeader::EDGE_ATTR_OFFSETS]);
+    pad();
+    writeColumn(edgeColumns, true);
+    writeColumn(edgeColumns, false);
+
+    cout << "Snapshot has " << numNodes << " nodes, " << numEdges << " edges and "
+         << strings.size() << " strings (" << written << " bytes)" << endl;
+}
+
+GraphSnapshot::GraphSnapshot(const boost::filesystem::path &path) : data{nullptr}, size{0} {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw runtime_error("Unable to open snapshot: " + path.string());
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (size_t) info.st_size < sizeof(SnapshotHeader)) {
+        close(fd);
+        throw runtime_error("Not a Rex snapshot: " + path.string());
+    }
+    size = info.st_size;
+    data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping stays valid once the file is closed
+    close(fd);
+    if (data == MAP_FAILED) {
+        data = nullptr;
+        throw runtime_error("Unable to map snapshot: " + path.string());
+    }
+
+    try {
+        header = static_cast<const SnapshotHeader *>(data);
+        if (memcmp(header->magic, SnapshotHeader::MAGIC, sizeof(header->magic)) != 0 || header->fileSize != size) {
+            throw runtime_error("Not a Rex snapshot: " + path.string());
+        }
+        if (header->version != SnapshotHeader::VERSION || header->numNodeTypes != RexNode::NUM_NODE_TYPES ||
+            header->numEdgeTypes != RexEdge::NUM_EDGE_TYPES || header->numAttributes != RexAttribute::NUM_KEYS) {
+            throw runtime_error("Snapshot was written by a different version of Rex: " + path.string());
+        }
+
+        const uint32_t numNodes = header->numNodes;
+        const uint32_t numEdges = header->numEdges;
+        stringOffsets = section<uint64_t>(SnapshotHeader::STRING_OFFSETS, header->numStrings + 1);
+        stringData = section<char>(SnapshotHeader::STRING_DATA, stringOffsets[header->numStrings]);
+        nodeTypes = section<uint8_t>(SnapshotHeader::NODE_TYPES, numNodes);
+        typeOffsets = section<uint32_t>(SnapshotHeader::TYPE_OFFSETS, RexNode::NUM_NODE_TYPES + 1);
+        typeNodes = section<uint32_t>(SnapshotHeader::TYPE_NODES, numNodes);
+        nodeFunctions = section<uint32_t>(SnapshotHeader::NODE_FUNCTIONS, numNodes);
+        outOffsets = section<uint32_t>(SnapshotHeader::OUT_OFFSETS, numNodes + 1);
+        outTypes = section<uint8_t>(SnapshotHeader::OUT_TYPES, numEdges);
+        outNodes = section<uint32_t>(SnapshotHeader::OUT_NODES, numEdges);
+        outSources = section<uint32_t>(SnapshotHeader::OUT_SOURCES, numEdges);
+        inOffsets = section<uint32_t>(SnapshotHeader::IN_OFFSETS, numNodes + 1);
+        inTypes = section<uint8_t>(SnapshotHeader::IN_TYPES, numEdges);
+        inNodes = section<uint32_t>(SnapshotHeader::IN_NODES, numEdges);
+        inEdgeNumbers = section<uint32_t>(SnapshotHeader::IN_EDGES, numEdges);
+        nodeAttrOffsets = section<uint64_t>(SnapshotHeader::NODE_ATTR_OFFSETS, RexAttribute::NUM_KEYS + 1);
+        nodeAttrItems = section<uint32_t>(SnapshotHeader::NODE_ATTR_ITEMS, nodeAttrOffsets[RexAttribute::NUM_KEYS]);
+        nodeAttrValues = section<uint32_t>(SnapshotHeader::NODE_ATTR_VALUES, nodeAttrOffsets[RexAttribute::NUM_KEYS]);
+        edgeAttrOffsets = section<uint64_t>(SnapshotHeader::EDGE_ATTR_OFFSETS, RexAttribute::NUM_KEYS + 1);
+        edgeAttrItems = section<uint32_t>(SnapshotHeader::EDGE_ATTR_ITEMS, edgeAttrOffsets[RexAttribute::NUM_KEYS]);
+        edgeAttrValues = section<uint32_t>(SnapshotHeader::EDGE_ATTR_VALUES, edgeAttrOffsets[RexAttribute::NUM_KEYS]);
+
+        // Types and attributes are stored by number, so the lists they come
+        // from must not have changed since the snapshot was written
+        uint64_t names = numNodes;
+        checkNames(names, RexNode::NUM_NODE_TYPES, [](int type) {
+            return RexNode::typeToString(static_cast<RexNode::NodeType>(type));
+        }, "node type");
+        names += RexNode::NUM_NODE_TYPES;
+        checkNames(names, RexEdge::NUM_EDGE_TYPES, [](int type) {
+            return RexEdge::typeToString(static_cast<RexEdge::EdgeType>(type));
+        }, "edge type");
+        names += RexEdge::NUM_EDGE_TYPES;
+        checkNames(names, RexAttribute::NUM_KEYS, [](int key) {
+            return RexAttribute::keyToString(static_cast<RexAttribute::Key>(key));
+        }, "attribute");
+    } catch (...) {
+        munmap(data, size);
+        throw;
+    }
+}
+
+GraphSnapshot::~GraphSnapshot() {
+    munmap(data, size);
+}
+
+template<class T>
+const T *GraphSnapshot::section(SnapshotHeader::Section section, uint64_t count) const {
+    uint64_t offset = header->sections[section];
+    if (offset % alignof(T) != 0 || offset > size || count > (size - offset) / sizeof(T)) {
+        throw runtime_error("Snapshot is truncated or corrupt");
+    }
+    return reinterpret_cast<const T *>(static_cast<const char *>(data) + offset);
+}
+
+template<class ToString>
+void GraphSnapshot::checkNames(uint64_t first, uint32_t count, ToString &&toString, const char *what) const {
+    if (first + count > header->numStrings) {
+        throw runtime_error("Snapshot is truncated or corrupt");
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        if (strcmp(getString(first + i), toString(i)) != 0) {
+            throw runtime_error(string("Snapshot was written by a different version of Rex (") + what + " " +
+                                toString(i) + " is stored as " + getString(first + i) + ")");
+        }
+    }
+}
+
+uint32_t GraphSnapshot::numNodes() const {
+    return header->numNodes;
+}
+
+uint32_t GraphSnapshot::numEdges() const {
+    return header->numEdges;
+}
+
+uint64_t GraphSnapshot::numStrings() const {
+    return header->numStrings;
+}
+
+uint64_t GraphSnapshot::fileSize() const {
+    return size;
+}
+
+uint64_t GraphSnapshot::checksum() const {
+    // FNV-1a, a word at a time since the sections are 8 byte aligned
+    const uint64_t PRIME = 0x100000001b3;
+    uint64_t hash = 0xcbf29ce484222325;
+    const char *bytes = static_cast<const char *>(data);
+    size_t position = 0;
+    for (; position + sizeof(uint64_t) <= size; position += sizeof(uint64_t)) {
+        uint64_t word;
+        memcpy(&word, bytes + position, sizeof(word));
+        hash = (hash ^ word) * PRIME;
+    }
+    for (; position < size; position++) {
+        hash = (hash ^ static_cast<unsigned char>(bytes[position])) * PRIME;
+    }
+    return hash;
+}
+
+const char *GraphSnapshot::getString(uint32_t number) const {
+    return stringData + stringOffsets[number];
+}
+
+uint32_t GraphSnapshot::findNode(const string &id) const {
+    uint32_t first = 0;
+    uint32_t last = numNodes();
+    while (first < last) {
+        uint32_t middle = first + (last - first) / 2;
+        int order = strcmp(nodeID(middle), id.c_str());
+        if (order == 0) {
+            return middle;
+        } else if (order < 0) {
+            first = middle + 1;
+        } else {
+            last = middle;
+        }
+    }
+    return NO_NODE;
+}
+
+const char *GraphSnapshot::nodeID(uint32_t node) const {
+    return getString(node);
+}
+
+RexNode::NodeType GraphSnapshot::nodeType(uint32_t node) const {
+    return static_cast<RexNode::NodeType>(nodeTypes[node]);
+}
+
+const uint32_t *GraphSnapshot::nodesBegin(RexNode::NodeType type) const {
+    return typeNodes + typeOffsets[type];
+}
+
+const uint32_t *GraphSnapshot::nodesEnd(RexNode::NodeType type) const {
+    return typeNodes + typeOffsets[type + 1];
+}
+
+uint32_t GraphSnapshot::enclosingFunction(uint32_t node) const {
+    return nodeFunctions[node];
+}
+
+// The part of a node's edges with the given type
+static GraphSnapshot::Range ofType(const uint8_t *types, GraphSnapshot::Range edges, RexEdge::EdgeType type) {
+    auto run = equal_range(types + edges.first, types + edges.last, static_cast<uint8_t>(type));
+    return GraphSnapshot::Range{(uint32_t) (run.first - types), (uint32_t) (run.second - types)};
+}
+
+GraphSnapshot::Range GraphSnapshot::outEdges(uint32_t node) const {
+    return Range{outOffsets[node], outOffsets[node + 1]};
+}
+
+GraphSnapshot::Range GraphSnapshot::outEdges(uint32_t node, RexEdge::EdgeType type) const {
+    return ofType(outTypes, outEdges(node), type);
+}
+
+GraphSnapshot::Range GraphSnapshot::inEdges(uint32_t node) const {
+    return Range{inOffsets[node], inOffsets[node + 1]};
+}
+
+GraphSnapshot::Range GraphSnapshot::inEdges(uint32_t node, RexEdge::EdgeType type) const {
+    return ofType(inTypes, inEdges(node), type);
+}
+
+uint32_t GraphSnapshot::edgeSource(uint32_t edge) const {
+    return outSources[edge];
+}
+
+uint32_t GraphSnapshot::edgeDestination(uint32_t edge) const {
+    return outNodes[edge];
+}
+
+RexEdge::EdgeType GraphSnapshot::edgeType(uint32_t edge) const {
+    return static_cast<RexEdge::EdgeType>(outTypes[edge]);
+}
+
+uint32_t GraphSnapshot::inEdgeSource(uint32_t position) const {
+    return inNodes[position];
+}
+
+uint32_t GraphSnapshot::inEdge(uint32_t position) const {
+    return inEdgeNumbers[position];
+}
+
+// The values of the given node or edge in one column
+static GraphSnapshot::Values inColumn(const uint64_t *offsets, const uint32_t *items, const uint32_t *values,
+                                      uint32_t item, RexAttribute::Key key) {
+    auto run = equal_range(items + offsets[key], items + offsets[key + 1], item);
+    return GraphSnapshot::Values{values + (run.first - items), values + (run.second - items)};
+}
+
+GraphSnapshot::Values GraphSnapshot::nodeAttribute(uint32_t node, RexAttribute::Key key) const {
+    return inColumn(nodeAttrOffsets, nodeAttrItems, nodeAttrValues, node, key);
+}
+
+GraphSnapshot::Values GraphSnapshot::edgeAttribute(uint32_t edge, RexAttribute::Key key) const {
+    return inColumn(edgeAttrOffsets, edgeAttrItems, edgeAttrValues, edge, key);
+}
@@ -0,0 +1,242 @@
+#pragma once
+
+#include <cstddef> // size_t
+#include <cstdint> // uint32_t, uint64_t
+#include <ostream> // ostream
+#include <string> // string
+#include <unordered_map> // unordered_map
+#include <vector> // vector
+
+#include <boost/filesystem.hpp>
+
+#include "TAObjectFile.h"
+#include "ConditionTable.h"
+
+// A linked graph frozen into a single file that can be mapped into memory and
+// queried as is, without parsing anything.
+//
+// Nodes are numbered in the order of their IDs, so looking up an ID is a binary
+// search. Edges are stored as compressed sparse rows in both directions. The
+// edges of each node are sorted by type and then by the node at the other end,
+// so the edges of a single type are one contiguous run. Attributes are stored
+// by column: for each attribute, the nodes (or edges) that have it and their
+// values, sorted by node (or edge). Presence conditions are stored as the
+// "condition" attribute with the condition itself as the value.
+//
+// Layout (native byte order, every section aligned to 8 bytes):
+//
+//   SnapshotHeader
+//   strings       uint64[numStrings + 1] offsets, then the NUL-terminated data.
+//                 The first numNodes strings are the node IDs, followed by the
+//                 names of every node type, edge type and attribute, and then
+//                 all attribute values.
+//   node types    uint8[numNodes]
+//   by type       uint32[NUM_NODE_TYPES + 1] offsets, uint32[numNodes] nodes
+//   functions     uint32[numNodes] enclosing function of every CFG block
+//   out edges     uint32[numNodes + 1] offsets, uint8[numEdges] types,
+//                 uint32[numEdges] destinations, uint32[numEdges] sources
+//   in edges      uint32[numNodes + 1] offsets, uint8[numEdges] types,
+//                 uint32[numEdges] sources, uint32[numEdges] edges
+//   node columns  uint64[NUM_KEYS + 1] offsets, uint32[] nodes, uint32[] values
+//   edge columns  uint64[NUM_KEYS + 1] offsets, uint32[] edges, uint32[] values
+//
+// An edge is identified by its position in the out edges. The in edges refer
+// back to those positions so that edge attributes can be found from either
+// direction.
+struct SnapshotHeader {
+    static const char MAGIC[8];
+    static const uint32_t VERSION = 2;
+
+    enum Section {
+        STRING_OFFSETS,
+        STRING_DATA,
+        NODE_TYPES,
+        TYPE_OFFSETS,
+        TYPE_NODES,
+        NODE_FUNCTIONS,
+        OUT_OFFSETS,
+        OUT_TYPES,
+        OUT_NODES,
+        OUT_SOURCES,
+        IN_OFFSETS,
+        IN_TYPES,
+        IN_NODES,
+        IN_EDGES,
+        NODE_ATTR_OFFSETS,
+        NODE_ATTR_ITEMS,
+        NODE_ATTR_VALUES,
+        EDGE_ATTR_OFFSETS,
+        EDGE_ATTR_ITEMS,
+        EDGE_ATTR_VALUES,
+        // This must always be the last variant
+        NUM_SECTIONS
+    };
+
+    char magic[8];
+    uint32_t version;
+    uint32_t numNodeTypes;
+    uint32_t numEdgeTypes;
+    uint32_t numAttributes;
+    uint32_t numNodes;
+    uint32_t numEdges;
+    uint64_t numStrings;
+    uint64_t fileSize;
+    // Byte offset of each section from the start of the file
+    uint64_t sections[NUM_SECTIONS];
+};
+
+// Collects the output of the linker and writes it out as a snapshot.
+//
+// Has the same interface as the other linker writers, but since nodes have to
+// be numbered by ID, nothing can be written until the whole graph has been
+// linked. Call write once linking is done.
+class SnapshotWriter {
+    struct Edge {
+        uint32_t source;
+        uint32_t destination;
+        uint8_t type;
+    };
+    struct Attr {
+        uint32_t item;
+        RexAttribute::Key key;
+        // Interned by RexAttributes
+        const std::string *value;
+    };
+
+    std::vector<std::string> nodeIDs;
+    std::vector<uint8_t> nodeTypes;
+    std::unordered_map<std::string, uint32_t> nodeNumbers;
+    std::vector<Edge> edges;
+
+    // Edges only get their numbers once they are sorted, so edge attributes
+    // refer to an entry in attributedEdges instead
+    std::vector<Attr> nodeAttrs;
+    std::vector<Attr> edgeAttrs;
+    std::vector<Edge> attributedEdges;
+    // (node or attributedEdges entry, condition ID) of everything written with
+    // a condition. The conditions themselves only arrive at the very end.
+    std::vector<std::pair<uint32_t, unsigned int>> nodeConditions;
+    std::vector<std::pair<uint32_t, unsigned int>> edgeConditions;
+    std::unordered_map<unsigned int, std::string> conditions;
+
+    static void addAttrs(std::vector<Attr> &attrs, uint32_t item, const RexAttributes &attributes);
+
+  public:
+    // Fact Tuple section
+    SnapshotWriter &operator<<(const TAONode &node);
+    SnapshotWriter &operator<<(const TAOEdge &edge);
+
+    // Condition IDs are kept until the table arrives at the end
+    void useConditions(const ConditionTable &) {}
+
+    // Fact Attribute Section
+    SnapshotWriter &operator<<(const TAONodeAttrs &attrs);
+    SnapshotWriter &operator<<(const TAOEdgeAttrs &attrs);
+    SnapshotWriter &operator<<(const ConditionTable &conditions);
+
+    // Freeze everything that was linked and write the snapshot
+    void write(std::ostream &out) const;
+};
+
+// A snapshot mapped into memory. Every accessor reads straight from the file.
+//
+// Node and edge numbers are only valid for the snapshot they came from.
+class GraphSnapshot {
+    void *data;
+    size_t size;
+    const SnapshotHeader *header;
+
+    const uint64_t *stringOffsets;
+    const char *stringData;
+    const uint8_t *nodeTypes;
+    const uint32_t *typeOffsets;
+    const uint32_t *typeNodes;
+    const uint32_t *nodeFunctions;
+    const uint32_t *outOffsets;
+    const uint8_t *outTypes;
+    const uint32_t *outNodes;
+    const uint32_t *outSources;
+    const uint32_t *inOffsets;
+    const uint8_t *inTypes;
+    const uint32_t *inNodes;
+    const uint32_t *inEdgeNumbers;
+    const uint64_t *nodeAttrOffsets;
+    const uint32_t *nodeAttrItems;
+    const uint32_t *nodeAttrValues;
+    const uint64_t *edgeAttrOffsets;
+    const uint32_t *edgeAttrItems;
+    const uint32_t *edgeAttrValues;
+
+    template<class T>
+    const T *section(SnapshotHeader::Section section, uint64_t count) const;
+    template<class ToString>
+    void checkNames(uint64_t first, uint32_t count, ToString &&toString, const char *what) const;
+
+  public:
+    static const uint32_t NO_NODE = UINT32_MAX;
+
+    // A run of consecutive positions in the out or in edges
+    struct Range {
+        uint32_t first;
+        uint32_t last;
+
+        uint32_t size() const { return last - first; }
+        bool empty() const { return first == last; }
+    };
+
+    // The values of one attribute of a node or edge, as string numbers
+    struct Values {
+        const uint32_t *first;
+        const uint32_t *last;
+
+        const uint32_t *begin() const { return first; }
+        const uint32_t *end() const { return last; }
+        bool empty() const { return first == last; }
+    };
+
+    // Throws runtime_error if the file can't be mapped or isn't a snapshot
+    // written by this version of Rex
+    explicit GraphSnapshot(const boost::filesystem::path &path);
+    ~GraphSnapshot();
+    GraphSnapshot(const GraphSnapshot &) = delete;
+    GraphSnapshot &operator=(const GraphSnapshot &) = delete;
+
+    uint32_t numNodes() const;
+    uint32_t numEdges() const;
+    uint64_t numStrings() const;
+
+    // Size of the file in bytes
+    uint64_t fileSize() const;
+    // A hash of every byte of the file, to tell snapshots of the same size
+    // apart. Reads the whole file.
+    uint64_t checksum() const;
+
+    const char *getString(uint32_t number) const;
+
+    // NO_NODE if there is no node with that ID
+    uint32_t findNode(const std::string &id) const;
+    const char *nodeID(uint32_t node) const;
+    RexNode::NodeType nodeType(uint32_t node) const;
+    // Every node of the given type, in the order of their IDs
+    const uint32_t *nodesBegin(RexNode::NodeType type) const;
+    const uint32_t *nodesEnd(RexNode::NodeType type) const;
+    // The function a CFG block belongs to. NO_NODE for other nodes.
+    uint32_t enclosingFunction(uint32_t node) const;
+
+    // Positions in the out edges, which are also the numbers of the edges
+    Range outEdges(uint32_t node) const;
+    Range outEdges(uint32_t node, RexEdge::EdgeType type) const;
+    // Positions in the in edges
+    Range inEdges(uint32_t node) const;
+    Range inEdges(uint32_t node, RexEdge::EdgeType type) const;
+
+    uint32_t edgeSource(uint32_t edge) const;
+    uint32_t edgeDestination(uint32_t edge) const;
+    RexEdge::EdgeType edgeType(uint32_t edge) const;
+    // The source node and the edge number at a position in the in edges
+    uint32_t inEdgeSource(uint32_t position) const;
+    uint32_t inEdge(uint32_t position) const;
+
+    Values nodeAttribute(uint32_t node, RexAttribute::Key key) const;
+    Values edgeAttribute(uint32_t edge, RexAttribute::Key key) const;
+};
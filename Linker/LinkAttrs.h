@@ -9,6 +9,7 @@
 #include <boost/filesystem/fstream.hpp> // boost::filesystem::ifstream
 
 #include "TAWriter.h"
+#include "ConditionTable.h"
 
 // This file contains an implementation of a "linking" process for node/edge
 // attributes. The process of linking attributes is the same for both nodes and
@@ -31,6 +32,9 @@
 // that the input lists of attributes be sorted by the node/edge. We use this
 // preprocessing step to link all of the attributes in only a single pass
 // through the .tao files.
+//
+// Each attribute's condition is translated from its file's condition table to
+// the linked one as it is loaded, and conditions are OR-ed when merging.
 
 template<class TAOAttrs, class Writer, class AttrsSize, class ShouldKeep, class PreOutput>
 void linkAttrs(
@@ -47,6 +51,9 @@ void linkAttrs(
     ShouldKeep &&shouldKeep,
     // Modifications before outputing
     PreOutput &&preOutput,
+    // Conditions of every file in taoFiles (already read). Conditions of the
+    // written attributes are marked as used.
+    ConditionTable &conditions,
     // Mapping of object files to their starting position
     // in an input stream
     //
@@ -69,6 +76,9 @@ void linkAttrs(
     struct AttrsSlot {
 		
 		std::string taoFile;
+        // Index of the file, for translating condition IDs
+        unsigned int file;
+        const ConditionTable *conditions;
         // The number of nodes/edges remaining to be loaded
         unsigned int remaining;
         
@@ -81,8 +91,10 @@ void linkAttrs(
         // not processed the very last TAOAttrs.
         TAOAttrs *attrs;
 
-        AttrsSlot(const fs::path &taoFile, unsigned int remaining, std::streampos currPos):
-            taoFile{taoFile.string()}, remaining{remaining}, currPos{currPos}, attrs{new TAOAttrs} {
+        AttrsSlot(const fs::path &taoFile, unsigned int file, const ConditionTable &conditions,
+                  unsigned int remaining, std::streampos currPos):
+            taoFile{taoFile.string()}, file{file}, conditions{&conditions}, remaining{remaining},
+            currPos{currPos}, attrs{new TAOAttrs} {
             // Must initialize attrs with an instance before calling load or
             // else we will read into uninitialized memory
             load();
@@ -116,6 +128,7 @@ void linkAttrs(
 				fs::ifstream objFile(taoFile);
 				objFile.seekg(currPos);
                 objFile >> *attrs;
+                attrs->condition = conditions->getID(file, attrs->condition);
                 currPos = objFile.tellg();
                 remaining--;
             } else if (attrs != nullptr) {
@@ -149,7 +162,7 @@ void linkAttrs(
     // Perform an initial load of a single set of attributes from each file
     for (unsigned int i = 0; i < taoFiles.size(); i++) {
         unsigned int remaining = attrsSize(i);
-        attrsSlots.emplace_back(taoFiles[i], remaining, objFilePos[taoFiles[i].string()]);
+        attrsSlots.emplace_back(taoFiles[i], i, conditions, remaining, objFilePos[taoFiles[i].string()]);
         if (!attrsSlots.back().isEmpty()) {
             remainingFiles += 1;
         }
@@ -176,6 +189,7 @@ void linkAttrs(
 		{
 			// Merge the duplicate into the current
 			attrs.merge(*other.attrs);
+			attrs.condition = conditions.disjunction(attrs.condition, other.attrs->condition);
 			// We can load the next one right away since we are done
 			// processing this duplicate
 			other.load();
@@ -212,6 +226,7 @@ void linkAttrs(
 			// Only write out the merged attributes if we are supposed to
 			if (shouldKeep(attrs)) {
 				preOutput(attrs);
+				conditions.markUsed(attrs.condition);
 				writer << attrs;
 			}
 			
@@ -254,6 +269,7 @@ void linkAttrs(
 
 		if (shouldKeep(attrs)) {
 			preOutput(attrs);
+			conditions.markUsed(attrs.condition);
 			writer << attrs;
 		}
 
@@ -9,12 +9,14 @@
 #include <iostream>
 #include <unordered_map>
 #include <chrono>
+#include <functional> // for function
 
 #include <boost/filesystem/fstream.hpp> // fs::ifstream
 
 #include "TAObjectFile.h"
 #include "TAWriter.h"
 #include "LinkAttrs.h"
+#include "ConditionTable.h"
 #include "../Walker/RexID.h"
 
 
@@ -31,12 +33,26 @@ static bool isEstablished(const unordered_set<string> &declaredNodes, const TAOE
     return contains(declaredNodes, edge.sourceId) && contains(declaredNodes, edge.destId);
 }
 
+// Told about every phase of the link once it is done, e.g. to add it to a
+// trace of the run. The detail may be empty.
+typedef function<void(const string &phase, steady_clock::time_point start, steady_clock::time_point end,
+                      const string &detail)> LinkTracer;
+
+// Print how long a linking phase took and pass it on to the tracer (if any)
+static void endLinkPhase(const string &phase, steady_clock::time_point start, const LinkTracer &tracer) {
+    steady_clock::time_point end = steady_clock::now();
+    cout << phase << " in " << duration_cast<seconds>(end - start).count() << " seconds" << endl;
+    if (tracer) {
+        tracer(phase, start, end, "");
+    }
+}
+
 // Link the given .tao files together into a single TA Graph and write that
 // graph to the given file path.
 //
 // Attempts to limit memory usage as much as possible during the linking process.
 template<class Writer>
-void linkObjectFiles(const vector<fs::path> &taoFiles, Writer &writer) {
+void linkObjectFiles(const vector<fs::path> &taoFiles, Writer &writer, const LinkTracer &tracer = nullptr) {
     vector<TAOFileMetadata> objMetadata;
     // Mapping of object files to their starting position
     // in an input stream
@@ -45,6 +61,8 @@ void linkObjectFiles(const vector<fs::path> &taoFiles, Writer &writer) {
 
     // We know that there will be exactly as many items here as there are files
     objMetadata.reserve(taoFiles.size());
+    // The condition table of each file comes right after its metadata
+    ConditionTable conditions;
 
     // Start to read each file
     for (unsigned int iter = 0; iter < taoFiles.size(); iter++) {
@@ -60,6 +78,7 @@ void linkObjectFiles(const vector<fs::path> &taoFiles, Writer &writer) {
 
         objMetadata.emplace_back();
         file >> objMetadata.back();
+        conditions.readFile(file, objMetadata.back().conditions);
 
         objFilePos[path.string()] = file.tellg();
 
@@ -68,7 +87,7 @@ void linkObjectFiles(const vector<fs::path> &taoFiles, Writer &writer) {
     // Build a symbol table so we can look up IDs and purge unestablished edges
     unordered_set<string> declaredNodes;
     unordered_map<string, RexNode::NodeType> declaredNodesType;
-    high_resolution_clock::time_point start = high_resolution_clock::now();
+    steady_clock::time_point start = steady_clock::now();
 
     TAONode node;
     for (unsigned int iter = 0; iter < taoFiles.size(); iter++) {
@@ -92,11 +111,9 @@ void linkObjectFiles(const vector<fs::path> &taoFiles, Writer &writer) {
 
     }
 
-    high_resolution_clock::time_point end = high_resolution_clock::now();
-	auto duration = duration_cast<seconds>(end - start).count();
-	cout << "Wrote Nodes in " << duration << " seconds" << endl;
+    endLinkPhase("Wrote Nodes", start, tracer);
 
-	start = high_resolution_clock::now();
+	start = steady_clock::now();
     // Start to write the rest of the TA file using the symbol table to
     // establish edges on the fly
     TAOEdge edge;
@@ -117,11 +134,9 @@ void linkObjectFiles(const vector<fs::path> &taoFiles, Writer &writer) {
 		objFilePos[path.string()] = objFile.tellg();
 
     }
-    end = high_resolution_clock::now();
-	duration = duration_cast<seconds>(end - start).count();
-	cout << "Established Edges in " << duration << " seconds" << endl;
+    endLinkPhase("Established Edges", start, tracer);
 
-	start = high_resolution_clock::now();
+	start = steady_clock::now();
     // Already established edges can be written without any additional lookups
 	for (unsigned int iter = 0; iter < taoFiles.size(); iter++) {
 		const fs::path &path = taoFiles[iter];
@@ -139,11 +154,11 @@ void linkObjectFiles(const vector<fs::path> &taoFiles, Writer &writer) {
         }
 		objFilePos[path.string()] = objFile.tellg();
     }
-    end = high_resolution_clock::now();
-	duration = duration_cast<seconds>(end - start).count();
-	cout << "Wrote Already Established Edges in " << duration << " seconds" << endl;
+    endLinkPhase("Wrote Already Established Edges", start, tracer);
 
-	start = high_resolution_clock::now();
+	start = steady_clock::now();
+    // Every file's conditions have been read, the attributes may add disjunctions
+    writer.useConditions(conditions);
     // Write node attributes
     linkAttrs<TAONodeAttrs>(taoFiles, writer, [&objMetadata](int file) {
         return objMetadata[file].nodesWithAttrs;
@@ -156,12 +171,10 @@ void linkObjectFiles(const vector<fs::path> &taoFiles, Writer &writer) {
         return contains(declaredNodes, nodeAttrs.id);
     }, [&declaredNodesType](TAONodeAttrs &nodeAttrs) {
         nodeAttrs.type = declaredNodesType[nodeAttrs.id];
-    }, objFilePos);
-    end = high_resolution_clock::now();
-	duration = duration_cast<seconds>(end - start).count();
-	cout << "Wrote Node Attributes in " << duration << " seconds" << endl;
+    }, conditions, objFilePos);
+    endLinkPhase("Wrote Node Attributes", start, tracer);
 
-	start = high_resolution_clock::now();
+	start = steady_clock::now();
     // Write edge attributes only for established edges
     linkAttrs<TAOEdgeAttrs>(taoFiles, writer, [&objMetadata](int file) {
         return objMetadata[file].edgesWithAttrs;
@@ -170,9 +183,159 @@ void linkObjectFiles(const vector<fs::path> &taoFiles, Writer &writer) {
     }, [=](const TAOEdgeAttrs &edgeAttrs) {
          // do nothing, surpress warnings
          (void)edgeAttrs;
-    }, objFilePos);
-    end = high_resolution_clock::now();
-	duration = duration_cast<seconds>(end - start).count();
-	cout << "Wrote Edge Attributes in " << duration << " seconds" << endl;
+    }, conditions, objFilePos);
+    endLinkPhase("Wrote Edge Attributes", start, tracer);
 
+    // Every condition referenced above, once
+    writer << conditions;
 }
+
+// Links .tao files one at a time as they become available instead of waiting
+// for the full list up front. This allows linking to overlap with extraction.
+//
+// Each file is read in a single pass through its nodes and edges. Nodes are
+// written as soon as they are first seen. Edges whose source and destination
+// have both been declared are written right away; any other edge is buffered
+// under one of its missing endpoints and re-checked once that node shows up.
+// Attributes still require every file to be present, so they are only linked
+// by finish().
+//
+// The output is the same set of facts that linkObjectFiles would produce, but
+// nodes and edges may be interleaved in the fact tuple section.
+template<class Writer>
+class StreamingLinker {
+    Writer &writer;
+
+    vector<fs::path> taoFiles;
+    vector<TAOFileMetadata> objMetadata;
+    unordered_map<string, streampos> objFilePos;
+    ConditionTable conditions;
+
+    unordered_set<string> declaredNodes;
+    unordered_map<string, RexNode::NodeType> declaredNodesType;
+    set<TAOEdge> edges;
+    // Edges waiting on the node ID they are keyed by
+    unordered_map<string, vector<TAOEdge>> pendingEdges;
+    unsigned long numPending;
+
+    // Time spent inside addObjectFile, for reporting alongside finish()
+    duration<double> streamTime;
+    LinkTracer tracer;
+
+    void writeEdge(const TAOEdge &edge) {
+        if (edges.find(edge) == edges.end()) {
+            writer << edge;
+            edges.insert(edge);
+        }
+    }
+
+    // Write the edge if it is established, otherwise buffer it until the
+    // first missing endpoint is declared
+    void establishOrDefer(const TAOEdge &edge) {
+        if (!contains(declaredNodes, edge.sourceId)) {
+            pendingEdges[edge.sourceId].push_back(edge);
+            numPending++;
+        } else if (!contains(declaredNodes, edge.destId)) {
+            pendingEdges[edge.destId].push_back(edge);
+            numPending++;
+        } else {
+            writeEdge(edge);
+        }
+    }
+
+    void declareNode(const TAONode &node) {
+        if (contains(declaredNodes, node.id)) return;
+        declaredNodes.insert(node.id);
+        declaredNodesType[node.id] = node.type;
+        writer << node;
+
+        auto waiting = pendingEdges.find(node.id);
+        if (waiting == pendingEdges.end()) return;
+        vector<TAOEdge> ready = std::move(waiting->second);
+        pendingEdges.erase(waiting);
+        numPending -= ready.size();
+        for (const TAOEdge &edge : ready) {
+            establishOrDefer(edge);
+        }
+    }
+
+public:
+    explicit StreamingLinker(Writer &writer, LinkTracer tracer = nullptr) :
+        writer{writer}, numPending{0}, streamTime{0}, tracer{std::move(tracer)} {}
+
+    // Read the nodes and edges of the given .tao file. Safe to call as soon as
+    // the job that produced the file has finished writing it.
+    void addObjectFile(const fs::path &path) {
+        steady_clock::time_point start = steady_clock::now();
+
+        fs::ifstream objFile(path);
+        // If any of these occur, the .tao file is malformed
+        objFile.exceptions(ifstream::failbit | ifstream::badbit | ifstream::eofbit);
+
+        taoFiles.push_back(path);
+        objMetadata.emplace_back();
+        TAOFileMetadata &meta = objMetadata.back();
+        objFile >> meta;
+        conditions.readFile(objFile, meta.conditions);
+
+        TAONode node;
+        for (unsigned int j = 0; j < meta.nodesSize; j++) {
+            objFile >> node;
+            declareNode(node);
+        }
+
+        TAOEdge edge;
+        for (unsigned int j = 0; j < meta.unestablishedEdges; j++) {
+            objFile >> edge;
+            establishOrDefer(edge);
+        }
+        // Already established edges can be written without any additional lookups
+        for (unsigned int j = 0; j < meta.establishedEdges; j++) {
+            objFile >> edge;
+            writeEdge(edge);
+        }
+        objFilePos[path.string()] = objFile.tellg();
+
+        steady_clock::time_point end = steady_clock::now();
+        streamTime += end - start;
+        if (tracer) {
+            tracer("Link " + path.filename().string(), start, end, path.string());
+        }
+    }
+
+    // Link the attributes of every file that was added. Any edge still pending
+    // at this point can never be established and is dropped.
+    void finish() {
+        cout << "Streamed " << taoFiles.size() << " object files in "
+             << duration_cast<seconds>(streamTime).count() << " seconds ("
+             << numPending << " unestablished edges dropped)" << endl;
+        pendingEdges.clear();
+
+        steady_clock::time_point start = steady_clock::now();
+        writer.useConditions(conditions);
+        // Write node attributes
+        linkAttrs<TAONodeAttrs>(taoFiles, writer, [this](int file) {
+            return objMetadata[file].nodesWithAttrs;
+        }, [this](const TAONodeAttrs &nodeAttrs) {
+            // Only keep nodes that have actually been established
+            return contains(declaredNodes, nodeAttrs.id);
+        }, [this](TAONodeAttrs &nodeAttrs) {
+            nodeAttrs.type = declaredNodesType[nodeAttrs.id];
+        }, conditions, objFilePos);
+        endLinkPhase("Wrote Node Attributes", start, tracer);
+
+        start = steady_clock::now();
+        // Write edge attributes only for established edges
+        linkAttrs<TAOEdgeAttrs>(taoFiles, writer, [this](int file) {
+            return objMetadata[file].edgesWithAttrs;
+        }, [this](const TAOEdgeAttrs &edgeAttrs) {
+            return isEstablished(declaredNodes, edgeAttrs.edge);
+        }, [=](const TAOEdgeAttrs &edgeAttrs) {
+             // do nothing, surpress warnings
+             (void)edgeAttrs;
+        }, conditions, objFilePos);
+        endLinkPhase("Wrote Edge Attributes", start, tracer);
+
+        writer << conditions;
+    }
+};
@@ -0,0 +1,339 @@
+#include "ReachabilityIndex.h"
+
+#include <algorithm> // min, sort, stable_sort, unique
+#include <cstring> // memcmp, memcpy
+#include <iostream> // cout, endl
+#include <numeric> // iota
+#include <stdexcept> // runtime_error
+
+#include <boost/filesystem/fstream.hpp> // fs::ifstream
+
+using namespace std;
+namespace fs = boost::filesystem;
+
+namespace {
+
+// Layout (native byte order):
+//   IndexHeader
+//   uint32[numNodes] components
+//   uint64[numComponents + 1] out offsets, uint32[numOutHubs] out hubs
+//   uint64[numComponents + 1] in offsets, uint32[numInHubs] in hubs
+struct IndexHeader {
+    char magic[8];
+    uint32_t version;
+    // Of the snapshot the index was built from
+    uint32_t numNodes;
+    uint32_t numEdges;
+    uint64_t snapshotSize;
+    uint64_t snapshotChecksum;
+    uint32_t numComponents;
+    uint64_t numOutHubs;
+    uint64_t numInHubs;
+};
+
+const char MAGIC[8] = {'R', 'E', 'X', 'R', 'E', 'A', 'C', 'H'};
+const uint32_t VERSION = 2;
+
+// An adjacency list in compressed sparse rows
+struct Adjacency {
+    vector<uint64_t> offsets;
+    vector<uint32_t> targets;
+
+    // Builds the rows from (source, target) pairs, dropping duplicates
+    Adjacency(uint32_t numRows, vector<pair<uint32_t, uint32_t>> &pairs) : offsets(numRows + 1, 0) {
+        sort(pairs.begin(), pairs.end());
+        pairs.erase(unique(pairs.begin(), pairs.end()), pairs.end());
+        targets.reserve(pairs.size());
+        for (const auto &pair : pairs) {
+            offsets[pair.first + 1]++;
+            targets.push_back(pair.second);
+        }
+        for (uint32_t row = 0; row < numRows; row++) {
+            offsets[row + 1] += offsets[row];
+        }
+    }
+
+    const uint32_t *begin(uint32_t row) const { return targets.data() + offsets[row]; }
+    const uint32_t *end(uint32_t row) const { return targets.data() + offsets[row + 1]; }
+    uint64_t size(uint32_t row) const { return offsets[row + 1] - offsets[row]; }
+};
+
+// Whether two sorted lists have an element in common
+template<class It>
+bool intersects(It left, It leftEnd, It right, It rightEnd) {
+    while (left != leftEnd && right != rightEnd) {
+        if (*left == *right) {
+            return true;
+        } else if (*left < *right) {
+            ++left;
+        } else {
+            ++right;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+bool ReachabilityIndex::isIndexed(RexEdge::EdgeType type) {
+    switch (type) {
+    case RexEdge::CALLS:
+    case RexEdge::WRITES:
+    case RexEdge::VAR_WRITES:
+    case RexEdge::PAR_WRITES:
+    case RexEdge::VAR_INFLUENCE_FUNC:
+        return true;
+    default:
+        return false;
+    }
+}
+
+ReachabilityIndex ReachabilityIndex::build(const GraphSnapshot &graph) {
+    const uint32_t numNodes = graph.numNodes();
+    vector<pair<uint32_t, uint32_t>> edges;
+    for (uint32_t node = 0; node < numNodes; node++) {
+        GraphSnapshot::Range out = graph.outEdges(node);
+        for (uint32_t edge = out.first; edge < out.last; edge++) {
+            if (isIndexed(graph.edgeType(edge))) {
+                edges.emplace_back(node, graph.edgeDestination(edge));
+            }
+        }
+    }
+    Adjacency adjacency(numNodes, edges);
+
+    ReachabilityIndex index;
+    index.numNodes = numNodes;
+    index.numEdges = graph.numEdges();
+    index.snapshotSize = graph.fileSize();
+    index.snapshotChecksum = graph.checksum();
+    index.components.assign(numNodes, 0);
+
+    // Tarjan's algorithm, without recursion since data flow chains can be
+    // far deeper than the call stack. A component is only numbered once every
+    // component it reaches has been, which gives the reverse topological order.
+    const uint32_t UNVISITED = UINT32_MAX;
+    vector<uint32_t> order(numNodes, UNVISITED);
+    vector<uint32_t> lowLink(numNodes);
+    vector<bool> onStack(numNodes, false);
+    vector<uint32_t> stack;
+    // Nodes being visited and the position of the next edge to follow
+    vector<pair<uint32_t, uint64_t>> visiting;
+    uint32_t visited = 0;
+    uint32_t numComponents = 0;
+    auto visit = [&](uint32_t node) {
+        order[node] = lowLink[node] = visited++;
+        stack.push_back(node);
+        onStack[node] = true;
+        visiting.emplace_back(node, adjacency.offsets[node]);
+    };
+    for (uint32_t root = 0; root < numNodes; root++) {
+        if (order[root] != UNVISITED) {
+            continue;
+        }
+        visit(root);
+        while (!visiting.empty()) {
+            uint32_t node = visiting.back().first;
+            uint64_t &next = visiting.back().second;
+            if (next < adjacency.offsets[node + 1]) {
+                uint32_t target = adjacency.targets[next++];
+                if (order[target] == UNVISITED) {
+                    visit(target);
+                } else if (onStack[target]) {
+                    lowLink[node] = min(lowLink[node], order[target]);
+                }
+                continue;
+            }
+
+            visiting.pop_back();
+            if (!visiting.empty()) {
+                uint32_t parent = visiting.back().first;
+                lowLink[parent] = min(lowLink[parent], lowLink[node]);
+            }
+            if (lowLink[node] == order[node]) {
+                uint32_t member;
+                do {
+                    member = stack.back();
+                    stack.pop_back();
+                    onStack[member] = false;
+                    index.components[member] = numComponents;
+                } while (member != node);
+                numComponents++;
+            }
+        }
+    }
+
+    // Condense the components into a DAG, in both directions
+    vector<pair<uint32_t, uint32_t>> forward;
+    vector<pair<uint32_t, uint32_t>> backward;
+    for (const auto &edge : edges) {
+        uint32_t from = index.components[edge.first];
+        uint32_t to = index.components[edge.second];
+        if (from != to) {
+            forward.emplace_back(from, to);
+            backward.emplace_back(to, from);
+        }
+    }
+    edges.clear();
+    edges.shrink_to_fit();
+    Adjacency successors(numComponents, forward);
+    Adjacency predecessors(numComponents, backward);
+
+    // Components on many paths make the best hubs, so choose them first. That
+    // keeps the labels of everything else short.
+    vector<uint32_t> hubs(numComponents);
+    iota(hubs.begin(), hubs.end(), 0);
+    stable_sort(hubs.begin(), hubs.end(), [&](uint32_t left, uint32_t right) {
+        return (successors.size(left) + 1) * (predecessors.size(left) + 1) >
+               (successors.size(right) + 1) * (predecessors.size(right) + 1);
+    });
+
+    // Pruned landmark labeling: search forwards and backwards from each hub,
+    // but stop at components whose reachability the labels already answer.
+    // Hubs are added in rank order, so every label stays sorted.
+    vector<vector<uint32_t>> outLabels(numComponents);
+    vector<vector<uint32_t>> inLabels(numComponents);
+    vector<uint32_t> forwardSeen(numComponents, UNVISITED);
+    vector<uint32_t> backwardSeen(numComponents, UNVISITED);
+    vector<uint32_t> queue;
+    auto search = [&](uint32_t rank, const Adjacency &next, vector<uint32_t> &seen,
+                      vector<vector<uint32_t>> &labels, auto &&covered) {
+        uint32_t hub = hubs[rank];
+        queue.assign(1, hub);
+        seen[hub] = rank;
+        labels[hub].push_back(rank);
+        for (size_t head = 0; head < queue.size(); head++) {
+            for (const uint32_t *it = next.begin(queue[head]); it != next.end(queue[head]); ++it) {
+                uint32_t component = *it;
+                if (seen[component] == rank) {
+                    continue;
+                }
+                seen[component] = rank;
+                if (covered(hub, component)) {
+                    continue;
+                }
+                labels[component].push_back(rank);
+                queue.push_back(component);
+            }
+        }
+    };
+    for (uint32_t rank = 0; rank < numComponents; rank++) {
+        search(rank, successors, forwardSeen, inLabels, [&](uint32_t hub, uint32_t component) {
+            return intersects(outLabels[hub].begin(), outLabels[hub].end(),
+                              inLabels[component].begin(), inLabels[component].end());
+        });
+        search(rank, predecessors, backwardSeen, outLabels, [&](uint32_t hub, uint32_t component) {
+            return intersects(outLabels[component].begin(), outLabels[component].end(),
+                              inLabels[hub].begin(), inLabels[hub].end());
+        });
+    }
+
+    auto flatten = [numComponents](vector<vector<uint32_t>> &labels, vector<uint64_t> &offsets,
+                                   vector<uint32_t> &flat) {
+        offsets.assign(1, 0);
+        for (uint32_t component = 0; component < numComponents; component++) {
+            flat.insert(flat.end(), labels[component].begin(), labels[component].end());
+            offsets.push_back(flat.size());
+            vector<uint32_t>().swap(labels[component]);
+        }
+    };
+    flatten(outLabels, index.outOffsets, index.outHubs);
+    flatten(inLabels, index.inOffsets, index.inHubs);
+    return index;
+}
+
+ReachabilityIndex::ReachabilityIndex(const fs::path &path, const GraphSnapshot &graph) {
+    fs::ifstream in(path, ios::binary);
+    if (!in.is_open()) {
+        throw runtime_error("Unable to open reachability index: " + path.string());
+    }
+    IndexHeader header;
+    if (!in.read(reinterpret_cast<char *>(&header), sizeof(header)) ||
+        memcmp(header.magic, MAGIC, sizeof(header.magic)) != 0) {
+        throw runtime_error("Not a Rex reachability index: " + path.string());
+    }
+    if (header.version != VERSION) {
+        throw runtime_error("Reachability index was written by a different version of Rex: " + path.string());
+    }
+    // The counts rule out most other snapshots without reading the whole file
+    if (header.numNodes != graph.numNodes() || header.numEdges != graph.numEdges() ||
+        header.snapshotSize != graph.fileSize() || header.snapshotChecksum != graph.checksum()) {
+        throw runtime_error("Reachability index was not built from this snapshot: " + path.string());
+    }
+    numNodes = header.numNodes;
+    numEdges = header.numEdges;
+    snapshotSize = header.snapshotSize;
+    snapshotChecksum = header.snapshotChecksum;
+
+    auto readArray = [&in](auto &array, uint64_t count) {
+        array.resize(count);
+        in.read(reinterpret_cast<char *>(array.data()), count * sizeof(array[0]));
+    };
+    readArray(components, numNodes);
+    readArray(outOffsets, header.numComponents + 1);
+    readArray(outHubs, header.numOutHubs);
+    readArray(inOffsets, header.numComponents + 1);
+    readArray(inHubs, header.numInHubs);
+
+    bool valid = in && in.peek() == fs::ifstream::traits_type::eof() && outOffsets.back() == header.numOutHubs &&
+                 inOffsets.back() == header.numInHubs;
+    for (uint32_t component : components) {
+        valid = valid && component < header.numComponents;
+    }
+    if (!valid) {
+        throw runtime_error("Reachability index is truncated or corrupt: " + path.string());
+    }
+}
+
+void ReachabilityIndex::write(ostream &out) const {
+    IndexHeader header = {};
+    memcpy(header.magic, MAGIC, sizeof(header.magic));
+    header.version = VERSION;
+    header.numNodes = numNodes;
+    header.numEdges = numEdges;
+    header.snapshotSize = snapshotSize;
+    header.snapshotChecksum = snapshotChecksum;
+    header.numComponents = numComponents();
+    header.numOutHubs = outHubs.size();
+    header.numInHubs = inHubs.size();
+
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    auto writeArray = [&out](const auto &array) {
+        out.write(reinterpret_cast<const char *>(array.data()), array.size() * sizeof(array[0]));
+    };
+    writeArray(components);
+    writeArray(outOffsets);
+    writeArray(outHubs);
+    writeArray(inOffsets);
+    writeArray(inHubs);
+
+    cout << "Reachability index has " << numComponents() << " components and "
+         << outHubs.size() + inHubs.size() << " hub labels" << endl;
+}
+
+uint32_t ReachabilityIndex::numComponents() const {
+    return outOffsets.size() - 1;
+}
+
+uint32_t ReachabilityIndex::component(uint32_t node) const {
+    return components[node];
+}
+
+bool ReachabilityIndex::reaches(uint32_t from, uint32_t to) const {
+    uint32_t source = components[from];
+    uint32_t destination = components[to];
+    if (source == destination) {
+        return true;
+    }
+    // Edges only ever lead to components with lower numbers
+    if (source < destination) {
+        return false;
+    }
+    return intersects(outHubs.begin() + outOffsets[source], outHubs.begin() + outOffsets[source + 1],
+                      inHubs.begin() + inOffsets[destination], inHubs.begin() + inOffsets[destination + 1]);
+}
+
+fs::path reachabilityIndexPath(const fs::path &snapshotPath) {
+    fs::path path = snapshotPath;
+    path += ".rexreach";
+    return path;
+}
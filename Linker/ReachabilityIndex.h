@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint> // uint32_t, uint64_t
+#include <ostream> // ostream
+#include <vector> // vector
+
+#include <boost/filesystem.hpp>
+
+#include "GraphSnapshot.h"
+
+// Answers whether one node of a snapshot can reach another through call,
+// write, varWrite, parWrite and varInfFunc edges, without walking the graph.
+//
+// The strongly connected components of those edges are condensed into a DAG,
+// and every component gets 2-hop labels (pruned landmark labeling): a list of
+// hub components it reaches and a list of hubs that reach it. A component
+// reaches another exactly when its out hubs and the other's in hubs have a
+// hub in common. The labels are usually a handful of hubs long, so a query is
+// a merge of two short sorted lists.
+//
+// The index refers to nodes by their numbers in the snapshot it was built
+// from and is only valid alongside that snapshot. It records the size and a
+// checksum of that snapshot, so it can't be loaded with any other.
+class ReachabilityIndex {
+    // Of the snapshot the index was built from
+    uint32_t numNodes;
+    uint32_t numEdges;
+    uint64_t snapshotSize;
+    uint64_t snapshotChecksum;
+    // The component of every node. Components are numbered in reverse
+    // topological order, so edges always go to a component with a lower number.
+    std::vector<uint32_t> components;
+    // Hubs of every component, as ranks in the order hubs were chosen
+    std::vector<uint64_t> outOffsets;
+    std::vector<uint32_t> outHubs;
+    std::vector<uint64_t> inOffsets;
+    std::vector<uint32_t> inHubs;
+
+    ReachabilityIndex() = default;
+
+  public:
+    // Whether edges of this type are followed by the index
+    static bool isIndexed(RexEdge::EdgeType type);
+
+    static ReachabilityIndex build(const GraphSnapshot &graph);
+    // Throws runtime_error if the file can't be read or wasn't built from the
+    // given snapshot
+    ReachabilityIndex(const boost::filesystem::path &path, const GraphSnapshot &graph);
+
+    void write(std::ostream &out) const;
+
+    uint32_t numComponents() const;
+    uint32_t component(uint32_t node) const;
+    // Whether there is a path of zero or more indexed edges between the nodes
+    bool reaches(uint32_t from, uint32_t to) const;
+};
+
+// The index that goes with a snapshot, written next to it as <snapshot>.rexreach
+boost::filesystem::path reachabilityIndexPath(const boost::filesystem::path &snapshotPath);
@@ -50,95 +50,85 @@ public:
     }
 };
 
-static void writeSingleAttributes(ostream &out, const map<string, string> &attrs) {
-    for (auto &entry : attrs) {
-        out << LenDataStr(entry.first) << ' ' << LenDataStr(entry.second) << ' ';
-    }
-}
-
-static void readSingleAttributes(istream &in, unsigned int size, map<string, string> &attrs) {
-    // Need to clear the attributes or else this may just append more instead of
-    // overwriting the value of `attrs`.
-    attrs.clear();
-
-    // Reuse the same buffer in every loop iteration
-    string key;
-
-    for (unsigned int i = 0; i < size; i++) {
-        LenDataStr::read(in, key);
-        LenDataStr::read(in, attrs[key]);
+static void writeAttributes(ostream &out, const RexAttributes &attrs) {
+    out << attrs.singles().size() << ' ' << attrs.multis().size() << ' ';
 
-        key.clear();
+    // Keys are written by name so that adding an attribute doesn't invalidate
+    // every .tao file
+    for (auto &entry : attrs.singles()) {
+        out << LenDataStr(RexAttribute::keyToString(entry.key)) << ' ' << LenDataStr(*entry.value) << ' ';
     }
-}
 
-static void writeMultiAttributes(ostream &out, const map<string, vector<string>> &attrs) {
-    for (auto &entry : attrs) {
-        out << LenDataStr(entry.first) << ' ';
+    for (auto &entry : attrs.multis()) {
+        out << LenDataStr(RexAttribute::keyToString(entry.key)) << ' ';
 
-        out << entry.second.size() << ' ';
-        for (auto &vecEntry : entry.second) {
-            out << LenDataStr(vecEntry) << ' ';
+        out << entry.values.size() << ' ';
+        for (auto &value : entry.values) {
+            out << LenDataStr(*value) << ' ';
         }
     }
 }
 
-static void readMultiAttributes(istream &in, unsigned int size, map<string, vector<string>> &attrs) {
+static void readAttributes(istream &in, RexAttributes &attrs) {
     // Need to clear the attributes or else this may just append more instead of
     // overwriting the value of `attrs`.
     attrs.clear();
 
-    // Reuse the same buffer in every loop iteration
+    unsigned int single, multi;
+    in >> single >> multi;
+
+    // Reuse the same buffers in every loop iteration
     string key;
+    string value;
 
-    for (unsigned int i = 0; i < size; i++) {
+    for (unsigned int i = 0; i < single; i++) {
         LenDataStr::read(in, key);
+        LenDataStr::read(in, value);
+        attrs.set(RexAttribute::stringToKey(key), value);
+    }
+
+    for (unsigned int i = 0; i < multi; i++) {
+        LenDataStr::read(in, key);
+        RexAttribute::Key attr = RexAttribute::stringToKey(key);
 
         unsigned int valuesSize;
         in >> valuesSize;
-
-        vector<string> &values = attrs[key];
-        values.resize(valuesSize);
         for (unsigned int j = 0; j < valuesSize; j++) {
-            LenDataStr::read(in, attrs[key][j]);
+            LenDataStr::read(in, value);
+            attrs.add(attr, value);
         }
-
-        key.clear();
     }
 }
 
-static void mergeSingleAttributes(map<string, string> &attrs, const map<string, string> &other) {
-    for (const auto &entry : other) {
-        // C++20 adds a contains method to std::map that would make this nicer
-        if (attrs.find(entry.first) != attrs.cend() && attrs[entry.first] != entry.second) {
+static void mergeAttributes(RexAttributes &attrs, const RexAttributes &other) {
+    for (const auto &entry : other.singles()) {
+        const string *value = attrs.get(entry.key);
+        // Values are interned, so equal values are the same pointer
+        if (value && value != entry.value) {
             // `isControlFlow` indicates that the node is used in a control flow decision in *at least one* component.
-            if (entry.first == "isControlFlow" && entry.second == "1") {
-                attrs[entry.first] = "1";
+            if (entry.key == RexAttribute::IS_CONTROL_FLOW && *entry.value == "1") {
+                attrs.set(entry.key, "1");
             }
             // We are overwriting an attribute with a different value.
             // That means that we are *losing* some info we meant to record.
-            //cerr << "Rex Linker Warning: Single-attribute was overwritten during merging: '" << entry.first << "'" << endl;
+            //cerr << "Rex Linker Warning: Single-attribute was overwritten during merging: '" << RexAttribute::keyToString(entry.key) << "'" << endl;
 
             //TODO: We need to do some intelligent merging where we do one of three things based on the attribute name:
             // 1. Merge the values (when there is a logical way to merge)
             // 2. Produce a Rex Warning (when the user's code needs fixing)
             // 3. Throw an exception (when Rex shouldn't produce conflicting values)
             // Note that we only need to merge if the values are different.
-            //throw logic_error("Single-attribute '" + entry.first + "' was overwritten during merging");
+            //throw logic_error("Single-attribute '" + string(RexAttribute::keyToString(entry.key)) + "' was overwritten during merging");
 
+        } else if (!value) {
+            attrs.set(entry.key, *entry.value);
         }
-
-        attrs.insert(entry);
     }
-}
 
-static void mergeMultiAttributes(map<string, vector<string>> &attrs, const map<string, vector<string>> &other) {
-    for (const auto &entry : other) {
-        const vector<string> &otherValues = entry.second;
-
-        vector<string> &values = attrs[entry.first];
-        values.reserve(values.size() + otherValues.size());
-        values.insert(values.end(), otherValues.cbegin(), otherValues.cend());
+    for (const auto &entry : other.multis()) {
+        for (const string *value : entry.values) {
+            attrs.add(entry.key, *value);
+        }
     }
 }
 
@@ -147,14 +137,16 @@ TAOFileMetadata::TAOFileMetadata():
     unestablishedEdges{0},
     establishedEdges{0},
     nodesWithAttrs{0},
-    edgesWithAttrs{0} {}
+    edgesWithAttrs{0},
+    conditions{0} {}
 
-ostream &TAOFileMetadata::write(ostream &out, const TAGraph &graph) {
+ostream &TAOFileMetadata::write(ostream &out, const TAGraph &graph, unsigned int conditions) {
     out << graph.keptNodes() << ' ';
     out << graph.unestablishedEdgesSize() << ' ';
     out << graph.establishedEdgesSize() << ' ';
     out << graph.keptNodes() << ' ';
-    out << graph.unestablishedEdgesSize() + graph.establishedEdgesSize();
+    out << graph.unestablishedEdgesSize() + graph.establishedEdgesSize() << ' ';
+    out << conditions;
     return out;
 }
 
@@ -164,6 +156,20 @@ istream &operator>>(istream &in, TAOFileMetadata &meta) {
     in >> meta.establishedEdges;
     in >> meta.nodesWithAttrs;
     in >> meta.edgesWithAttrs;
+    in >> meta.conditions;
+    return in;
+}
+
+TAOCondition::TAOCondition(): id{0} {}
+
+ostream &TAOCondition::write(ostream &out, unsigned int id, const string &condition) {
+    out << id << ' ' << LenDataStr(condition);
+    return out;
+}
+
+istream &operator>>(istream &in, TAOCondition &condition) {
+    in >> condition.id;
+    LenDataStr::read(in, condition.condition);
     return in;
 }
 
@@ -229,7 +235,7 @@ istream &operator>>(istream &in, TAOEdge &edge) {
 }
 
 bool TAOAttrs::empty() const {
-    return singleAttrs.empty() && multiAttrs.empty();
+    return attributes.empty() && condition == 0;
 }
 
 TAONodeAttrs::TAONodeAttrs() {}
@@ -242,32 +248,27 @@ bool TAONodeAttrs::canMerge(const TAONodeAttrs &other) const {
     return id == other.id;
 }
 void TAONodeAttrs::merge(const TAONodeAttrs &other) {
-    mergeSingleAttributes(singleAttrs, other.singleAttrs);
-    mergeMultiAttributes(multiAttrs, other.multiAttrs);
+    mergeAttributes(attributes, other.attributes);
 }
 bool TAONodeAttrs::operator<(const TAONodeAttrs &other) const {
     return RexNode::compare(*this, other);
 }
 bool TAONodeAttrs::empty() const {
-    return singleAttrs.empty() && multiAttrs.empty();
+    return TAOAttrs::empty();
 }
 
-ostream &TAONodeAttrs::write(ostream &out, const RexNode &node) {
+ostream &TAONodeAttrs::write(ostream &out, const RexNode &node, unsigned int condition) {
     out << LenDataStr(node.getID()) << ' ';
+    out << condition << ' ';
 
-    out << node.getNumSingleAttributes() << ' ' << node.getNumMultiAttributes() << ' ';
-    writeSingleAttributes(out, node.getSingleAttributes());
-    writeMultiAttributes(out, node.getMultiAttributes());
+    writeAttributes(out, node.getAttributes());
     return out;
 }
 
 istream &operator>>(istream &in, TAONodeAttrs &attrs) {
     LenDataStr::read(in, attrs.id);
-
-    unsigned int single, multi;
-    in >> single >> multi;
-    readSingleAttributes(in, single, attrs.singleAttrs);
-    readMultiAttributes(in, multi, attrs.multiAttrs);
+    in >> attrs.condition;
+    readAttributes(in, attrs.attributes);
     return in;
 }
 
@@ -277,31 +278,26 @@ bool TAOEdgeAttrs::canMerge(const TAOEdgeAttrs &other) const {
     return edge == other.edge;
 }
 void TAOEdgeAttrs::merge(const TAOEdgeAttrs &other) {
-    mergeSingleAttributes(singleAttrs, other.singleAttrs);
-    mergeMultiAttributes(multiAttrs, other.multiAttrs);
+    mergeAttributes(attributes, other.attributes);
 }
 bool TAOEdgeAttrs::operator<(const TAOEdgeAttrs &other) const {
     return edge < other.edge;
 }
 bool TAOEdgeAttrs::empty() const {
-    return singleAttrs.empty() && multiAttrs.empty();
+    return TAOAttrs::empty();
 }
 
-ostream &TAOEdgeAttrs::write(ostream &out, const RexEdge &edge) {
+ostream &TAOEdgeAttrs::write(ostream &out, const RexEdge &edge, unsigned int condition) {
     TAOEdge::write(out, edge) << ' ';
+    out << condition << ' ';
 
-    out << edge.getNumSingleAttributes() << ' ' << edge.getNumMultiAttributes() << ' ';
-    writeSingleAttributes(out, edge.getSingleAttributes());
-    writeMultiAttributes(out, edge.getMultiAttributes());
+    writeAttributes(out, edge.getAttributes());
     return out;
 }
 
 istream &operator>>(istream &in, TAOEdgeAttrs &attrs) {
     in >> attrs.edge;
-
-    unsigned int single, multi;
-    in >> single >> multi;
-    readSingleAttributes(in, single, attrs.singleAttrs);
-    readMultiAttributes(in, multi, attrs.multiAttrs);
+    in >> attrs.condition;
+    readAttributes(in, attrs.attributes);
     return in;
 }
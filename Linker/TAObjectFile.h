@@ -23,15 +23,31 @@ struct TAOFileMetadata {
     unsigned int establishedEdges;
     unsigned int nodesWithAttrs;
     unsigned int edgesWithAttrs;
+    unsigned int conditions;
 
     TAOFileMetadata();
 
     // Not an operator (to avoid copying)
-    static std::ostream &write(std::ostream &out, const TAGraph &graph);
+    static std::ostream &write(std::ostream &out, const TAGraph &graph, unsigned int conditions);
 
     friend std::istream &operator>>(std::istream &in, TAOFileMetadata &meta);
 };
 
+// An entry in the condition table, which comes right after the metadata. Node
+// and edge attributes refer to conditions by their ID in this table, with 0
+// meaning that there is no condition.
+struct TAOCondition {
+    unsigned int id;
+    std::string condition;
+
+    TAOCondition();
+
+    // Not an operator (to avoid copying)
+    static std::ostream &write(std::ostream &out, unsigned int id, const std::string &condition);
+
+    friend std::istream &operator>>(std::istream &in, TAOCondition &condition);
+};
+
 struct TAONode {
     std::string id;
     RexNode::NodeType type;
@@ -69,8 +85,9 @@ struct TAOEdge {
 
 struct TAOAttrs {
     virtual ~TAOAttrs() = default;
-    std::map<std::string, std::string> singleAttrs;
-    std::map<std::string, std::vector<std::string>> multiAttrs;
+    RexAttributes attributes;
+    // ID in the condition table (0 if none)
+    unsigned int condition = 0;
 
     bool empty() const;
 };
@@ -90,7 +107,7 @@ struct TAONodeAttrs: public TAOAttrs {
     bool empty() const;
 
     // Not an operator (to avoid copying)
-    static std::ostream &write(std::ostream &out, const RexNode &node);
+    static std::ostream &write(std::ostream &out, const RexNode &node, unsigned int condition);
 
     friend std::istream &operator>>(std::istream &in, TAONodeAttrs &attrs);
 };
@@ -106,7 +123,7 @@ struct TAOEdgeAttrs: public TAOAttrs {
     bool empty() const;
 
     // Not an operator (to avoid copying)
-    static std::ostream &write(std::ostream &out, const RexEdge &edge);
+    static std::ostream &write(std::ostream &out, const RexEdge &edge, unsigned int condition);
 
     friend std::istream &operator>>(std::istream &in, TAOEdgeAttrs &attrs);
 };
@@ -3,6 +3,9 @@
 #include "TAObjectFile.h"
 
 #include <algorithm> // for std::sort
+#include <unordered_map> // for std::unordered_map
+
+#include "../Walker/CondScope.h"
 
 using namespace std;
 
@@ -14,8 +17,34 @@ ostream &operator<<(ostream &out, const TAObjectWriter &writer) {
     // Much of this code favors making multiple passes over the nodes and edges
     // instead of storing intermediate results so that we don't have to allocate
 
+    // Number every distinct condition. Conditions are shared (see
+    // RexCond::intern), so equal conditions are the same pointer.
+    unordered_map<const RexCond *, unsigned int> conditionIDs;
+    vector<const RexCond *> conditions;
+    auto addCondition = [&conditionIDs, &conditions](const RexCond *cond) {
+        if (cond && conditionIDs.emplace(cond, conditions.size() + 1).second) {
+            conditions.push_back(cond);
+        }
+    };
+    for (const RexNode &node : graph.nodes()) {
+        if (node.keep()) {
+            addCondition(node.getCond());
+        }
+    }
+    for (const RexEdge &edge : graph.edges()) {
+        addCondition(edge.getCond());
+    }
+    auto conditionID = [&conditionIDs](const RexCond *cond) {
+        return cond ? conditionIDs.at(cond) : 0;
+    };
+
     // Write out the sizes so we can quickly jump to any point in the file
-    TAOFileMetadata::write(out, graph) << endl;
+    TAOFileMetadata::write(out, graph, conditions.size()) << endl;
+
+    // The condition table, so attributes only need to store an ID
+    for (unsigned int i = 0; i < conditions.size(); i++) {
+        TAOCondition::write(out, i + 1, conditions[i]->to_string()) << endl;
+    }
 
     // Nodes first so we can load them into the symbol table
     for (const RexNode &node : graph.nodes()) {
@@ -56,7 +85,7 @@ ostream &operator<<(ostream &out, const TAObjectWriter &writer) {
         return RexNode::compare(*left, *right);
     });
     for (const RexNode *node : nodes) {
-        TAONodeAttrs::write(out, *node) << endl;
+        TAONodeAttrs::write(out, *node, conditionID(node->getCond())) << endl;
     }
 
     // Edge attributes will be filtered during linking to only include edges
@@ -70,7 +99,7 @@ ostream &operator<<(ostream &out, const TAObjectWriter &writer) {
         return RexEdge::compare(*left, *right);
     });
     for (const RexEdge *edge : edges) {
-        TAOEdgeAttrs::write(out, *edge) << endl;
+        TAOEdgeAttrs::write(out, *edge, conditionID(edge->getCond())) << endl;
     }
 
     return out;
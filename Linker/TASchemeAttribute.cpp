@@ -156,6 +156,13 @@ const vector<TASchemeAttribute> &TASchemeAttribute::allNodeAttrs() {
                 {PRESENCE_CONDITION}
             }
         ),
+        TASchemeAttribute(
+            RexNode::CFG_BLOCK,
+            {
+                {CFG_FUNCTION},
+                {PRESENCE_CONDITION}
+            }
+        ),
     };
     return scheme;
 }
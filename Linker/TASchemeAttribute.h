@@ -4,6 +4,7 @@
 #include <vector> // string
 #include <ostream> // ostream
 
+#include "../Graph/RexAttributes.h"
 #include "../Graph/RexNode.h"
 #include "../Graph/RexEdge.h"
 
@@ -11,36 +12,11 @@
 // entity.
 class TASchemeAttribute {
 public:
-    // static constexpr const char* CFG_BLOCKS = "cfgBlocks";
-    static constexpr const char* CFG_CALLING_FUNCTION_ID = "callingFunctionID";
-    static constexpr const char* CFG_INVOKE = "cfgInvoke";
-    static constexpr const char* CFG_RETURN = "cfgReturn";
-    static constexpr const char* CLASS_STYLE="class_style";
-    static constexpr const char* COLOR="color";
-    static constexpr const char* NO_DEF="noDef";
-    // static constexpr const char* CONTAINING_FUNCTIONS="containingFuncs";
-    static constexpr const char* FILE="file";
-    static constexpr const char* FILENAME="filename";
-    static constexpr const char* FILENAME_DECLARE="filenameDeclare";
-    static constexpr const char* IS_CONTROL_FLOW="isControlFlow";
-    static constexpr const char* IS_PARAM="isParam";
-    static constexpr const char* IS_PUBLISHER="isPublisher";
-    static constexpr const char* IS_STATIC="isStatic";
-    static constexpr const char* IS_SUBSCRIBER="isSubscriber";
-    static constexpr const char* IS_UNDER_CONTROL="isUnderControl";
-    static constexpr const char* LABEL="label";
-    static constexpr const char* LINE="line";
-    static constexpr const char* ROS_CALLBACK="callbackFunc";
-    static constexpr const char* ROS_IS_CALLBACK="isCallbackFunc";
-    static constexpr const char* ROS_NUMBER="rosNumber";
-    static constexpr const char* ROS_NUM_ATTRIBUTES="numAttributes";
-    static constexpr const char* ROS_PUBLISHER_DATA="pubData";
-    static constexpr const char* ROS_PUBLISHER_TYPE="publisherType";
-    static constexpr const char* ROS_TIMER_DURATION = "timerDuration";
-    static constexpr const char* ROS_TIMER_IS_ONESHOT="isOneshot";
-    static constexpr const char* ROS_TOPIC_BUFFER_SIZE="bufferSize";
-    static constexpr const char* PRESENCE_CONDITION="condition";
-    static constexpr const char* LINE_NUMBER="LINE_NUMBER";
+    // The names of the attributes that nodes and edges can record, e.g. LABEL
+    // is "label" (see REX_ATTRIBUTES)
+#define REX_ATTRIBUTE_NAME(key, name) static constexpr const char *key = name;
+    REX_ATTRIBUTES(REX_ATTRIBUTE_NAME)
+#undef REX_ATTRIBUTE_NAME
 
     struct TAAttribute {
         // Name of the attribute, must be non-empty
@@ -1,5 +1,7 @@
 #include "TAWriter.h"
 
+#include <stdexcept> // logic_error
+
 #include "TASchema.h"
 #include "TASchemeAttribute.h"
 
@@ -76,7 +78,7 @@ void TAWriter::writeSchemeAttributeSection() {
     }
 }
 
-TAWriter::TAWriter(ostream &out): out{out}, currentSection{TASection::FileStart} {
+TAWriter::TAWriter(ostream &out): out{out}, currentSection{TASection::FileStart}, conditions{nullptr} {
     out << "//Full Rex Extraction" << endl;
     out << "//Original Author: Bryan J Muscedere" << endl;
     out << "//Current Author: WatForm & SWAG (University of Waterloo)" << endl;
@@ -102,17 +104,30 @@ TAWriter &TAWriter::operator<<(const TAOEdge &edge) {
     return *this;
 }
 
-static void writeSingleAttributes(ostream &out, const map<string, string> &attrs) {
-    for (auto &entry : attrs) {
-        out << entry.first << " = " << quote(entry.second) << ' ';
+void TAWriter::useConditions(const ConditionTable &conditions) {
+    this->conditions = &conditions;
+}
+
+// TA has no way to refer to the conditions by ID without declaring each of
+// them as an entity in the fact tuples, which are already written by now
+void TAWriter::writeCondition(unsigned int condition) {
+    if (condition) {
+        if (!conditions) {
+            throw logic_error("TAWriter: conditional attribute written before useConditions()");
+        }
+        out << TASchemeAttribute::PRESENCE_CONDITION << " = " << quote(conditions->getCondition(condition)) << ' ';
     }
 }
 
-static void writeMultiAttributes(ostream &out, const map<string, vector<string>> &attrs) {
-    for (auto &entry : attrs) {
-        out << entry.first << " = ( ";
-        for (auto &vecEntry : entry.second) {
-            out << quote(vecEntry) << ' ';
+static void writeAttributes(ostream &out, const RexAttributes &attrs) {
+    for (auto &entry : attrs.singles()) {
+        out << RexAttribute::keyToString(entry.key) << " = " << quote(*entry.value) << ' ';
+    }
+
+    for (auto &entry : attrs.multis()) {
+        out << RexAttribute::keyToString(entry.key) << " = ( ";
+        for (auto &value : entry.values) {
+            out << quote(*value) << ' ';
         }
         out << ") ";
     }
@@ -124,8 +139,8 @@ TAWriter &TAWriter::operator<<(const TAONodeAttrs &attrs) {
     beginIfNecessary(TASection::FactAttribute);
 
     out << quote(attrs.id) << " { ";
-    writeSingleAttributes(out, attrs.singleAttrs);
-    writeMultiAttributes(out, attrs.multiAttrs);
+    writeCondition(attrs.condition);
+    writeAttributes(out, attrs.attributes);
     out << '}';
     out << endl;
 
@@ -143,10 +158,15 @@ TAWriter &TAWriter::operator<<(const TAOEdgeAttrs &attrs) {
     out << quote(attrs.edge.destId) << ") ";
 
     out << "{ ";
-    writeSingleAttributes(out, attrs.singleAttrs);
-    writeMultiAttributes(out, attrs.multiAttrs);
+    writeCondition(attrs.condition);
+    writeAttributes(out, attrs.attributes);
     out << '}';
     out << endl;
 
     return *this;
 }
+
+TAWriter &TAWriter::operator<<(const ConditionTable &) {
+    // Empty, only kept so TAWriter has the same interface as the other writers
+    return *this;
+}
@@ -5,6 +5,7 @@
 #include <exception> // exception
 
 #include "TAObjectFile.h"
+#include "ConditionTable.h"
 
 // Writes a TA file directly to disk (without keeping anything in memory).
 //
@@ -34,11 +35,14 @@ class TAWriter {
 
     std::ostream &out;
     TASection currentSection;
+    // Where the text of the condition IDs of attributes is looked up
+    const ConditionTable *conditions;
 
     void writeSectionTitle(TASection section);
     void beginIfNecessary(TASection section);
     void writeSchemeTupleSection();
     void writeSchemeAttributeSection();
+    void writeCondition(unsigned int condition);
 public:
     // Represents that an attempt was made to write something that wasn't
     // currently expected.
@@ -59,7 +63,14 @@ public:
     TAWriter &operator<<(const TAONode &node);
     TAWriter &operator<<(const TAOEdge &fact);
 
+    // Conditions are written inline, as the text of the presence condition
+    // attribute, so the table has to be given before any attributes are.
+    // Writing a conditional attribute without it throws logic_error.
+    void useConditions(const ConditionTable &conditions);
+
     // Fact Attribute Section
     TAWriter &operator<<(const TAONodeAttrs &attrs);
     TAWriter &operator<<(const TAOEdgeAttrs &attrs);
+    // Nothing left to write, the conditions were written with the attributes
+    TAWriter &operator<<(const ConditionTable &conditions);
 };
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "ConditionTable.h"
+
+// Passes everything the linker writes on to two writers, so that a single link
+// can produce two outputs (e.g. a TA file and a snapshot of the same graph).
+template<class First, class Second>
+class TeeWriter {
+  First &first;
+  Second &second;
+
+public:
+  TeeWriter(First &first, Second &second) : first{first}, second{second} {}
+
+  void useConditions(const ConditionTable &conditions) {
+    first.useConditions(conditions);
+    second.useConditions(conditions);
+  }
+
+  template<class Fact>
+  TeeWriter &operator<<(const Fact &fact) {
+    first << fact;
+    second << fact;
+    return *this;
+  }
+};
@@ -0,0 +1,449 @@
+#include "PathQuery.h"
+
+#include <algorithm> // binary_search, set_intersection, sort, unique
+#include <atomic> // atomic
+#include <iterator> // back_inserter
+#include <stdexcept> // logic_error
+#include <string> // string
+#include <thread> // thread
+#include <unordered_map> // unordered_map
+#include <unordered_set> // unordered_set
+
+using namespace std;
+
+// Edges a candidate path is made of, before its final varInfFunc edge
+static const RexEdge::EdgeType FLOW_TYPES[] = {RexEdge::CALLS, RexEdge::WRITES, RexEdge::VAR_WRITES};
+static const unsigned int NUM_FLOW_TYPES = sizeof(FLOW_TYPES) / sizeof(FLOW_TYPES[0]);
+
+// Sorted, distinct node numbers
+typedef vector<uint32_t> NodeSet;
+
+static NodeSet intersect(const NodeSet &left, const NodeSet &right) {
+    NodeSet both;
+    set_intersection(left.begin(), left.end(), right.begin(), right.end(), back_inserter(both));
+    return both;
+}
+
+static void normalize(NodeSet &nodes) {
+    sort(nodes.begin(), nodes.end());
+    nodes.erase(unique(nodes.begin(), nodes.end()), nodes.end());
+}
+
+namespace {
+
+// Checks candidate paths for a single worker thread. Keeps its own caches so
+// that workers never have to share anything but the graph.
+class PathChecker {
+    const PathQuery &query;
+    const GraphSnapshot &graph;
+
+    // Every function transitively called by a function, by caller
+    unordered_map<uint32_t, NodeSet> transitiveCallees;
+    unsigned long queriesRun;
+
+    // Edges used by the path being built, since a path can't use an edge twice
+    vector<bool> used;
+
+    // A function on the path and the sets of CFG blocks, in order, that the
+    // path must pass through inside of it
+    struct StackFrame {
+        uint32_t function;
+        vector<NodeSet> steps;
+
+        StackFrame(uint32_t function, const NodeSet &blocks) : function{function}, steps{blocks} {}
+
+        bool empty() const { return steps.size() == 1; }
+    };
+    typedef vector<StackFrame> Stack;
+
+    // State of the path being visited
+    const vector<uint32_t> *path;
+    bool firstRelationshipIsCall;
+    bool returnedToFirstFunc;
+
+    NodeSet targets(uint32_t node, RexEdge::EdgeType type) const {
+        GraphSnapshot::Range edges = graph.outEdges(node, type);
+        NodeSet nodes;
+        nodes.reserve(edges.size());
+        for (uint32_t edge = edges.first; edge < edges.last; edge++) {
+            // Already sorted, edges of the same type are ordered by destination
+            nodes.push_back(graph.edgeDestination(edge));
+        }
+        return nodes;
+    }
+
+    // The CFG blocks the fact represented by an edge happens in
+    NodeSet cfgBlocks(uint32_t edge) const {
+        uint32_t source = graph.edgeSource(edge);
+        uint32_t destination = graph.edgeDestination(edge);
+        switch (graph.edgeType(edge)) {
+            case RexEdge::WRITES:
+                return intersect(targets(source, RexEdge::W_SOURCE), targets(destination, RexEdge::W_DESTINATION));
+            case RexEdge::VAR_WRITES:
+                return intersect(targets(source, RexEdge::VW_SOURCE), targets(destination, RexEdge::VW_DESTINATION));
+            case RexEdge::CALLS: {
+                // Only the call sites of this callee, i.e. blocks that invoke its entry
+                NodeSet entries = targets(destination, RexEdge::C_DESTINATION);
+                NodeSet sites;
+                for (uint32_t block : targets(source, RexEdge::C_SOURCE)) {
+                    GraphSnapshot::Range next = graph.outEdges(block, RexEdge::NEXT_CFG_BLOCK);
+                    for (uint32_t e = next.first; e < next.last; e++) {
+                        if (binary_search(entries.begin(), entries.end(), graph.edgeDestination(e))) {
+                            sites.push_back(block);
+                            break;
+                        }
+                    }
+                }
+                return sites;
+            }
+            case RexEdge::VAR_INFLUENCE_FUNC: {
+                // The condition blocks in the functions that make the influenced call
+                NodeSet callers;
+                for (uint32_t block : targets(destination, RexEdge::VIF_DESTINATION)) {
+                    callers.push_back(graph.enclosingFunction(block));
+                }
+                normalize(callers);
+                NodeSet conditions;
+                for (uint32_t block : targets(source, RexEdge::VIF_SOURCE)) {
+                    if (binary_search(callers.begin(), callers.end(), graph.enclosingFunction(block))) {
+                        conditions.push_back(block);
+                    }
+                }
+                return conditions;
+            }
+            default:
+                return NodeSet{};
+        }
+    }
+
+    // Blocks reachable from the given ones in their own functions, optionally
+    // including the given blocks themselves
+    NodeSet reachable(const NodeSet &from, bool includeStart) const {
+        // A function only has a handful of blocks, so don't size this by the graph
+        unordered_set<uint32_t> seen;
+        NodeSet reached;
+        vector<uint32_t> frontier;
+        for (uint32_t block : from) {
+            if (includeStart) {
+                seen.insert(block);
+                reached.push_back(block);
+            }
+            frontier.push_back(block);
+        }
+        while (!frontier.empty()) {
+            uint32_t block = frontier.back();
+            frontier.pop_back();
+            GraphSnapshot::Range next = graph.outEdges(block, RexEdge::NEXT_CFG_BLOCK);
+            for (uint32_t edge = next.first; edge < next.last; edge++) {
+                uint32_t successor = graph.edgeDestination(edge);
+                if (query.isIntraprocedural(edge) && seen.insert(successor).second) {
+                    reached.push_back(successor);
+                    frontier.push_back(successor);
+                }
+            }
+        }
+        normalize(reached);
+        return reached;
+    }
+
+    const NodeSet &callees(uint32_t function) {
+        auto cached = transitiveCallees.find(function);
+        if (cached != transitiveCallees.end()) {
+            return cached->second;
+        }
+        vector<bool> seen(graph.numNodes(), false);
+        NodeSet called;
+        vector<uint32_t> frontier{function};
+        while (!frontier.empty()) {
+            uint32_t caller = frontier.back();
+            frontier.pop_back();
+            GraphSnapshot::Range calls = graph.outEdges(caller, RexEdge::CALLS);
+            for (uint32_t edge = calls.first; edge < calls.last; edge++) {
+                uint32_t callee = graph.edgeDestination(edge);
+                if (!seen[callee]) {
+                    seen[callee] = true;
+                    called.push_back(callee);
+                    frontier.push_back(callee);
+                }
+            }
+        }
+        normalize(called);
+        return transitiveCallees[function] = std::move(called);
+    }
+
+    bool callsTransitively(uint32_t caller, uint32_t callee) {
+        const NodeSet &called = callees(caller);
+        return binary_search(called.begin(), called.end(), callee);
+    }
+
+    // The call sites in srcFn through which dstFn is (transitively) called
+    NodeSet getTransitiveCallSites(uint32_t srcFn, uint32_t dstFn) {
+        NodeSet sites;
+        GraphSnapshot::Range calls = graph.outEdges(srcFn, RexEdge::CALLS);
+        for (uint32_t edge = calls.first; edge < calls.last; edge++) {
+            uint32_t callee = graph.edgeDestination(edge);
+            if (callee == dstFn || callsTransitively(callee, dstFn)) {
+                NodeSet blocks = cfgBlocks(edge);
+                sites.insert(sites.end(), blocks.begin(), blocks.end());
+            }
+        }
+        normalize(sites);
+        // Only call sites that can actually be reached from the entry
+        return intersect(sites, reachable(targets(srcFn, RexEdge::FUNCTION_CFG_LINK), false));
+    }
+
+    // Whether there is a block in each step such that every block is reachable
+    // from the one in the step before it
+    bool runQuery(const vector<NodeSet> &steps) {
+        queriesRun++;
+        NodeSet current = steps[0];
+        for (size_t step = 1; step < steps.size() && !current.empty(); step++) {
+            current = intersect(reachable(current, true), steps[step]);
+        }
+        return !current.empty();
+    }
+
+    bool workOnNextItem(const Stack &stack, const vector<vector<NodeSet>> &queries, size_t next) {
+        uint32_t nextRel = (*path)[next];
+
+        // Grouped by function, in the order the functions are first seen
+        vector<pair<uint32_t, NodeSet>> groupByFunc;
+        for (uint32_t cfg : cfgBlocks(nextRel)) {
+            uint32_t function = graph.enclosingFunction(cfg);
+            if (function == GraphSnapshot::NO_NODE) {
+                continue;
+            }
+            auto group = find_if(groupByFunc.begin(), groupByFunc.end(), [function](const pair<uint32_t, NodeSet> &g) {
+                return g.first == function;
+            });
+            if (group == groupByFunc.end()) {
+                groupByFunc.emplace_back(function, NodeSet{});
+                group = groupByFunc.end() - 1;
+            }
+            group->second.push_back(cfg);
+        }
+
+        for (auto &group : groupByFunc) {
+            Stack stackCopy = stack;
+            vector<vector<NodeSet>> queriesCopy = queries;
+            if (doWork(stackCopy, queriesCopy, group.first, group.second, next)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool doWork(Stack &stack, vector<vector<NodeSet>> &queries, uint32_t fnID, const NodeSet &CFGs, size_t current) {
+        if (!stack.empty()) {
+            // Find the closest common ancestor
+            while (!stack.empty()) {
+                if (stack.back().function == fnID || callsTransitively(stack.back().function, fnID)) {
+                    break;
+                }
+                if (!stack.back().empty()) {
+                    queries.push_back(stack.back().steps);
+                }
+                stack.pop_back();
+            }
+
+            if (stack.empty()) {
+                // No ancestor, the path is disjoint
+                return false;
+            }
+
+            if (stack.back().function == fnID) {
+                stack.back().steps.push_back(CFGs);
+                if (stack.size() == 1) {
+                    // The stack has been popped all the way to the first function
+                    returnedToFirstFunc = true;
+                }
+            } else {
+                // Called transitively, continue from the call sites
+                stack.back().steps.push_back(getTransitiveCallSites(stack.back().function, fnID));
+            }
+        }
+
+        stack.emplace_back(fnID, CFGs);
+
+        if (current + 1 < path->size()) {
+            return workOnNextItem(stack, queries, current + 1);
+        }
+
+        if (firstRelationshipIsCall && !returnedToFirstFunc) {
+            // This path has a call* prefix that is not essential for the behavior alteration path
+            return false;
+        }
+
+        while (!stack.empty()) {
+            if (!stack.back().empty()) {
+                queries.push_back(stack.back().steps);
+            }
+            stack.pop_back();
+        }
+
+        if (queries.empty()) {
+            throw logic_error("Behaviour alteration path did not produce any CFG queries");
+        }
+
+        for (const vector<NodeSet> &steps : queries) {
+            if (!runQuery(steps)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool visitPath(const vector<uint32_t> &edges) {
+        path = &edges;
+        // These eliminate paths with useless call* prefixes. A data flow is a
+        // sequence of write, varWrite, varInfFunc, and any calls before it are
+        // not part of it unless control returns to the first function later on
+        // (e.g. the final varInfFunc is in that function).
+        firstRelationshipIsCall = graph.edgeType(edges[0]) == RexEdge::CALLS;
+        returnedToFirstFunc = false;
+        return workOnNextItem(Stack{}, vector<vector<NodeSet>>{}, 0);
+    }
+
+    // Check the final varInfFunc edges out of the end of the current path
+    void checkEnds(vector<uint32_t> &edges, uint32_t node, vector<vector<uint32_t>> &valid) {
+        GraphSnapshot::Range ends = graph.outEdges(node, RexEdge::VAR_INFLUENCE_FUNC);
+        for (uint32_t edge = ends.first; edge < ends.last; edge++) {
+            edges.push_back(edge);
+            if (visitPath(edges)) {
+                valid.push_back(edges);
+            }
+            edges.pop_back();
+        }
+    }
+
+  public:
+    explicit PathChecker(const PathQuery &query) :
+        query{query}, graph{query.getGraph()}, queriesRun{0}, used(graph.numEdges(), false), path{nullptr},
+        firstRelationshipIsCall{false}, returnedToFirstFunc{false} {}
+
+    unsigned long getQueriesRun() const {
+        return queriesRun;
+    }
+
+    // Find every valid path starting at the given function
+    //
+    // Walks the candidate paths depth first with an explicit stack, since
+    // they can get far longer than the call stack would allow.
+    void findPaths(uint32_t source, unsigned int maxLength, vector<vector<uint32_t>> &valid) {
+        struct Step {
+            uint32_t node;
+            unsigned int type;
+            GraphSnapshot::Range remaining;
+        };
+        vector<Step> steps{Step{source, 0, graph.outEdges(source, FLOW_TYPES[0])}};
+        vector<uint32_t> edges;
+
+        while (!steps.empty()) {
+            Step &top = steps.back();
+            if (top.remaining.empty()) {
+                if (++top.type < NUM_FLOW_TYPES) {
+                    top.remaining = graph.outEdges(top.node, FLOW_TYPES[top.type]);
+                    continue;
+                }
+                steps.pop_back();
+                if (!edges.empty()) {
+                    used[edges.back()] = false;
+                    edges.pop_back();
+                }
+                continue;
+            }
+
+            uint32_t edge = top.remaining.first++;
+            if (used[edge] || (maxLength != 0 && edges.size() == maxLength)) {
+                continue;
+            }
+            used[edge] = true;
+            edges.push_back(edge);
+
+            uint32_t node = graph.edgeDestination(edge);
+            checkEnds(edges, node, valid);
+            steps.push_back(Step{node, 0, graph.outEdges(node, FLOW_TYPES[0])});
+        }
+    }
+};
+
+}
+
+PathQuery::PathQuery(const GraphSnapshot &graph) : graph{graph}, intraprocedural(graph.numEdges(), false) {
+    // Calls and returns are nextCFGBlock edges too, but they leave the function
+    for (uint32_t node = 0; node < graph.numNodes(); node++) {
+        GraphSnapshot::Range next = graph.outEdges(node, RexEdge::NEXT_CFG_BLOCK);
+        for (uint32_t edge = next.first; edge < next.last; edge++) {
+            intraprocedural[edge] = graph.edgeAttribute(edge, RexAttribute::CFG_INVOKE).empty() &&
+                                    graph.edgeAttribute(edge, RexAttribute::CFG_RETURN).empty();
+        }
+    }
+}
+
+const GraphSnapshot &PathQuery::getGraph() const {
+    return graph;
+}
+
+bool PathQuery::isIntraprocedural(uint32_t edge) const {
+    return intraprocedural[edge];
+}
+
+// Quote a CSV field if it needs it (IDs contain commas in parameter lists)
+static string csvField(const string &field) {
+    if (field.find_first_of(",\"\r\n") == string::npos) {
+        return field;
+    }
+    string quoted = "\"";
+    for (char c : field) {
+        if (c == '"') {
+            quoted += '"';
+        }
+        quoted += c;
+    }
+    return quoted + '"';
+}
+
+unsigned long PathQuery::run(const Options &options, ostream &out, ostream &csv) const {
+    vector<uint32_t> sources(graph.nodesBegin(RexNode::FUNCTION), graph.nodesEnd(RexNode::FUNCTION));
+    // Valid paths of each source, so the output doesn't depend on which
+    // worker finished first
+    vector<vector<vector<uint32_t>>> valid(sources.size());
+
+    atomic<size_t> nextSource{0};
+    atomic<unsigned long> totalQueriesRun{0};
+    vector<thread> workers;
+    for (unsigned int i = 0; i < max(options.jobs, 1u); i++) {
+        workers.emplace_back([this, &options, &sources, &valid, &nextSource, &totalQueriesRun]() {
+            PathChecker checker(*this);
+            size_t source;
+            while ((source = nextSource++) < sources.size()) {
+                checker.findPaths(sources[source], options.maxLength, valid[source]);
+            }
+            totalQueriesRun += checker.getQueriesRun();
+        });
+    }
+    for (thread &worker : workers) {
+        worker.join();
+    }
+
+    unsigned long numValid = 0;
+    for (auto &paths : valid) {
+        numValid += paths.size();
+    }
+    out << "TOTAL QUERIES RUN: " << totalQueriesRun << endl;
+    out << "NUM VALID: " << numValid << endl;
+    for (auto &paths : valid) {
+        for (auto &path : paths) {
+            out << graph.nodeID(graph.edgeSource(path[0]));
+            csv << csvField(graph.nodeID(graph.edgeSource(path[0])));
+            for (uint32_t edge : path) {
+                const char *type = RexEdge::typeToString(graph.edgeType(edge));
+                out << " --" << type << "--> " << graph.nodeID(graph.edgeDestination(edge));
+                csv << ',' << type << ',' << csvField(graph.nodeID(graph.edgeDestination(edge)));
+            }
+            out << endl << endl;
+            csv << "\r\n";
+        }
+    }
+    return numValid;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint> // uint32_t
+#include <ostream> // ostream
+#include <vector> // vector
+
+#include "../Linker/GraphSnapshot.h"
+
+// Finds behaviour alteration paths in a linked graph and keeps the ones whose
+// facts can actually happen in that order at runtime. This is the analysis
+// from stack_based.py, run directly on a graph snapshot instead of through
+// thousands of Neo4j queries.
+//
+// A candidate path is a cFunction followed by one or more call, write and
+// varWrite edges and ending in a varInfFunc edge (no edge is used twice). Each
+// fact on the path is placed in the CFG blocks it happens in, and a stack of
+// the functions the path goes through is kept, so that consecutive facts are
+// only accepted if their blocks are reachable from each other in the order of
+// the path, entering callees through their call sites.
+//
+// The CFG blocks of a fact come from the edges the walker adds for it:
+//   write f x        blocks with both f -writeSource-> and x -writeDestination->
+//   varWrite a b     blocks with both a -varWriteSource-> and b -varWriteDestination->
+//   call f g         f -callSource-> blocks that invoke a g -callDestination-> block
+//   varInfFunc v f   v -varInfFuncSource-> blocks in a function that also has
+//                    an f -varInfFuncDestination-> block
+// The function a block belongs to is looked up in the snapshot, and blocks
+// are reachable from each other through nextCFGBlock edges that are not calls
+// or returns.
+class PathQuery {
+  public:
+    struct Options {
+        // Worker threads, each checking the paths of one source function at a time
+        unsigned int jobs = 1;
+        // Longest candidate path to consider, not counting the final
+        // varInfFunc edge. 0 means no limit.
+        unsigned int maxLength = 0;
+    };
+
+  private:
+    const GraphSnapshot &graph;
+    // Whether each edge is a nextCFGBlock edge within a single function
+    std::vector<bool> intraprocedural;
+
+  public:
+    explicit PathQuery(const GraphSnapshot &graph);
+
+    const GraphSnapshot &getGraph() const;
+    bool isIntraprocedural(uint32_t edge) const;
+
+    // Check every candidate path. Valid paths are printed like stack_based.py
+    // does and written to csv, one row per path: the ID of its first node
+    // followed by the type and destination of each edge.
+    //
+    // Returns the number of valid paths.
+    unsigned long run(const Options &options, std::ostream &out, std::ostream &csv) const;
+};
@@ -0,0 +1,234 @@
+#include "Relation.h"
+
+#include <algorithm> // lower_bound, reverse, set_union, set_difference, set_intersection, sort, unique
+#include <iterator> // back_inserter
+#include <queue> // queue
+#include <unordered_map> // unordered_map
+#include <thread> // thread
+
+using namespace std;
+
+template<class T>
+static void normalize(vector<T> &items) {
+    sort(items.begin(), items.end());
+    items.erase(unique(items.begin(), items.end()), items.end());
+}
+
+ElementSet unite(const ElementSet &left, const ElementSet &right) {
+    ElementSet result;
+    set_union(left.begin(), left.end(), right.begin(), right.end(), back_inserter(result));
+    return result;
+}
+
+ElementSet subtract(const ElementSet &left, const ElementSet &right) {
+    ElementSet result;
+    set_difference(left.begin(), left.end(), right.begin(), right.end(), back_inserter(result));
+    return result;
+}
+
+ElementSet intersect(const ElementSet &left, const ElementSet &right) {
+    ElementSet result;
+    set_intersection(left.begin(), left.end(), right.begin(), right.end(), back_inserter(result));
+    return result;
+}
+
+Relation Relation::fromSorted(vector<Pair> pairs) {
+    Relation relation;
+    relation.pairs = move(pairs);
+    return relation;
+}
+
+Relation::Relation(vector<Pair> pairs) : pairs{move(pairs)} {
+    normalize(this->pairs);
+}
+
+Relation Relation::identity(const ElementSet &elements) {
+    vector<Pair> pairs;
+    pairs.reserve(elements.size());
+    for (uint32_t element : elements) {
+        pairs.emplace_back(element, element);
+    }
+    return fromSorted(move(pairs));
+}
+
+const vector<Relation::Pair> &Relation::getPairs() const {
+    return pairs;
+}
+
+size_t Relation::size() const {
+    return pairs.size();
+}
+
+bool Relation::empty() const {
+    return pairs.empty();
+}
+
+Relation Relation::inverse() const {
+    vector<Pair> inverted;
+    inverted.reserve(pairs.size());
+    for (const Pair &pair : pairs) {
+        inverted.emplace_back(pair.second, pair.first);
+    }
+    sort(inverted.begin(), inverted.end());
+    return fromSorted(move(inverted));
+}
+
+ElementSet Relation::domain() const {
+    ElementSet elements;
+    for (const Pair &pair : pairs) {
+        // Already sorted, so duplicates are always next to each other
+        if (elements.empty() || elements.back() != pair.first) {
+            elements.push_back(pair.first);
+        }
+    }
+    return elements;
+}
+
+ElementSet Relation::range() const {
+    ElementSet elements;
+    elements.reserve(pairs.size());
+    for (const Pair &pair : pairs) {
+        elements.push_back(pair.second);
+    }
+    normalize(elements);
+    return elements;
+}
+
+ElementSet Relation::image(const ElementSet &elements) const {
+    ElementSet result;
+    for (uint32_t element : elements) {
+        auto it = lower_bound(pairs.begin(), pairs.end(), Pair{element, 0});
+        for (; it != pairs.end() && it->first == element; ++it) {
+            result.push_back(it->second);
+        }
+    }
+    normalize(result);
+    return result;
+}
+
+ElementSet Relation::preimage(const ElementSet &elements) const {
+    ElementSet result;
+    for (const Pair &pair : pairs) {
+        if (binary_search(elements.begin(), elements.end(), pair.second)) {
+            result.push_back(pair.first);
+        }
+    }
+    // The sources are already sorted, only duplicates need to go
+    result.erase(unique(result.begin(), result.end()), result.end());
+    return result;
+}
+
+Relation Relation::unite(const Relation &other) const {
+    vector<Pair> result;
+    set_union(pairs.begin(), pairs.end(), other.pairs.begin(), other.pairs.end(), back_inserter(result));
+    return fromSorted(move(result));
+}
+
+Relation Relation::subtract(const Relation &other) const {
+    vector<Pair> result;
+    set_difference(pairs.begin(), pairs.end(), other.pairs.begin(), other.pairs.end(), back_inserter(result));
+    return fromSorted(move(result));
+}
+
+Relation Relation::intersect(const Relation &other) const {
+    vector<Pair> result;
+    set_intersection(pairs.begin(), pairs.end(), other.pairs.begin(), other.pairs.end(), back_inserter(result));
+    return fromSorted(move(result));
+}
+
+Relation Relation::compose(const Relation &other, unsigned int jobs) const {
+    // Split the pairs into one chunk per thread, only ever between two sources.
+    // Each chunk then produces pairs with sources no other chunk has, so the
+    // chunks can simply be appended in order.
+    vector<size_t> bounds{0};
+    for (unsigned int job = 1; job < jobs; job++) {
+        size_t bound = max(pairs.size() * job / jobs, bounds.back());
+        while (bound > 0 && bound < pairs.size() && pairs[bound].first == pairs[bound - 1].first) {
+            bound++;
+        }
+        if (bound > bounds.back() && bound < pairs.size()) {
+            bounds.push_back(bound);
+        }
+    }
+    bounds.push_back(pairs.size());
+
+    vector<vector<Pair>> chunks(bounds.size() - 1);
+    auto composeChunk = [&](size_t chunk) {
+        vector<Pair> &result = chunks[chunk];
+        ElementSet targets;
+        size_t first = bounds[chunk];
+        while (first < bounds[chunk + 1]) {
+            uint32_t source = pairs[first].first;
+            targets.clear();
+            for (; first < bounds[chunk + 1] && pairs[first].first == source; first++) {
+                uint32_t middle = pairs[first].second;
+                auto it = lower_bound(other.pairs.begin(), other.pairs.end(), Pair{middle, 0});
+                for (; it != other.pairs.end() && it->first == middle; ++it) {
+                    targets.push_back(it->second);
+                }
+            }
+            normalize(targets);
+            for (uint32_t target : targets) {
+                result.emplace_back(source, target);
+            }
+        }
+    };
+
+    if (chunks.size() <= 1) {
+        if (!chunks.empty()) {
+            composeChunk(0);
+        }
+    } else {
+        vector<thread> threads;
+        for (size_t chunk = 0; chunk < chunks.size(); chunk++) {
+            threads.emplace_back(composeChunk, chunk);
+        }
+        for (thread &thread : threads) {
+            thread.join();
+        }
+    }
+
+    vector<Pair> result;
+    for (vector<Pair> &chunk : chunks) {
+        result.insert(result.end(), chunk.begin(), chunk.end());
+    }
+    return fromSorted(move(result));
+}
+
+Relation Relation::closure(unsigned int jobs) const {
+    Relation total = *this;
+    Relation delta = *this;
+    while (!delta.empty()) {
+        // Only pairs found in the last round can lead to pairs not found yet
+        delta = delta.compose(*this, jobs).subtract(total);
+        total = total.unite(delta);
+    }
+    return total;
+}
+
+vector<uint32_t> Relation::shortestPath(uint32_t from, uint32_t to) const {
+    // Breadth first search, remembering the element each one was reached from
+    unordered_map<uint32_t, uint32_t> previous;
+    queue<uint32_t> pending;
+    pending.push(from);
+    while (!pending.empty() && !previous.count(to)) {
+        uint32_t element = pending.front();
+        pending.pop();
+        auto it = lower_bound(pairs.begin(), pairs.end(), Pair{element, 0});
+        for (; it != pairs.end() && it->first == element; ++it) {
+            if (previous.emplace(it->second, element).second) {
+                pending.push(it->second);
+            }
+        }
+    }
+    if (!previous.count(to)) {
+        return {};
+    }
+
+    vector<uint32_t> path{to};
+    do {
+        path.push_back(previous[path.back()]);
+    } while (path.back() != from);
+    reverse(path.begin(), path.end());
+    return path;
+}
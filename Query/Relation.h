@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef> // size_t
+#include <cstdint> // uint32_t
+#include <utility> // pair
+#include <vector> // vector
+
+// Sorted, distinct elements (string numbers of a snapshot)
+typedef std::vector<uint32_t> ElementSet;
+
+ElementSet unite(const ElementSet &left, const ElementSet &right);
+ElementSet subtract(const ElementSet &left, const ElementSet &right);
+ElementSet intersect(const ElementSet &left, const ElementSet &right);
+
+// A binary relation, stored as sorted, distinct pairs so that every operation
+// is a merge or a run of binary searches.
+//
+// The operations that can take long on a large graph (composition and
+// transitive closure) split their work between the given number of threads.
+class Relation {
+  public:
+    typedef std::pair<uint32_t, uint32_t> Pair;
+
+  private:
+    std::vector<Pair> pairs;
+
+    // The pairs must already be sorted and distinct
+    static Relation fromSorted(std::vector<Pair> pairs);
+
+  public:
+    Relation() = default;
+    // Sorts the pairs and drops any duplicates
+    explicit Relation(std::vector<Pair> pairs);
+    // Every element related to itself
+    static Relation identity(const ElementSet &elements);
+
+    const std::vector<Pair> &getPairs() const;
+    size_t size() const;
+    bool empty() const;
+
+    Relation inverse() const;
+    ElementSet domain() const;
+    ElementSet range() const;
+    // Everything related to an element of the set (grok's `set . rel`)
+    ElementSet image(const ElementSet &elements) const;
+    // Everything related to an element of the set (grok's `rel . set`)
+    ElementSet preimage(const ElementSet &elements) const;
+
+    Relation unite(const Relation &other) const;
+    Relation subtract(const Relation &other) const;
+    Relation intersect(const Relation &other) const;
+
+    // (a, c) for every (a, b) in this relation and (b, c) in the other one
+    Relation compose(const Relation &other, unsigned int jobs) const;
+    // Every pair connected by one or more steps of this relation, computed
+    // semi-naively: each round only extends the pairs found in the round before
+    Relation closure(unsigned int jobs) const;
+
+    // The elements on a shortest path of one or more steps between two
+    // elements, both ends included. Empty if there is no such path.
+    std::vector<uint32_t> shortestPath(uint32_t from, uint32_t to) const;
+};
@@ -0,0 +1,694 @@
+#include "RelationScript.h"
+
+#include <algorithm> // find, min, sort, unique
+#include <cctype> // isalpha, isalnum, isdigit, isspace
+#include <iterator> // istreambuf_iterator
+#include <regex> // regex, regex_search
+#include <stdexcept> // runtime_error, domain_error
+
+using namespace std;
+
+class RelationScript::Parser {
+    // Thrown by quit; to leave any loops and blocks it's in
+    struct Quit {};
+
+    struct Token {
+        enum Kind { NAME, ATTRIBUTE, STRING, NUMBER, SYMBOL, END };
+
+        Kind kind;
+        string text;
+        unsigned int line;
+    };
+
+    RelationScript &script;
+    vector<Token> tokens;
+    size_t position;
+
+    [[noreturn]] void fail(const string &message) const {
+        throw runtime_error("line " + to_string(tokens[position].line) + ": " + message);
+    }
+
+    void tokenize(const string &text) {
+        unsigned int line = 1;
+        size_t i = 0;
+        while (i < text.size()) {
+            char c = text[i];
+            if (c == '\n') {
+                line++;
+                i++;
+            } else if (isspace(static_cast<unsigned char>(c))) {
+                i++;
+            } else if (c == '/' && i + 1 < text.size() && text[i + 1] == '/') {
+                while (i < text.size() && text[i] != '\n') {
+                    i++;
+                }
+            } else if (isalpha(static_cast<unsigned char>(c)) || c == '_' || c == '$' || c == '@') {
+                size_t first = c == '@' ? i + 1 : i;
+                i++;
+                while (i < text.size() && (isalnum(static_cast<unsigned char>(text[i])) || text[i] == '_')) {
+                    i++;
+                }
+                tokens.push_back({c == '@' ? Token::ATTRIBUTE : Token::NAME, text.substr(first, i - first), line});
+            } else if (c == '"') {
+                string value;
+                unsigned int startLine = line;
+                for (i++; i < text.size() && text[i] != '"'; i++) {
+                    if (text[i] == '\\' && i + 1 < text.size()) {
+                        i++;
+                        if (text[i] == 't' || text[i] == 'n') {
+                            value += text[i] == 't' ? '\t' : '\n';
+                            continue;
+                        }
+                    }
+                    if (text[i] == '\n') {
+                        line++;
+                    }
+                    value += text[i];
+                }
+                if (i == text.size()) {
+                    throw runtime_error("line " + to_string(startLine) + ": unterminated string");
+                }
+                i++;
+                tokens.push_back({Token::STRING, value, startLine});
+            } else if (isdigit(static_cast<unsigned char>(c))) {
+                size_t first = i;
+                while (i < text.size() && isdigit(static_cast<unsigned char>(text[i]))) {
+                    i++;
+                }
+                tokens.push_back({Token::NUMBER, text.substr(first, i - first), line});
+            } else if (string("=!<>").find(c) != string::npos && i + 1 < text.size() && text[i + 1] == '=') {
+                tokens.push_back({Token::SYMBOL, text.substr(i, 2), line});
+                i += 2;
+            } else if (string("=;(){},+-^.#<>").find(c) != string::npos) {
+                tokens.push_back({Token::SYMBOL, string(1, c), line});
+                i++;
+            } else {
+                throw runtime_error("line " + to_string(line) + ": unexpected character '" + string(1, c) + "'");
+            }
+        }
+        tokens.push_back({Token::END, "", line});
+    }
+
+    const Token &peek(size_t ahead = 0) const {
+        return tokens[min(position + ahead, tokens.size() - 1)];
+    }
+
+    bool isSymbol(const Token &token, char symbol) const {
+        return token.kind == Token::SYMBOL && token.text.size() == 1 && token.text[0] == symbol;
+    }
+
+    bool isKeyword(const Token &token, const char *keyword) const {
+        return token.kind == Token::NAME && token.text == keyword;
+    }
+
+    void expect(char symbol) {
+        if (!isSymbol(peek(), symbol)) {
+            fail(string("expected '") + symbol + "'");
+        }
+        position++;
+    }
+
+    // Whether the token can be the start of an operand. Tells the postfix `+`
+    // of a transitive closure apart from a union or the `+` joining the text
+    // of a print.
+    bool startsOperand(const Token &token) const {
+        return (token.kind == Token::NAME && token.text != "o" && token.text != "X") ||
+               token.kind == Token::ATTRIBUTE || token.kind == Token::STRING || token.kind == Token::NUMBER ||
+               isSymbol(token, '(') || isSymbol(token, '{') || isSymbol(token, '#');
+    }
+
+    Relation toRelation(const Value &value) const {
+        switch (value.kind) {
+        case Value::SET:
+            return Relation::identity(value.set);
+        case Value::RELATION:
+            return value.relation;
+        default:
+            fail("expected a set or a relation, not a number");
+        }
+    }
+
+    const Relation &expectRelation(const Value &value, const char *op) const {
+        if (value.kind != Value::RELATION) {
+            fail(string("'") + op + "' needs a relation");
+        }
+        return value.relation;
+    }
+
+    static Value setValue(ElementSet set) {
+        Value value{Value::SET, move(set), {}, 0};
+        return value;
+    }
+
+    static Value relationValue(Relation relation) {
+        Value value{Value::RELATION, {}, move(relation), 0};
+        return value;
+    }
+
+    static Value numberValue(size_t number) {
+        Value value{Value::NUMBER, {}, {}, number};
+        return value;
+    }
+
+    Value parsePrimary() {
+        const Token &token = peek();
+        if (token.kind == Token::ATTRIBUTE) {
+            const Relation *attribute = script.attributeRelation(token.text);
+            if (!attribute) {
+                fail("unknown attribute '@" + token.text + "'");
+            }
+            position++;
+            return relationValue(*attribute);
+        } else if (isKeyword(token, "grep") && isSymbol(peek(1), '(')) {
+            position += 2;
+            Value value = parseExpression();
+            if (value.kind != Value::SET) {
+                fail("'grep' needs a set");
+            }
+            expect(',');
+            if (peek().kind != Token::STRING) {
+                fail("expected a regular expression");
+            }
+            regex pattern;
+            try {
+                pattern = regex(peek().text);
+            } catch (regex_error &e) {
+                fail("invalid regular expression '" + peek().text + "': " + e.what());
+            }
+            position++;
+            expect(')');
+            ElementSet matches;
+            for (uint32_t element : value.set) {
+                if (regex_search(script.elementName(element), pattern)) {
+                    matches.push_back(element);
+                }
+            }
+            return setValue(move(matches));
+        } else if (token.kind == Token::NAME) {
+            if (token.text == "$INSTANCE") {
+                position++;
+                return relationValue(script.instances());
+            }
+            auto variable = script.variables.find(token.text);
+            if (variable != script.variables.end()) {
+                position++;
+                return variable->second;
+            }
+            const Relation *edges = script.edgeRelation(token.text);
+            if (!edges) {
+                fail("unknown variable or relation '" + token.text + "'");
+            }
+            position++;
+            return relationValue(*edges);
+        } else if (token.kind == Token::NUMBER) {
+            position++;
+            return numberValue(stoul(token.text));
+        } else if (isSymbol(token, '(')) {
+            position++;
+            Value value = parseExpression();
+            expect(')');
+            return value;
+        } else if (isSymbol(token, '{')) {
+            position++;
+            ElementSet elements;
+            if (!isSymbol(peek(), '}')) {
+                while (true) {
+                    if (peek().kind == Token::STRING) {
+                        elements.push_back(script.element(peek().text));
+                    } else if (peek().kind == Token::NAME && script.variables.count(peek().text) &&
+                               script.variables[peek().text].kind == Value::SET) {
+                        // The variable of a loop, like {item}
+                        const ElementSet &set = script.variables[peek().text].set;
+                        elements.insert(elements.end(), set.begin(), set.end());
+                    } else {
+                        fail("expected a string or a set variable");
+                    }
+                    position++;
+                    if (!isSymbol(peek(), ',')) {
+                        break;
+                    }
+                    position++;
+                }
+            }
+            expect('}');
+            sort(elements.begin(), elements.end());
+            elements.erase(unique(elements.begin(), elements.end()), elements.end());
+            return setValue(move(elements));
+        }
+        fail(token.kind == Token::END ? "unexpected end of script" : "unexpected '" + token.text + "'");
+    }
+
+    Value parsePostfix() {
+        Value value = parsePrimary();
+        while (isSymbol(peek(), '+') && !startsOperand(peek(1))) {
+            position++;
+            value = relationValue(expectRelation(value, "+").closure(script.jobs));
+        }
+        return value;
+    }
+
+    Value parseUnary() {
+        const Token &token = peek();
+        if (isKeyword(token, "inv")) {
+            position++;
+            return relationValue(expectRelation(parseUnary(), "inv").inverse());
+        } else if (isKeyword(token, "dom")) {
+            position++;
+            return setValue(expectRelation(parseUnary(), "dom").domain());
+        } else if (isKeyword(token, "rng")) {
+            position++;
+            return setValue(expectRelation(parseUnary(), "rng").range());
+        } else if (isKeyword(token, "id")) {
+            position++;
+            Value value = parseUnary();
+            if (value.kind != Value::SET) {
+                fail("'id' needs a set");
+            }
+            return relationValue(Relation::identity(value.set));
+        } else if (isSymbol(token, '#')) {
+            position++;
+            Value value = parseUnary();
+            return numberValue(value.kind == Value::SET ? value.set.size()
+                               : value.kind == Value::RELATION ? value.relation.size() : value.number);
+        }
+        return parsePostfix();
+    }
+
+    Value parseComposition() {
+        Value left = parseUnary();
+        while (isKeyword(peek(), "o") || isKeyword(peek(), "X") || isSymbol(peek(), '.')) {
+            bool dot = isSymbol(peek(), '.');
+            bool cross = isKeyword(peek(), "X");
+            position++;
+            Value right = parseUnary();
+            if (cross) {
+                if (left.kind != Value::SET || right.kind != Value::SET) {
+                    fail("'X' needs two sets");
+                }
+                vector<Relation::Pair> pairs;
+                pairs.reserve(left.set.size() * right.set.size());
+                for (uint32_t first : left.set) {
+                    for (uint32_t second : right.set) {
+                        pairs.emplace_back(first, second);
+                    }
+                }
+                left = relationValue(Relation(move(pairs)));
+            } else if (dot && left.kind == Value::SET && right.kind == Value::RELATION) {
+                left = setValue(right.relation.image(left.set));
+            } else if (dot && left.kind == Value::RELATION && right.kind == Value::SET) {
+                left = setValue(left.relation.preimage(right.set));
+            } else if (dot && (left.kind != Value::RELATION || right.kind != Value::RELATION)) {
+                fail("'.' needs a relation on at least one side");
+            } else {
+                left = relationValue(toRelation(left).compose(toRelation(right), script.jobs));
+            }
+        }
+        return left;
+    }
+
+    // Applies a set operation to two sets or two relations
+    template<class SetOp, class RelationOp>
+    Value combine(const Value &left, const Value &right, char op, SetOp setOp, RelationOp relationOp) const {
+        if (left.kind == Value::SET && right.kind == Value::SET) {
+            return setValue(setOp(left.set, right.set));
+        } else if (left.kind == Value::RELATION && right.kind == Value::RELATION) {
+            return relationValue(relationOp(left.relation, right.relation));
+        }
+        fail(string("'") + op + "' needs two sets or two relations");
+    }
+
+    Value parseIntersection() {
+        Value left = parseComposition();
+        while (isSymbol(peek(), '^')) {
+            position++;
+            Value right = parseComposition();
+            left = combine(left, right, '^', intersect,
+                           [](const Relation &l, const Relation &r) { return l.intersect(r); });
+        }
+        return left;
+    }
+
+    Value parseExpression() {
+        Value left = parseIntersection();
+        while (isSymbol(peek(), '+') || isSymbol(peek(), '-')) {
+            char op = peek().text[0];
+            position++;
+            Value right = parseIntersection();
+            if (op == '+') {
+                left = combine(left, right, op, unite,
+                               [](const Relation &l, const Relation &r) { return l.unite(r); });
+            } else {
+                left = combine(left, right, op, subtract,
+                               [](const Relation &l, const Relation &r) { return l.subtract(r); });
+            }
+        }
+        return left;
+    }
+
+    // How a value reads inside the text of a print statement
+    string text(const Value &value) const {
+        switch (value.kind) {
+        case Value::SET: {
+            string names;
+            for (uint32_t element : value.set) {
+                names += (names.empty() ? "" : " ") + script.elementName(element);
+            }
+            return names;
+        }
+        case Value::NUMBER:
+            return to_string(value.number);
+        default:
+            fail("a relation can't be part of a text");
+        }
+    }
+
+    // Whether the rest of the statement has a string literal outside of any
+    // braces or parentheses, which makes the `+` of a print join text
+    bool textAhead() const {
+        int depth = 0;
+        for (size_t i = position; i < tokens.size() && !(depth == 0 && isSymbol(tokens[i], ';')); i++) {
+            if (isSymbol(tokens[i], '(') || isSymbol(tokens[i], '{')) {
+                depth++;
+            } else if (isSymbol(tokens[i], ')') || isSymbol(tokens[i], '}')) {
+                depth--;
+            } else if (depth == 0 && tokens[i].kind == Token::STRING) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void print(const Value &value, ostream &out) const {
+        switch (value.kind) {
+        case Value::SET:
+            for (uint32_t element : value.set) {
+                out << script.elementName(element) << "\n";
+            }
+            break;
+        case Value::RELATION:
+            for (const Relation::Pair &pair : value.relation.getPairs()) {
+                out << script.elementName(pair.first) << " " << script.elementName(pair.second) << "\n";
+            }
+            break;
+        case Value::NUMBER:
+            out << value.number << "\n";
+            break;
+        }
+    }
+
+  public:
+    Parser(RelationScript &script, const string &text) : script{script}, position{0} {
+        tokenize(text);
+    }
+
+    ElementSet expectSet(const Value &value, const char *op) const {
+        if (value.kind != Value::SET) {
+            fail(string("'") + op + "' needs a set");
+        }
+        return value.set;
+    }
+
+    // Skips the statements of a block whose opening brace was just read
+    void skipBlock() {
+        for (unsigned int depth = 1; depth > 0; position++) {
+            if (peek().kind == Token::END) {
+                fail("expected '}'");
+            }
+            if (isSymbol(peek(), '{')) {
+                depth++;
+            } else if (isSymbol(peek(), '}')) {
+                depth--;
+            }
+        }
+    }
+
+    // Runs the statements of a block whose opening brace was just read
+    void runBlock(ostream &out) {
+        while (!isSymbol(peek(), '}')) {
+            runStatement(out);
+        }
+        position++;
+    }
+
+    // A comparison of two numbers, like `#set > 0`, which can be in
+    // parentheses as grok allows
+    bool parseCondition() {
+        bool parenthesized = false;
+        if (isSymbol(peek(), '(')) {
+            size_t close = position + 1;
+            for (int depth = 1; close < tokens.size() - 1; close++) {
+                depth += isSymbol(tokens[close], '(') ? 1 : isSymbol(tokens[close], ')') ? -1 : 0;
+                if (depth == 0) {
+                    break;
+                }
+            }
+            parenthesized = isSymbol(peek(close + 1 - position), '{');
+            position += parenthesized;
+        }
+        Value left = parseExpression();
+        static const vector<string> comparisons{"==", "!=", "<", "<=", ">", ">="};
+        string comparison = peek().text;
+        if (peek().kind != Token::SYMBOL ||
+            find(comparisons.begin(), comparisons.end(), comparison) == comparisons.end()) {
+            fail("expected a comparison");
+        }
+        position++;
+        Value right = parseExpression();
+        if (parenthesized) {
+            expect(')');
+        }
+        if (left.kind != Value::NUMBER || right.kind != Value::NUMBER) {
+            fail("'" + comparison + "' needs two numbers");
+        }
+        size_t l = left.number, r = right.number;
+        return comparison == "==" ? l == r : comparison == "!=" ? l != r : comparison == "<" ? l < r
+               : comparison == "<=" ? l <= r : comparison == ">" ? l > r : l >= r;
+    }
+
+    // if comparison { statements } else { statements }
+    void runIf(ostream &out) {
+        position++;
+        bool condition = parseCondition();
+        expect('{');
+        if (condition) {
+            runBlock(out);
+        } else {
+            skipBlock();
+        }
+        if (isKeyword(peek(), "else")) {
+            position++;
+            expect('{');
+            if (condition) {
+                skipBlock();
+            } else {
+                runBlock(out);
+            }
+        }
+    }
+
+    // for name in set { statements }
+    void runLoop(ostream &out) {
+        position++;
+        if (peek().kind != Token::NAME || !isKeyword(peek(1), "in")) {
+            fail("expected 'for name in set {'");
+        }
+        string name = peek().text;
+        position += 2;
+        ElementSet elements = expectSet(parseExpression(), "for");
+        expect('{');
+        size_t body = position;
+        if (elements.empty()) {
+            skipBlock();
+            return;
+        }
+        // Each element runs the statements of the body again, with the
+        // variable holding just that element
+        for (uint32_t element : elements) {
+            script.variables[name] = setValue({element});
+            position = body;
+            runBlock(out);
+        }
+    }
+
+    // showpath(from, to, relation); prints a shortest path between every pair
+    // of elements from the two sets, like grok does
+    void showPath(ostream &out) {
+        position++;
+        expect('(');
+        ElementSet from = expectSet(parseExpression(), "showpath");
+        expect(',');
+        ElementSet to = expectSet(parseExpression(), "showpath");
+        expect(',');
+        Value relation = parseExpression();
+        const Relation &steps = expectRelation(relation, "showpath");
+        expect(')');
+        for (uint32_t source : from) {
+            for (uint32_t destination : to) {
+                vector<uint32_t> path = steps.shortestPath(source, destination);
+                for (size_t i = 0; i < path.size(); i++) {
+                    out << (i > 0 ? " -> " : "") << script.elementName(path[i]);
+                }
+                if (!path.empty()) {
+                    out << "\n";
+                }
+            }
+        }
+    }
+
+    void runStatement(ostream &out) {
+        if (isKeyword(peek(), "for")) {
+            runLoop(out);
+            return;
+        } else if (isKeyword(peek(), "if")) {
+            runIf(out);
+            return;
+        } else if (isKeyword(peek(), "quit") && isSymbol(peek(1), ';')) {
+            script.quit = true;
+            throw Quit();
+        } else if (isKeyword(peek(), "showpath") && isSymbol(peek(1), '(')) {
+            showPath(out);
+        } else if (isKeyword(peek(), "print")) {
+            position++;
+            if (textAhead()) {
+                // Joins the parts, like print "There are " + #set + " cases";
+                string line;
+                while (true) {
+                    if (peek().kind == Token::STRING) {
+                        line += peek().text;
+                        position++;
+                    } else {
+                        line += text(parseIntersection());
+                    }
+                    if (!isSymbol(peek(), '+')) {
+                        break;
+                    }
+                    position++;
+                }
+                out << line << "\n";
+            } else {
+                print(parseExpression(), out);
+            }
+        } else if (peek().kind == Token::NAME && isSymbol(peek(1), '=')) {
+            const Token &name = peek();
+            if (name.text == "$INSTANCE" || name.text == "o" || name.text == "X" || name.text == "inv" ||
+                name.text == "dom" || name.text == "rng" || name.text == "id") {
+                fail("cannot assign to '" + name.text + "'");
+            }
+            position += 2;
+            Value value = parseExpression();
+            script.variables[name.text] = move(value);
+        } else {
+            print(parseExpression(), out);
+        }
+        expect(';');
+    }
+
+    void run(ostream &out) {
+        try {
+            while (peek().kind != Token::END) {
+                runStatement(out);
+            }
+        } catch (Quit &) {
+        }
+        out.flush();
+    }
+};
+
+RelationScript::RelationScript(const GraphSnapshot &graph, unsigned int jobs)
+    : graph{graph}, jobs{jobs}, quit{false}, numStrings{static_cast<uint32_t>(graph.numStrings())} {
+    // Strings are only distinguished by their text, like in grok, so the same
+    // text always has to be the same element. Node IDs are unique, but an
+    // attribute value can be the same as a node ID or a type name.
+    canonicalStrings.resize(numStrings - graph.numNodes());
+    for (uint32_t number = graph.numNodes(); number < numStrings; number++) {
+        const char *text = graph.getString(number);
+        uint32_t node = graph.findNode(text);
+        uint32_t canonical = node != GraphSnapshot::NO_NODE ? node : stringNumbers.emplace(text, number).first->second;
+        canonicalStrings[number - graph.numNodes()] = canonical;
+    }
+}
+
+const Relation *RelationScript::edgeRelation(const string &name) {
+    auto cached = edgeRelations.find(name);
+    if (cached != edgeRelations.end()) {
+        return &cached->second;
+    }
+
+    RexEdge::EdgeType type;
+    try {
+        type = RexEdge::stringToType(name);
+    } catch (domain_error &) {
+        return nullptr;
+    }
+    vector<Relation::Pair> pairs;
+    for (uint32_t node = 0; node < graph.numNodes(); node++) {
+        GraphSnapshot::Range edges = graph.outEdges(node, type);
+        for (uint32_t edge = edges.first; edge < edges.last; edge++) {
+            pairs.emplace_back(node, graph.edgeDestination(edge));
+        }
+    }
+    return &(edgeRelations[name] = Relation(move(pairs)));
+}
+
+const Relation *RelationScript::attributeRelation(const string &name) {
+    auto cached = attributeRelations.find(name);
+    if (cached != attributeRelations.end()) {
+        return &cached->second;
+    }
+
+    RexAttribute::Key key;
+    try {
+        key = RexAttribute::stringToKey(name);
+    } catch (domain_error &) {
+        return nullptr;
+    }
+    vector<Relation::Pair> pairs;
+    for (uint32_t node = 0; node < graph.numNodes(); node++) {
+        for (uint32_t value : graph.nodeAttribute(node, key)) {
+            pairs.emplace_back(node, canonicalStrings[value - graph.numNodes()]);
+        }
+    }
+    return &(attributeRelations[name] = Relation(move(pairs)));
+}
+
+Relation RelationScript::instances() const {
+    vector<Relation::Pair> pairs;
+    pairs.reserve(graph.numNodes());
+    for (uint32_t node = 0; node < graph.numNodes(); node++) {
+        // The names of the node types come right after the node IDs
+        uint32_t name = graph.numNodes() + graph.nodeType(node);
+        pairs.emplace_back(node, canonicalStrings[name - graph.numNodes()]);
+    }
+    return Relation(move(pairs));
+}
+
+uint32_t RelationScript::element(const string &text) {
+    // TA files keep the quotes around string values, so scripts written for
+    // grok compare with literals like "\"1\"". The snapshot stores the value
+    // without them.
+    const string name = text.size() >= 2 && text.front() == '"' && text.back() == '"'
+                            ? text.substr(1, text.size() - 2) : text;
+    uint32_t node = graph.findNode(name);
+    if (node != GraphSnapshot::NO_NODE) {
+        return node;
+    }
+    auto string = stringNumbers.find(name);
+    if (string != stringNumbers.end()) {
+        return string->second;
+    }
+    // Only in the script, so it can't be related to anything in the graph
+    extraStrings.push_back(name);
+    return stringNumbers[name] = numStrings + extraStrings.size() - 1;
+}
+
+string RelationScript::elementName(uint32_t element) const {
+    return element < numStrings ? graph.getString(element) : extraStrings[element - numStrings];
+}
+
+void RelationScript::run(istream &script, ostream &out) {
+    if (quit) {
+        return;
+    }
+    string text{istreambuf_iterator<char>(script), istreambuf_iterator<char>()};
+    Parser(*this, text).run(out);
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstdint> // uint32_t
+#include <istream> // istream
+#include <map> // map
+#include <ostream> // ostream
+#include <string> // string
+#include <unordered_map> // unordered_map
+#include <vector> // vector
+
+#include "../Linker/GraphSnapshot.h"
+#include "Relation.h"
+
+// Runs scripts written in the relational part of grok, the language of the
+// TriageCheck scripts, directly on a graph snapshot.
+//
+// A script is a list of statements:
+//   name = expr;                 assigns a variable
+//   expr;  print expr;           prints the value, one element or pair per line
+//   print "text" + expr + ...;   prints the parts on one line, with numbers
+//                                and the elements of sets as text
+//   for name in set { ... }      runs the statements once per element, with
+//                                name set to just that element
+//   if #x > 0 { ... } else { ... }
+//                                runs one of the blocks; the comparison of two
+//                                numbers can be ==, !=, <, <=, > or >=
+//   showpath(set, set, rel);     prints a shortest path between the elements
+//                                of the two sets as `a -> b -> c`
+//   quit;                        stops this script and any after it
+// and `//` starts a comment. Expressions, from the loosest binding:
+//   a + b, a - b     union and difference
+//   a ^ b            intersection
+//   a o b, a X b     composition (a set stands for its identity relation) and
+//                    the cross product of two sets
+//   s . r, r . s     image and preimage of a set (r . r composes)
+//   inv r, dom r, rng r, id s, #x
+//   r+               transitive closure
+//   name             a variable, or else every edge of that type (e.g. call)
+//   @name            every node with that attribute, related to its values
+//   $INSTANCE        every node, related to the name of its type
+//   {"a", "b"}       a set of node IDs or strings, with or without the quotes
+//                    TA files keep around string values, or of set variables
+//   grep(s, "regex") the elements of a set whose names match the regex
+//   0, 1, ...        a number
+//   (expr)
+// Reading files and the other grok built-ins are not supported.
+class RelationScript {
+  public:
+    struct Value {
+        enum Kind { SET, RELATION, NUMBER };
+
+        Kind kind;
+        ElementSet set;
+        Relation relation;
+        size_t number;
+    };
+
+  private:
+    const GraphSnapshot &graph;
+    unsigned int jobs;
+    // Set by quit; so that no more scripts run
+    bool quit;
+
+    std::map<std::string, Value> variables;
+    std::map<std::string, Relation> edgeRelations;
+    std::map<std::string, Relation> attributeRelations;
+
+    // Every string in the snapshot after the node IDs, by value, and the
+    // strings that only appear in the script, numbered after them
+    std::unordered_map<std::string, uint32_t> stringNumbers;
+    // The element each string after the node IDs stands for
+    std::vector<uint32_t> canonicalStrings;
+    std::vector<std::string> extraStrings;
+    uint32_t numStrings;
+
+    // Null if there is no edge type or attribute with that name
+    const Relation *edgeRelation(const std::string &name);
+    const Relation *attributeRelation(const std::string &name);
+    Relation instances() const;
+
+    // The element a string literal of the script stands for
+    uint32_t element(const std::string &text);
+    std::string elementName(uint32_t element) const;
+
+    // Parses and evaluates the statements of a single script
+    class Parser;
+
+  public:
+    RelationScript(const GraphSnapshot &graph, unsigned int jobs);
+
+    // Throws runtime_error pointing at the line of the first statement that
+    // can't be parsed or evaluated
+    void run(std::istream &script, std::ostream &out);
+};
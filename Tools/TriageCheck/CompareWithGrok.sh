@@ -0,0 +1,110 @@
+#!/bin/bash
+
+####################################
+# Comparison of the Rex Ports
+#
+# This script runs the triage system with the
+# grok scripts on a TA model and with their
+# rex_scripts ports (-r) on a snapshot of the
+# same model, for every hotspot and analysis
+# type, and checks that the results match.
+####################################
+
+source helper_scripts/ColourFormat.sh
+
+print_usage()
+{
+	echo "Usage: ./CompareWithGrok.sh -i <MODEL.ta> -s <MODEL.rexsnap>"
+	echo ""
+	echo "Both files have to come from the same run of Rex, e.g."
+	echo "Rex --output=MODEL.ta --snapshot=MODEL.rexsnap *.tao"
+	echo "Needs QL in PATH, and Rex in PATH or in REX."
+}
+
+# Performs option processing.
+while getopts ":i:s:h" opt; do
+	case $opt in
+		i)
+			TA_MODEL=$OPTARG
+			;;
+		s)
+			SNAPSHOT=$OPTARG
+			;;
+		h)
+			print_usage
+			exit 0
+			;;
+		\?)
+			error_msg "ERROR: Invalid option: -$OPTARG" >&2
+			print_usage
+			exit 1
+			;;
+		:)
+			error_msg "Option -$OPTARG requires an argument." >&2
+			print_usage
+			exit 1
+			;;
+	esac
+done
+
+# Checks if mandatory options are set.
+if [ -z $TA_MODEL ] || [ -z $SNAPSHOT ]; then
+	error_msg "ERROR: Options -i and -s need to be set!"
+	print_usage
+	exit 1
+fi
+
+# QL check. Triage.sh checks for Rex.
+ql fake_file 2> /dev/null
+if [ $? -ne 0 ]; then
+	error_msg "ERROR: QL is not found! Make sure it's installed before proceeding."
+	exit 1
+fi
+
+GROK_OUT=$(mktemp /tmp/ScriptGrok.XXXXXX)
+REX_OUT=$(mktemp /tmp/ScriptRex.XXXXXX)
+
+# TA files keep the quotes around labels and snapshots don't, and grok and Rex
+# don't list elements in the same order, so the quotes and the date of the run
+# are dropped and the lines sorted.
+normalize()
+{
+	grep -v "^Computed on: " $1 | tr -d '"' | sort
+}
+
+FAILED=0
+for MODEL_TYPE in BEH PUB TIME; do
+	for TYPE in PATH PATH_LENGTH INT; do
+		if [ "$TYPE" == "PATH_LENGTH" ]; then
+			OPTIONS="-m $MODEL_TYPE -t PATH -p"
+		else
+			OPTIONS="-m $MODEL_TYPE -t $TYPE"
+		fi
+
+		echo -n "Comparing $OPTIONS..."
+		bash Triage.sh -i $TA_MODEL $OPTIONS -o $GROK_OUT > /dev/null
+		if [ $? -ne 0 ]; then
+			error_msg "grok failed!"
+			FAILED=1
+			continue
+		fi
+		bash Triage.sh -r -i $SNAPSHOT $OPTIONS -o $REX_OUT > /dev/null
+		if [ $? -ne 0 ]; then
+			error_msg "Rex failed!"
+			FAILED=1
+			continue
+		fi
+
+		diff <(normalize $GROK_OUT) <(normalize $REX_OUT) > /dev/null
+		if [ $? -eq 0 ]; then
+			success_msg "Same"
+		else
+			error_msg "Different (< grok, > Rex):"
+			diff <(normalize $GROK_OUT) <(normalize $REX_OUT)
+			FAILED=1
+		fi
+	done
+done
+
+rm $GROK_OUT $REX_OUT
+exit $FAILED
@@ -16,7 +16,7 @@ EXCLUDE_FILE="ExcludeElements.txt"
 TYPE="PATH"
 
 # Performs option processing.
-while getopts ":i:o:hm:e:pt:" opt; do
+while getopts ":i:o:hm:e:pt:r" opt; do
 	case $opt in
 		i)
 			INPUT_MODEL=$OPTARG
@@ -39,8 +39,8 @@ while getopts ":i:o:hm:e:pt:" opt; do
 			;;
 		e)
 			# Check whether the file exists.
-			EXCLUDE_ELEMENTS=$OPTARG
-			if [ ! -f $EXCLUDE_ELEMENTS ]; then
+			EXCLUDE_FILE=$OPTARG
+			if [ ! -f $EXCLUDE_FILE ]; then
 				error_msg "ERROR: Exclude elements file does not exist. Please check your argument."
 				print_help
 				exit 1
@@ -59,6 +59,10 @@ while getopts ":i:o:hm:e:pt:" opt; do
 				exit 1
 			fi
       			;;
+		r)
+			# Query a Rex snapshot instead of a TA model.
+			USE_REX=true
+			;;
 		\?)
 			error_msg "ERROR: Invalid option: -$OPTARG" >&2
 			print_help
@@ -93,12 +97,27 @@ if [ ! -z $OUTPUT_PATH_LENGTH ]; then
 	echo "NOTE: Path length details will be outputted with triage stats."
 fi
 
-# QL check.
-ql fake_file 2> /dev/null
-if [ $? -ne 0 ]; then
-	error_msg "ERROR: QL is not found! Make sure it's installed before proceeding."
-	print_help
-	exit 1
+if [ -z $USE_REX ]; then
+	# QL check.
+	ql fake_file 2> /dev/null
+	if [ $? -ne 0 ]; then
+		error_msg "ERROR: QL is not found! Make sure it's installed before proceeding."
+		print_help
+		exit 1
+	fi
+else
+	# Rex check.
+	if [ -z "$REX" ]; then
+		REX_EXECUTABLE=Rex
+	else
+		REX_EXECUTABLE="$REX"
+	fi
+	$REX_EXECUTABLE query --help > /dev/null 2>&1
+	if [ $? -ne 0 ]; then
+		error_msg "ERROR: Rex is not found! Make sure it's in PATH or set REX before proceeding."
+		print_help
+		exit 1
+	fi
 fi
 
 # Creates temporary files.
@@ -107,17 +126,65 @@ TMP_FILE_TRI=$(mktemp /tmp/ScriptTriage.XXXXX)
 TMP_FILE_RES=$(mktemp /tmp/ScriptTriageRes.XXXXX)
 TMP_MODEL=$(mktemp /tmp/ScriptModel.XXXXX)
 TMP_FILE_PT=$(mktemp /tmp/ScriptResTwo.XXXXXX)
+TMP_EXCLUDE=$(mktemp /tmp/ScriptExclude.XXXXXX)
+TMP_LOG=$(mktemp /tmp/ScriptLog.XXXXXX)
 
 # Injects elements into the model.
-if [ -f $EXCLUDE_ELEMENTS ]; then
+if [ -f $EXCLUDE_FILE ]; then
 	TMP_REMOVE=$EXCLUDE_FILE
 fi
 
+# Runs the given rex_scripts ports of the grok scripts in order on the input
+# snapshot. They share their variables.
+rex_query()
+{
+	SCRIPTS=()
+	for SCRIPT in "$@"; do
+		SCRIPTS+=(--script "$SCRIPT")
+	done
+	$REX_EXECUTABLE query "${SCRIPTS[@]}" $INPUT_MODEL 2> $TMP_LOG
+	if [ $? -ne 0 ]; then
+		error_msg "ERROR: Rex query failed!"
+		cat $TMP_LOG >&2
+		exit 1
+	fi
+}
+
+if [ ! -z $USE_REX ]; then
+	# Rex scripts can't read the exclude file like the grok scripts do, so
+	# it becomes a script that sets `excluded` to the elements whose labels
+	# match any of its regular expressions.
+	echo "excluded = {};" > $TMP_EXCLUDE
+	if [ ! -z $TMP_REMOVE ]; then
+		while read -r PATTERN; do
+			PATTERN=${PATTERN#\"}
+			PATTERN=${PATTERN%\"}
+			PATTERN=${PATTERN//\\/\\\\}
+			if [ ! -z "$PATTERN" ]; then
+				echo "excluded = excluded + @label . grep(rng @label, \"$PATTERN\");" >> $TMP_EXCLUDE
+			fi
+		done < $TMP_REMOVE
+	fi
+
+	if [ "$MODEL_TYPE" == "BEH" ]; then
+		ALTERATION=rex_scripts/BehaviourAlteration
+	elif [ "$MODEL_TYPE" == "PUB" ]; then
+		ALTERATION=rex_scripts/PublisherAlteration
+	else
+		ALTERATION=rex_scripts/TimerAlteration
+	fi
+fi
+
 # Get the type of analysis to perform.
 if [ "$TYPE" == "PATH" ]; then
 	# Get the model type.
 	echo -n "Getting all path lengths from hotspot..."
-	if [ "$MODEL_TYPE" == "BEH" ]; then
+	if [ ! -z $USE_REX ]; then
+		rex_query $TMP_EXCLUDE ${ALTERATION}One.rql rex_scripts/ShowPaths.rql > $TMP_FILE_MDL
+		if [ ! -z $OUTPUT_PATH_LENGTH ]; then
+			rex_query $TMP_EXCLUDE ${ALTERATION}One.rql rex_scripts/ShowLabelPaths.rql > $TMP_FILE_PT
+		fi
+	elif [ "$MODEL_TYPE" == "BEH" ]; then
 		ql grok_scripts/BehaviourAlterationOne.ql $INPUT_MODEL $TMP_REMOVE > $TMP_FILE_MDL 
 		if [ ! -z $OUTPUT_PATH_LENGTH ]; then
 			ql grok_scripts/BehaviourAlterationOne.ql $INPUT_MODEL $TMP_REMOVE true > $TMP_FILE_PT 
@@ -147,14 +214,20 @@ if [ "$TYPE" == "PATH" ]; then
 
 	# Last, generates the control flow results.
 	echo -n "Generating hotspot results..."
-	cat $INPUT_MODEL > $TMP_MODEL
-	python3 helper_scripts/model_modifier.py $TMP_FILE_TRI >> $TMP_MODEL
-	if [ "$MODEL_TYPE" == "BEH" ]; then
-		ql grok_scripts/BehaviourAlterationTwo.ql $TMP_MODEL $TMP_REMOVE > $TMP_FILE_MDL
-	elif [ "$MODEL_TYPE" == "PUB" ]; then
-		ql grok_scripts/PublisherAlterationTwo.ql $TMP_MODEL $TMP_REMOVE > $TMP_FILE_MDL
-	elif [ "$MODEL_TYPE" == "TIME" ]; then
-		ql grok_scripts/TimerAlterationTwo.ql $TMP_MODEL $TMP_REMOVE > $TMP_FILE_MDL
+	if [ ! -z $USE_REX ]; then
+		# The path sizes go into a script instead of the snapshot.
+		python3 helper_scripts/model_modifier.py $TMP_FILE_TRI rex > $TMP_MODEL
+		rex_query $TMP_EXCLUDE $TMP_MODEL ${ALTERATION}Two.rql > $TMP_FILE_MDL
+	else
+		cat $INPUT_MODEL > $TMP_MODEL
+		python3 helper_scripts/model_modifier.py $TMP_FILE_TRI >> $TMP_MODEL
+		if [ "$MODEL_TYPE" == "BEH" ]; then
+			ql grok_scripts/BehaviourAlterationTwo.ql $TMP_MODEL $TMP_REMOVE > $TMP_FILE_MDL
+		elif [ "$MODEL_TYPE" == "PUB" ]; then
+			ql grok_scripts/PublisherAlterationTwo.ql $TMP_MODEL $TMP_REMOVE > $TMP_FILE_MDL
+		elif [ "$MODEL_TYPE" == "TIME" ]; then
+			ql grok_scripts/TimerAlterationTwo.ql $TMP_MODEL $TMP_REMOVE > $TMP_FILE_MDL
+		fi
 	fi
 	success_msg "Done!"
 
@@ -165,7 +238,11 @@ if [ "$TYPE" == "PATH" ]; then
 else
 	# Get the model type.
 	echo -n "Getting all path lengths from graph..."
-	ql grok_scripts/InteractionPathLength.ql $INPUT_MODEL true > $TMP_FILE_MDL
+	if [ ! -z $USE_REX ]; then
+		rex_query rex_scripts/InteractionPathLength.rql > $TMP_FILE_MDL
+	else
+		ql grok_scripts/InteractionPathLength.ql $INPUT_MODEL true > $TMP_FILE_MDL
+	fi
 	success_msg "Done!"
 
 	# Format the results.
@@ -175,7 +252,9 @@ else
 
 	# Run the main hotspot script.
 	echo -n "Generating hotspot results..."
-	if [ "$MODEL_TYPE" == "BEH" ]; then
+	if [ ! -z $USE_REX ]; then
+		rex_query ${ALTERATION}Three.rql > $TMP_MODEL
+	elif [ "$MODEL_TYPE" == "BEH" ]; then
 		ql grok_scripts/BehaviourAlterationThree.ql $INPUT_MODEL true > $TMP_MODEL
 	elif [ "$MODEL_TYPE" == "PUB" ]; then
 		ql grok_scripts/PublisherAlterationThree.ql $INPUT_MODEL true > $TMP_MODEL
@@ -187,6 +266,6 @@ else
 fi
 
 # Cleans the script up and ends.
-rm $TMP_MODEL $TMP_FILE_MDL $TMP_FILE_TRI $TMP_FILE_RES $TMP_FILE_PT
+rm $TMP_MODEL $TMP_FILE_MDL $TMP_FILE_TRI $TMP_FILE_RES $TMP_FILE_PT $TMP_EXCLUDE $TMP_LOG
 echo ""
 success_msg "Results successfully written to ${OUTPUT_FILE}!"
@@ -19,4 +19,6 @@ print_help()
 	echo "                              Default is PATH."
 	echo "                              PATH refers to the length of the interaction path inside the component."
 	echo "                              INT refers to the length of the message passing path prior to the component."
+	echo "-r			: Run the rex_scripts ports with Rex query instead of the grok scripts with QL."
+	echo "			  -i is then a graph snapshot of the model (see Rex --snapshot)."
 }
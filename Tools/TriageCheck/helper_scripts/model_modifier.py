@@ -1,9 +1,9 @@
 import sys
 
 # Gets the temp name passed in.
-if len(sys.argv) != 2:
+if len(sys.argv) != 2 and (len(sys.argv) != 3 or sys.argv[2] != "rex"):
 	print("You must supply a valid filename to continue.")
-	print("Usage: " + sys.argv[0] + " " + "filename.txt")
+	print("Usage: " + sys.argv[0] + " " + "filename.txt" + " [rex]")
 
 	sys.exit(1)
 
@@ -12,6 +12,22 @@ with open(sys.argv[1]) as f:
     content = f.readlines()
 content = [x.strip() for x in content] 
 
+# A Rex snapshot can't take new facts, so for rex the path sizes become a
+# script relating the ID of each path to both of its ends and its size.
+if len(sys.argv) == 3:
+	print("pathFrom = {} X {};")
+	print("pathTo = {} X {};")
+	print("pathSize = {} X {};")
+	for line in content:
+		delim = line.split(' ')
+		delim = [x.replace('\\', '\\\\').replace('"', '\\"') for x in delim]
+
+		ID = "\"" + delim[1] + " -> " + delim[2] + "\""
+		print("pathFrom = pathFrom + {" + ID + "} X {\"" + delim[1] + "\"};")
+		print("pathTo = pathTo + {" + ID + "} X {\"" + delim[2] + "\"};")
+		print("pathSize = pathSize + {" + ID + "} X {\"" + delim[0] + "\"};")
+	sys.exit(0)
+
 # Loop through the triage file and splits by space.
 print("\nFACT TUPLE :")
 for line in content:
@@ -0,0 +1,69 @@
+#include "AncestorIndex.h"
+
+#include <vector>
+
+using namespace std;
+using namespace clang;
+
+// Walks the body with an explicit stack (bodies can be nested deeply enough
+// to make recursion a concern) and records the ancestors of every statement.
+//
+// This follows Stmt::children(), which matches the parent map for everything
+// we query. The exception is DeclStmt: in the parent map a variable's
+// initializer is a child of the VarDecl, so decls are handled separately.
+void AncestorIndex::indexFunction(const FunctionDecl *decl) {
+    const Stmt *body = decl->getBody();
+    if (!body || !indexedFunctions.insert(decl).second) {
+        return;
+    }
+
+    vector<pair<const Stmt *, Ancestors>> pending;
+    pending.emplace_back(body, Ancestors{decl, decl, nullptr, nullptr});
+    while (!pending.empty()) {
+        const Stmt *stmt = pending.back().first;
+        Ancestors ancestors = pending.back().second;
+        pending.pop_back();
+        if (!stmt || !stmts.emplace(stmt, ancestors).second) {
+            continue;
+        }
+
+        if (const auto *declStmt = dyn_cast<DeclStmt>(stmt)) {
+            for (const Decl *child : declStmt->decls()) {
+                decls.emplace(child, ancestors.namedDecl);
+                const auto *var = dyn_cast<VarDecl>(child);
+                if (var && var->hasInit()) {
+                    Ancestors inInit = ancestors;
+                    inInit.namedDecl = var;
+                    pending.emplace_back(var->getInit(), inInit);
+                }
+            }
+            continue;
+        }
+
+        // Children of a control statement record it as their nearest one
+        bool isControl = isControlStmt(stmt);
+        for (const Stmt *child : stmt->children()) {
+            Ancestors childAncestors = ancestors;
+            if (isControl) {
+                childAncestors.control = stmt;
+                childAncestors.controlChild = child;
+            }
+            pending.emplace_back(child, childAncestors);
+        }
+    }
+}
+
+const AncestorIndex::Ancestors *AncestorIndex::find(const Stmt *stmt) const {
+    auto ancestors = stmts.find(stmt);
+    return ancestors == stmts.end() ? nullptr : &ancestors->second;
+}
+
+const NamedDecl *AncestorIndex::enclosingDecl(const Decl *decl) const {
+    auto parent = decls.find(decl);
+    return parent == decls.end() ? nullptr : parent->second;
+}
+
+bool AncestorIndex::isControlStmt(const Stmt *stmt) {
+    return isa<IfStmt>(stmt) || isa<ForStmt>(stmt) || isa<WhileStmt>(stmt) ||
+           isa<DoStmt>(stmt) || isa<SwitchStmt>(stmt);
+}
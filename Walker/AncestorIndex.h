@@ -0,0 +1,51 @@
+#ifndef REX_ANCESTORINDEX_H
+#define REX_ANCESTORINDEX_H
+
+#include <unordered_map>
+#include <unordered_set>
+
+#include <clang/AST/Decl.h>
+#include <clang/AST/Stmt.h>
+
+// The ancestors that the walker keeps asking about, precomputed for every
+// statement in a function body.
+//
+// Answering these with ASTContext::getParents means climbing one level at a
+// time (and allocating a parent list at every level), which gets expensive in
+// deeply nested code. Instead, each function body is walked once when the
+// walker reaches its FunctionDecl and the answers are stored per statement.
+//
+// Statements and decls that were never indexed (e.g. global initializers) are
+// simply not found, and callers fall back to climbing the parent map.
+class AncestorIndex {
+  public:
+    struct Ancestors {
+        // Nearest enclosing NamedDecl (the function, or a variable whose
+        // initializer contains this statement)
+        const clang::NamedDecl *namedDecl;
+        // The function whose body contains this statement
+        const clang::FunctionDecl *function;
+        // Nearest enclosing if/for/while/do/switch, if any
+        const clang::Stmt *control;
+        // The direct child of `control` that this statement is in (this
+        // statement itself if it is a direct child)
+        const clang::Stmt *controlChild;
+    };
+
+    void indexFunction(const clang::FunctionDecl *decl);
+
+    // nullptr if the statement was not indexed
+    const Ancestors *find(const clang::Stmt *stmt) const;
+    // The nearest NamedDecl enclosing a decl declared in an indexed function
+    // body, or nullptr if the decl was not indexed
+    const clang::NamedDecl *enclosingDecl(const clang::Decl *decl) const;
+
+    static bool isControlStmt(const clang::Stmt *stmt);
+
+  private:
+    std::unordered_set<const clang::FunctionDecl *> indexedFunctions;
+    std::unordered_map<const clang::Stmt *, Ancestors> stmts;
+    std::unordered_map<const clang::Decl *, const clang::NamedDecl *> decls;
+};
+
+#endif // REX_ANCESTORINDEX_H
@@ -1,7 +1,7 @@
 
 #include "BaselineWalker.h"
 
-BaselineWalker::BaselineWalker() {}
+BaselineWalker::BaselineWalker() : numDecls{0}, numStmts{0} {}
 
 BaselineWalker::~BaselineWalker() {}
 
@@ -82,3 +82,26 @@ bool BaselineWalker::TraverseDoStmt(clang::DoStmt *s) {
 bool BaselineWalker::TraverseChildren(clang::Stmt *s) {
     return s || !s;
 }
+
+bool BaselineWalker::WalkUpFromDecl(clang::Decl *d) {
+    numDecls++;
+    return RecursiveASTVisitor<BaselineWalker>::WalkUpFromDecl(d);
+}
+
+bool BaselineWalker::WalkUpFromStmt(clang::Stmt *s) {
+    numStmts++;
+    return RecursiveASTVisitor<BaselineWalker>::WalkUpFromStmt(s);
+}
+
+unsigned long BaselineWalker::getNumDecls() const {
+    return numDecls;
+}
+
+unsigned long BaselineWalker::getNumStmts() const {
+    return numStmts;
+}
+
+void BaselineWalker::reportTelemetry(JobTelemetry &telemetry) const {
+    telemetry.numDecls += numDecls;
+    telemetry.numStmts += numStmts;
+}
@@ -6,6 +6,8 @@
 #include <clang/AST/Expr.h>
 #include <clang/AST/RecursiveASTVisitor.h>
 
+#include "../Driver/JobTelemetry.h"
+
 class BaselineWalker : public clang::RecursiveASTVisitor<BaselineWalker>{
   public:
     // Constructor/Destructor
@@ -32,6 +34,19 @@ class BaselineWalker : public clang::RecursiveASTVisitor<BaselineWalker>{
     virtual bool TraverseDoStmt(clang::DoStmt *s);
     // This isn't a Clang Traverse Stmt.
     virtual bool TraverseChildren(clang::Stmt *s);
+
+    // Every decl/stmt visited goes through these, so they are used to count
+    // the size of the AST we walked
+    bool WalkUpFromDecl(clang::Decl *d);
+    bool WalkUpFromStmt(clang::Stmt *s);
+    unsigned long getNumDecls() const;
+    unsigned long getNumStmts() const;
+    // Adds the walker's counters to the telemetry for this job
+    virtual void reportTelemetry(JobTelemetry &telemetry) const;
+
+  private:
+    unsigned long numDecls;
+    unsigned long numStmts;
 };
 
 #endif // REX_BASELINEWALKER_H
@@ -0,0 +1,188 @@
+#include "CondBDD.h"
+
+#include <climits>
+
+#include "CondScope.h"
+
+using namespace std;
+
+CondBDD *CondBDD::instance = nullptr;
+
+void CondBDD::enable(const VariabilityOptions &vOpts) {
+    if (!instance) {
+        instance = new CondBDD(vOpts);
+    }
+}
+
+bool CondBDD::isEnabled() {
+    return instance != nullptr;
+}
+
+const RexCond *CondBDD::simplify(const RexCond *cond) {
+    if (!cond || !instance) return cond;
+    return instance->toCond(instance->fromCond(cond));
+}
+
+const RexCond *CondBDD::disjunction(const RexCond *a, const RexCond *b) {
+    if (!a || !b || !instance) {
+        return simplify(a ? a : b);
+    }
+    Ref f = instance->ite(instance->fromCond(a), TRUE_REF, instance->fromCond(b));
+    return instance->toCond(f);
+}
+
+size_t CondBDD::TripleHash::operator()(const Triple &t) const {
+    size_t h = get<0>(t);
+    h = h * 0x9e3779b1 + get<1>(t);
+    h = h * 0x9e3779b1 + get<2>(t);
+    return h;
+}
+
+CondBDD::CondBDD(const VariabilityOptions &vOpts) : cfgVarPattern{vOpts.nameMatch, NamePattern::SEARCH} {
+    // The two terminals
+    nodes.push_back(Node{UINT_MAX, FALSE_REF, FALSE_REF});
+    nodes.push_back(Node{UINT_MAX, TRUE_REF, TRUE_REF});
+}
+
+unsigned int CondBDD::getVar(const RexCond *pred) {
+    auto found = varOf.find(pred);
+    if (found != varOf.end()) {
+        return found->second;
+    }
+
+    const string &text = pred->to_string();
+    Var var{pred, false, text};
+    string cfgVar;
+    if (!cfgVarPattern.empty() && cfgVarPattern.matches(text, cfgVar)) {
+        var.cfgMatch = true;
+        var.key = cfgVar + '\0' + text;
+    } else if (cfgVarPattern.empty()) {
+        var.cfgMatch = pred->containsCfgVar();
+    }
+
+    unsigned int index = vars.size();
+    vars.push_back(var);
+    varOf.emplace(pred, index);
+    return index;
+}
+
+bool CondBDD::precedes(unsigned int a, unsigned int b) const {
+    // Terminals have no variable and come after everything
+    if (a == UINT_MAX || b == UINT_MAX) return a < b;
+    const Var &va = vars[a];
+    const Var &vb = vars[b];
+    if (va.cfgMatch != vb.cfgMatch) return va.cfgMatch;
+    int cmp = va.key.compare(vb.key);
+    if (cmp != 0) return cmp < 0;
+    return a < b;
+}
+
+unsigned int CondBDD::topVar(Ref f, Ref g, Ref h) const {
+    unsigned int top = nodes[f].var;
+    if (precedes(nodes[g].var, top)) top = nodes[g].var;
+    if (precedes(nodes[h].var, top)) top = nodes[h].var;
+    return top;
+}
+
+CondBDD::Ref CondBDD::cofactor(Ref f, unsigned int var, bool value) const {
+    const Node &node = nodes[f];
+    if (node.var != var) return f;
+    return value ? node.high : node.low;
+}
+
+CondBDD::Ref CondBDD::makeNode(unsigned int var, Ref low, Ref high) {
+    if (low == high) return low;
+    Triple key{var, low, high};
+    auto found = unique.find(key);
+    if (found != unique.end()) {
+        return found->second;
+    }
+    Ref ref = nodes.size();
+    nodes.push_back(Node{var, low, high});
+    unique.emplace(key, ref);
+    return ref;
+}
+
+// if f then g else h
+CondBDD::Ref CondBDD::ite(Ref f, Ref g, Ref h) {
+    if (f == TRUE_REF) return g;
+    if (f == FALSE_REF) return h;
+    if (g == h) return g;
+    if (g == TRUE_REF && h == FALSE_REF) return f;
+
+    Triple key{f, g, h};
+    auto found = iteCache.find(key);
+    if (found != iteCache.end()) {
+        return found->second;
+    }
+
+    unsigned int var = topVar(f, g, h);
+    Ref high = ite(cofactor(f, var, true), cofactor(g, var, true), cofactor(h, var, true));
+    Ref low = ite(cofactor(f, var, false), cofactor(g, var, false), cofactor(h, var, false));
+    Ref ref = makeNode(var, low, high);
+    iteCache.emplace(key, ref);
+    return ref;
+}
+
+CondBDD::Ref CondBDD::fromCond(const RexCond *cond) {
+    auto found = fromCondCache.find(cond);
+    if (found != fromCondCache.end()) {
+        return found->second;
+    }
+
+    Ref ref;
+    if (dynamic_cast<const RexTrue *>(cond)) {
+        ref = TRUE_REF;
+    } else if (auto paren = dynamic_cast<const RexCondParen *>(cond)) {
+        ref = fromCond(paren->getChild());
+    } else if (auto unOp = dynamic_cast<const RexUnaryOp *>(cond); unOp && unOp->getOp() == "!") {
+        ref = ite(fromCond(unOp->getChild()), FALSE_REF, TRUE_REF);
+    } else if (auto binOp = dynamic_cast<const RexBinaryOp *>(cond);
+               binOp && (binOp->getOp() == "&&" || binOp->getOp() == "||")) {
+        Ref lhs = fromCond(binOp->getLHS());
+        Ref rhs = fromCond(binOp->getRHS());
+        ref = binOp->getOp() == "&&" ? ite(lhs, rhs, FALSE_REF) : ite(lhs, TRUE_REF, rhs);
+    } else {
+        ref = makeNode(getVar(cond), FALSE_REF, TRUE_REF);
+    }
+
+    fromCondCache.emplace(cond, ref);
+    return ref;
+}
+
+// Writes each node as the shortest of the usual Shannon expansion forms
+const RexCond *CondBDD::toCond(Ref f) {
+    if (f == TRUE_REF) return RexTrue::makeTrue();
+    if (f == FALSE_REF) return RexUnaryOp::makeUnaryOp("!", RexTrue::makeTrue());
+
+    auto found = toCondCache.find(f);
+    if (found != toCondCache.end()) {
+        return found->second;
+    }
+
+    const Node node = nodes[f];
+    const RexCond *var = vars[node.var].pred;
+    const RexCond *ret;
+    if (node.high == TRUE_REF && node.low == FALSE_REF) {
+        ret = var;
+    } else if (node.high == FALSE_REF && node.low == TRUE_REF) {
+        ret = RexUnaryOp::makeUnaryOp("!", var);
+    } else if (node.low == FALSE_REF) {
+        ret = RexBinaryOp::makeBinaryOp("&&", var, toCond(node.high));
+    } else if (node.high == FALSE_REF) {
+        ret = RexBinaryOp::makeBinaryOp("&&", RexUnaryOp::makeUnaryOp("!", var), toCond(node.low));
+    } else if (node.high == TRUE_REF) {
+        ret = RexBinaryOp::makeBinaryOp("||", var, toCond(node.low));
+    } else if (node.low == TRUE_REF) {
+        ret = RexBinaryOp::makeBinaryOp("||", RexUnaryOp::makeUnaryOp("!", var), toCond(node.high));
+    } else {
+        ret = RexBinaryOp::makeBinaryOp("||",
+                RexBinaryOp::makeBinaryOp("&&", var, toCond(node.high)),
+                RexBinaryOp::makeBinaryOp("&&", RexUnaryOp::makeUnaryOp("!", var), toCond(node.low)));
+    }
+
+    toCondCache.emplace(f, ret);
+    // Converting the result back gives the same node, so skip that work later
+    fromCondCache.emplace(ret, f);
+    return ret;
+}
@@ -0,0 +1,82 @@
+#ifndef REX_CONDBDD_H
+#define REX_CONDBDD_H
+
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#include "../Driver/NamePattern.h"
+#include "../Driver/RexArgs.h"
+
+class RexCond;
+
+// Optional reduced ordered binary decision diagram backend for RexCond.
+//
+// When enabled, conditions are converted to BDDs as they are combined, so a
+// fact that is seen again under another path condition gets the simplified
+// disjunction instead of an ever longer "a || b || ..." string. Equivalent
+// conditions convert back to the same RexCond.
+//
+// The BDD variables are the leaves of the condition that aren't &&, ||, !, or
+// parentheses (atoms, comparisons, calls, ...). Leaves that mention a name
+// matching the configuration variable regex come first, grouped by that name,
+// and everything else is ordered by its text. Like the RexCond intern table,
+// the diagram is shared by the whole process (one translation unit).
+class CondBDD {
+  public:
+    static void enable(const VariabilityOptions &vOpts);
+    static bool isEnabled();
+
+    // The minimal form of `cond` (nullptr stays nullptr)
+    static const RexCond *simplify(const RexCond *cond);
+    // The minimal form of `a || b`
+    static const RexCond *disjunction(const RexCond *a, const RexCond *b);
+
+  private:
+    typedef unsigned int Ref;
+    static const Ref FALSE_REF = 0;
+    static const Ref TRUE_REF = 1;
+
+    struct Node {
+        unsigned int var;
+        Ref low;
+        Ref high;
+    };
+    struct Var {
+        const RexCond *pred;
+        // Whether the predicate mentions a configuration variable, and which
+        bool cfgMatch;
+        std::string key;
+    };
+    typedef std::tuple<unsigned int, unsigned int, unsigned int> Triple;
+    struct TripleHash {
+        std::size_t operator()(const Triple &t) const;
+    };
+
+    static CondBDD *instance;
+
+    NamePattern cfgVarPattern;
+    std::vector<Node> nodes;
+    std::vector<Var> vars;
+    std::unordered_map<const RexCond *, unsigned int> varOf;
+    std::unordered_map<Triple, Ref, TripleHash> unique;
+    std::unordered_map<Triple, Ref, TripleHash> iteCache;
+    std::unordered_map<const RexCond *, Ref> fromCondCache;
+    std::unordered_map<Ref, const RexCond *> toCondCache;
+
+    explicit CondBDD(const VariabilityOptions &vOpts);
+
+    unsigned int getVar(const RexCond *pred);
+    // Whether variable a comes before variable b in the order
+    bool precedes(unsigned int a, unsigned int b) const;
+    unsigned int topVar(Ref f, Ref g, Ref h) const;
+    Ref cofactor(Ref f, unsigned int var, bool value) const;
+
+    Ref makeNode(unsigned int var, Ref low, Ref high);
+    Ref ite(Ref f, Ref g, Ref h);
+    Ref fromCond(const RexCond *cond);
+    const RexCond *toCond(Ref f);
+};
+
+#endif // REX_CONDBDD_H
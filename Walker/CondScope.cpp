@@ -26,6 +26,7 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 /////////////////////////////////////////////////////////////////////////////////////////////////////////
 #include "CondScope.h"
+#include "CondBDD.h"
 // TODO: Clean up includes... may have gotten fed up and just
 //       copy pasted them from RexWalker...
 #include "clang/AST/ASTConsumer.h"
@@ -46,6 +47,9 @@
 #include <sstream>
 #include <iostream>
 #include <regex>
+#include <functional>
+#include <typeinfo>
+#include <unordered_set>
 
 using namespace llvm;
 using namespace clang;
@@ -53,7 +57,7 @@ using namespace std;
 
 long unsigned int RexCond::UID = 0;
 
-RexCond::RexCond() : pUID{UID++} {}
+RexCond::RexCond(size_t hash, bool cfgVar) : pUID{UID++}, hash{hash}, cfgVar{cfgVar}, hasText{false} {}
 
 RexCond::~RexCond() {}
 
@@ -61,33 +65,52 @@ long unsigned int RexCond::getUID() {
     return UID;
 }
 
-RexCond* makeUnaryOp(std::string op, RexCond *c) {
-    return RexUnaryOp::makeUnaryOp(op, c);
+bool RexCond::Equal::operator()(const RexCond *a, const RexCond *b) const {
+    return a->hash == b->hash && typeid(*a) == typeid(*b) &&
+           a->cfgVar == b->cfgVar && a->shallowEquals(*b);
 }
 
-RexCond* makeFnCall(clang::CallExpr *expr, std::vector<RexCond *> args, const VariabilityOptions &vOpts) {
-    return RexFnCall::makeFnCall(expr, args, vOpts);
+const RexCond *RexCond::intern(RexCond *cond) {
+    static unordered_set<const RexCond *, Hash, Equal> table;
+    auto inserted = table.insert(cond);
+    if (!inserted.second) {
+        delete cond;
+    }
+    return *inserted.first;
 }
 
-RexUnaryOp::RexUnaryOp(std::string op, RexCond *c) : child{c}, op{op} {}
+size_t RexCond::combineHash(size_t seed, size_t value) {
+    // Same mixing as boost::hash_combine
+    return seed ^ (value + 0x9e3779b9 + (seed << 6) + (seed >> 2));
+}
 
-RexCond* RexUnaryOp::makeUnaryOp(std::string op, RexCond *c) {
-    if (!c) return new RexTrue;
-    return new RexUnaryOp(op, c);
+const string &RexCond::to_string() const {
+    if (!hasText) {
+        text = buildString();
+        hasText = true;
+    }
+    return text;
 }
 
-RexUnaryOp::~RexUnaryOp() {
-    delete child;
+RexUnaryOp::RexUnaryOp(std::string op, const RexCond *c) :
+    RexCond{combineHash(combineHash(1, std::hash<string>{}(op)), c->getHash()), c->containsCfgVar()},
+    child{c}, op{op} {}
+
+const RexCond* RexUnaryOp::makeUnaryOp(std::string op, const RexCond *c) {
+    if (!c) return RexTrue::makeTrue();
+    return intern(new RexUnaryOp(op, c));
 }
-string RexUnaryOp::to_string() {
-    return op + child->to_string();
+
+bool RexUnaryOp::shallowEquals(const RexCond &node) const {
+    const RexUnaryOp &other = static_cast<const RexUnaryOp &>(node);
+    return child == other.child && op == other.op;
 }
 
-RexCond *RexUnaryOp::copy() {
-    return RexUnaryOp::makeUnaryOp(op, child->copy());
+string RexUnaryOp::buildString() const {
+    return op + child->to_string();
 }
 
-string RexUnaryOp::getTopID() {
+string RexUnaryOp::getTopID() const {
     if (op == "!") {
         return "NOT" + std::to_string(pUID);
     } else {
@@ -95,64 +118,32 @@ string RexUnaryOp::getTopID() {
     }
 }
 
+RexBinaryOp::RexBinaryOp(std::string op, const RexCond *l, const RexCond *r) :
+    RexCond{combineHash(combineHash(combineHash(2, std::hash<string>{}(op)), l->getHash()), r->getHash()),
+            l->containsCfgVar() || r->containsCfgVar()},
+    lhs{l}, rhs{r}, op{op} {}
 
-bool RexUnaryOp::containsCfgVar() {
-    return child->containsCfgVar();
-}
-
-bool RexUnaryOp::equivalent(RexCond *node) {
-    RexUnaryOp *other = dynamic_cast<RexUnaryOp*>(node);
-    if (!other) return false;
-    if (op != other->op) return false;
-    return child->equivalent(other->child);
-}
-
-RexBinaryOp::RexBinaryOp(std::string op, RexCond * l, RexCond *r) : lhs{l}, rhs{r}, op{op} {
-    if (!lhs) {
-        cerr << "Missing lhs"<< endl;
-        throw 10;
-    }
-    if (!rhs) {
-        cerr << "Missing rhs" << endl;
-        throw "hello";
-    }
-}
-
-RexCond *makeBinaryOp(std::string op, RexCond *l, RexCond *r) {
-    return RexBinaryOp::makeBinaryOp(op, l, r);
-}
-
-RexCond *RexBinaryOp::makeBinaryOp(std::string op, RexCond *l, RexCond *r) {
+const RexCond *RexBinaryOp::makeBinaryOp(std::string op, const RexCond *l, const RexCond *r) {
     // Factory to just make RexTrue's if the binaryOp is not creatable.
     // Possibly not the best solution but at the moment it might make sense
     // to ignore conditions that can't be resolved. Hopefully it is mostly
     // things the user should not care about anyways (implicit things such as range loops)
     if (!l || !r) {
-        return new RexTrue;
+        return RexTrue::makeTrue();
     }
-    return new RexBinaryOp(op, l, r);
+    return intern(new RexBinaryOp(op, l, r));
 }
 
-RexBinaryOp::~RexBinaryOp() {
-    delete lhs;
-    delete rhs;
+bool RexBinaryOp::shallowEquals(const RexCond &node) const {
+    const RexBinaryOp &other = static_cast<const RexBinaryOp &>(node);
+    return lhs == other.lhs && rhs == other.rhs && op == other.op;
 }
 
-string RexBinaryOp::to_string() {
-    string suff = ")";
-    string pref = "(";
-    if (op == "||") {
-        suff = ")";
-        pref = "(";
-    }
-    return pref + lhs->to_string() + op + rhs->to_string() + suff;
-}
-
-RexCond *RexBinaryOp::copy() {
-    return RexBinaryOp::makeBinaryOp(op, lhs->copy(), rhs->copy());
+string RexBinaryOp::buildString() const {
+    return "(" + lhs->to_string() + op + rhs->to_string() + ")";
 }
 
-string RexBinaryOp::getTopID() {
+string RexBinaryOp::getTopID() const {
     if (op == "&&") {
         return "AND" + std::to_string(pUID);
     } else if (op == "||") {
@@ -163,23 +154,15 @@ string RexBinaryOp::getTopID() {
     return "ARBOP" + std::to_string(pUID);
 }
 
-bool RexBinaryOp::containsCfgVar() {
-    return lhs->containsCfgVar() || \
-           rhs->containsCfgVar();
-}
 
-bool RexBinaryOp::equivalent(RexCond *node) {
-    RexBinaryOp *other = dynamic_cast<RexBinaryOp*>(node);
-    if (!other) return false;
-    if (op != other->op) return false;
-    return lhs->equivalent(other->lhs) && rhs->equivalent(other->rhs);
-}
+RexCondAtom::RexCondAtom(string name, bool isCfg) :
+    RexCond{combineHash(3, std::hash<string>{}(name)), isCfg}, name{name} {}
 
+const RexCond *RexCondAtom::makeAtom(Expr *e, bool isCfg) {
+    return intern(new RexCondAtom(atomName(e), isCfg));
+}
 
-RexCondAtom::RexCondAtom(Expr *e,const VariabilityOptions &vOpts) :
-    expr{e}, vOpts{vOpts} {}
-
-string RexCondAtom::to_string() {
+string RexCondAtom::atomName(Expr *expr) {
     if (auto ref = dyn_cast<DeclRefExpr>(expr)) {
         return ref->getFoundDecl()->getNameAsString();
     } else if (auto ref = dyn_cast<IntegerLiteral>(expr)) {
@@ -206,58 +189,39 @@ string RexCondAtom::to_string() {
     return "Error: UNKNOWN";
 }
 
-bool RexCondAtom::equivalent(RexCond *node) {
-    RexCondAtom *other = dynamic_cast<RexCondAtom*>(node);
-    if (!other) return false;
-    if (auto self = dyn_cast<DeclRefExpr>(expr)) {
-        auto otherRef = dyn_cast<DeclRefExpr>(other->expr);
-        if (!otherRef) return false;
-        return self->getFoundDecl()->getNameAsString() == \
-               otherRef->getFoundDecl()->getNameAsString();
-    }
-    else if (auto self = dyn_cast<IntegerLiteral>(expr)) {
-        auto otherRef = dyn_cast<IntegerLiteral>(other->expr);
-        if (!otherRef) return false;
-        return self->getValue() == otherRef->getValue();
-    }
-    else if (auto self = dyn_cast<CharacterLiteral>(expr)) {
-        auto otherRef = dyn_cast<CharacterLiteral>(other->expr);
-        if (!otherRef) return false;
-        return self->getValue() == otherRef->getValue();
-    }
-    else if (dyn_cast<MemberExpr>(expr)) {
-        auto otherRef = dyn_cast<MemberExpr>(other->expr);
-        if (!otherRef) return false;
-        return to_string() == other->to_string();
-    }
-    else if (auto self = dyn_cast<FloatingLiteral>(expr)) {
-        auto otherRef = dyn_cast<FloatingLiteral>(other->expr);
-        if (!otherRef) return false;
-        return self->getValue().bitwiseIsEqual(otherRef->getValue());
-    }
-    return false;
+bool RexCondAtom::shallowEquals(const RexCond &node) const {
+    return name == static_cast<const RexCondAtom &>(node).name;
 }
-string RexCondAtom::getTopID() {
+
+string RexCondAtom::buildString() const {
+    return name;
+}
+
+string RexCondAtom::getTopID() const {
     return "ATOM" + std::to_string(pUID);
 }
 
 
-bool RexCondAtom::containsCfgVar() {
+/**
+ * Works out whether an expression is a configuration variable. Only depends on
+ * the declaration referred to, so the answer is remembered per declaration.
+ * @param expr The expression in the condition.
+ * @return Whether the expression refers to a configuration variable.
+ */
+bool CondScope::isCfgVar(Expr *expr) {
     DeclRefExpr *ref = dyn_cast<DeclRefExpr>(expr);
     if (!ref) return false;
+    const NamedDecl *found = ref->getFoundDecl();
+    auto known = cfgVars.find(found);
+    if (known != cfgVars.end()) {
+        return known->second;
+    }
+
+    bool isCfg = false;
     VarDecl* v = dyn_cast<VarDecl>(ref->getDecl());
-    if (!v)  return false;
-    QualType t = v->getType();
-    const clang::Type * tp = t.getTypePtr();
-    if (!tp) return false;
-    bool isCfg = vOpts.allVariables() || vOpts.extractAll;
-
-    // For some reason using the regex stored in vOpts constructed
-    // in CondScope's constructor didn't work, so have to create a new
-    // regex object each time.
-    regex r{vOpts.nameMatch};
-
-    isCfg = isCfg ||
+    const clang::Type *tp = v ? v->getType().getTypePtr() : nullptr;
+    if (tp) {
+        isCfg = vOpts.allVariables() || vOpts.extractAll ||
             ((v->hasGlobalStorage() || !vOpts.globalsOnly)
             && \
             (!v->hasGlobalStorage() || !vOpts.nonglobalsOnly)
@@ -268,108 +232,96 @@ bool RexCondAtom::containsCfgVar() {
              (tp->isCharType() && vOpts.chars) ||
              (tp->isIntegerType() && vOpts.ints)))
             && \
-            ((vOpts.nameMatch == "") ||
-             (regex_search(to_string(), r))));
+            ((cfgVarPattern.empty()) ||
+             (cfgVarPattern.matches(found->getNameAsString()))));
+    }
+    cfgVars.emplace(found, isCfg);
     return isCfg;
+}
+
+RexTrue::RexTrue() : RexCond{4, false} {}
 
+const RexCond *RexTrue::makeTrue() {
+    return intern(new RexTrue);
 }
 
-RexCond *RexCondAtom::copy() {
-    return new RexCondAtom(expr, vOpts);
+bool RexTrue::shallowEquals(const RexCond &) const {
+    return true;
 }
 
-string RexTrue::to_string() {
+string RexTrue::buildString() const {
     return "true";
 }
 
-string RexTrue::getTopID() {
+string RexTrue::getTopID() const {
     return "TRUE" + std::to_string(pUID);
 }
 
-RexCond *RexTrue::copy() {
-    return new RexTrue;
-}
-
-bool RexTrue::containsCfgVar() {
-    return false;
-}
+RexCondParen::RexCondParen(const RexCond *c) : RexCond{combineHash(5, c->getHash()), c->containsCfgVar()}, child{c} {}
 
-bool RexTrue::equivalent(RexCond *other) {
-    return dynamic_cast<RexTrue*>(other);
+const RexCond *RexCondParen::makeParen(const RexCond *c) {
+    if (!c) return RexTrue::makeTrue();
+    return intern(new RexCondParen(c));
 }
 
-RexCondParen::RexCondParen(RexCond *c) : child{c} {}
-
-string RexCondParen::to_string() {
+string RexCondParen::buildString() const {
     return "(" + child->to_string() + ")";
 }
 
-string RexCondParen::getTopID() {
+string RexCondParen::getTopID() const {
     return child->getTopID();
 }
 
-RexCond *RexCondParen::copy() {
-    return new RexCondParen(child->copy());
+bool RexCondParen::shallowEquals(const RexCond &node) const {
+    return child == static_cast<const RexCondParen &>(node).child;
 }
 
-bool RexCondParen::containsCfgVar() {
-    return child->containsCfgVar();
-}
-
-RexCondParen::~RexCondParen() { delete child; }
 
-bool RexCondParen::equivalent(RexCond *node) {
-    RexCondParen *other = dynamic_cast<RexCondParen*>(node);
-    if (!other) return false;
-    return child->equivalent(other->child);
-}
-
-
-CondScope::CondScope(clang::ASTContext *context, VariabilityOptions vOpts) : vOpts{vOpts}, context{context} {}
+CondScope::CondScope(clang::ASTContext *context, VariabilityOptions vOpts) :
+    vOpts{vOpts}, cfgVarPattern{vOpts.nameMatch, NamePattern::SEARCH}, context{context},
+    cachedConjunction{nullptr}, conjunctionValid{false} {}
 
 /**
  * Takes a Expr* which is part of a condition and makes the corresponding
  * rex cond.
  * @param stmt The conditional statement.
- * @return Heap allocated RexCond* if we care about it, otherwise nullptr
+ * @return The shared RexCond if we care about it, otherwise nullptr
  */
-RexCond *CondScope::makeRexCond(Expr *cond) {
+const RexCond *CondScope::makeRexCond(Expr *cond) {
     //Expr *original = cond;
     cond = cond->IgnoreImplicit()->IgnoreParenImpCasts();
     if (auto binOp = dyn_cast<BinaryOperator>(cond)) {
         string opCode = static_cast<string>(binOp->getOpcodeStr());
-        RexCond *lhs = makeRexCond(binOp->getLHS());
-        RexCond *rhs = makeRexCond(binOp->getRHS());
+        const RexCond *lhs = makeRexCond(binOp->getLHS());
+        const RexCond *rhs = makeRexCond(binOp->getRHS());
         if (!lhs || !rhs) {
-            delete lhs;
-            delete rhs;
             return nullptr;
         }
         return RexBinaryOp::makeBinaryOp(opCode, lhs, rhs);
     } else if (auto unOp = dyn_cast<UnaryOperator>(cond)) {
         string opCode = static_cast<string>(UnaryOperator::getOpcodeStr(unOp->getOpcode()));
-        RexCond *child = makeRexCond(unOp->getSubExpr());
+        const RexCond *child = makeRexCond(unOp->getSubExpr());
         if (!child) return nullptr;
         return RexUnaryOp::makeUnaryOp(opCode, child);
     } else if (auto ref = dyn_cast<ParenExpr>(cond)) {
-        RexCond *child = makeRexCond(ref->getSubExpr());
+        const RexCond *child = makeRexCond(ref->getSubExpr());
         if (!child) return nullptr;
-        return new RexCondParen(child);
+        return RexCondParen::makeParen(child);
     } else if (auto ref = dyn_cast<ArraySubscriptExpr>(cond)) {
         // For now only care about which array is read, not the index
         return makeRexCond(ref->getBase());
     } else if (auto ref = dyn_cast<DeclRefExpr>(cond)) {
-        return new RexCondAtom(ref, vOpts);
+        return RexCondAtom::makeAtom(ref, isCfgVar(ref));
     } else if (auto ref = dyn_cast<AtomicExpr>(cond)) {
-        return new RexCondAtom(ref, vOpts);
+        return RexCondAtom::makeAtom(ref, isCfgVar(ref));
     } else if (auto ref = dyn_cast<IntegerLiteral>(cond)) {
-        return new RexCondAtom(ref, vOpts);
+        return RexCondAtom::makeAtom(ref, isCfgVar(ref));
     } else if (auto ref = dyn_cast<CastExpr>(cond)) {
         return makeRexCond(ref->getSubExpr());
     } else if (auto ref = dyn_cast<CharacterLiteral>(cond)) {
-        return new RexCondAtom(ref, vOpts);
+        return RexCondAtom::makeAtom(ref, isCfgVar(ref));
     } else if (auto ref = dyn_cast<MemberExpr>(cond)) {
-        return new RexCondAtom(ref, vOpts);
+        return RexCondAtom::makeAtom(ref, isCfgVar(ref));
     } else if (auto ref = dyn_cast<CastExpr>(cond)) {
         return makeRexCond(ref->getSubExprAsWritten());
     } else if (auto ref = dyn_cast<ConstantExpr>(cond)) {
@@ -377,11 +329,11 @@ RexCond *CondScope::makeRexCond(Expr *cond) {
     } else if (auto ref = dyn_cast<CallExpr>(cond)) {
         // cerr << "Found a callRef" << endl;
         // Probably not the right thing to do. WOrk on this
-        vector<RexCond*> args;
+        vector<const RexCond*> args;
         for (auto it = ref->arg_begin(); it != ref->arg_end(); ++it) {
             args.emplace_back(makeRexCond(*it));
         }
-        return makeFnCall(ref, args, vOpts);
+        return RexFnCall::makeFnCall(ref, args, vOpts);
     /*} else if (auto ref = dyn_cast<OpaqueValueExpr>(cond)) {
         cerr << "Found opaque Vlaue expr" << endl;
         raw_os_ostream os{cerr};
@@ -392,14 +344,14 @@ RexCond *CondScope::makeRexCond(Expr *cond) {
         original->getExprLoc().print(os, context->getSourceManager());
         return nullptr;*/
     } else if (auto ref = dyn_cast<FloatingLiteral>(cond)) {
-        return new RexCondAtom(ref, vOpts);
+        return RexCondAtom::makeAtom(ref, isCfgVar(ref));
     } else if (auto ref = dyn_cast<ParenExpr>(cond)) {
         return makeRexCond(ref->getSubExpr());
     } else if (auto ref = dyn_cast<ConditionalOperator>(cond)) {
-        return new RexTernary{makeRexCond(ref->getCond()), makeRexCond(ref->getTrueExpr()), makeRexCond(ref->getFalseExpr()), vOpts};
+        return RexTernary::makeTernary(makeRexCond(ref->getCond()), makeRexCond(ref->getTrueExpr()), makeRexCond(ref->getFalseExpr()));
     } else if (auto ref = dyn_cast<CStyleCastExpr>(cond)) {
         string castKind{ref->getCastKindName()};
-        return makeUnaryOp("(" + castKind +")", makeRexCond(ref->getSubExpr()));
+        return RexUnaryOp::makeUnaryOp("(" + castKind +")", makeRexCond(ref->getSubExpr()));
 
     }
     // Maybe  ImplicitCastExpr
@@ -438,39 +390,39 @@ Expr *getCond(Stmt *s) {
 void CondScope::push(Stmt *s) {
     if (!s) return;
     Expr *cond = getCond(s);
-    RexCond *rCond = nullptr;
+    const RexCond *rCond = nullptr;
     if (cond) {
         rCond = makeRexCond(cond->IgnoreImplicit()->IgnoreParenImpCasts());
     }
     if (auto cStmt = dyn_cast<CaseStmt>(s)) {
-        RexCond *caseVal = makeRexCond(cStmt->getLHS());
+        const RexCond *caseVal = makeRexCond(cStmt->getLHS());
         rCond = RexBinaryOp::makeBinaryOp("==", makeRexCond(switchVar.back()->getCond()), caseVal);
     }
     if (!rCond) {
-        rCond = new RexTrue;
+        rCond = RexTrue::makeTrue();
     } else {
         for (auto &it : condStack) {
             if (rCond->equivalent(it)) {
-                delete rCond;
-                rCond = new RexTrue;
+                rCond = RexTrue::makeTrue();
                 break;
             }
         }
     }
     condStack.emplace_back(rCond);
+    conjunctionValid = false;
 }
 
 void CondScope::push(SwitchStmt* s) {
     if (!s) return;
     // switch.getCond() is the actual switch var
     switchVar.emplace_back(s);
-    caseStack.emplace_back(vector<RexCond*>());
+    caseStack.emplace_back(vector<const RexCond*>());
 }
 
 
 void CondScope::push(CaseStmt* s) {
     if (!s) return;
-    RexCond *caseVal = makeRexCond(s->getLHS());
+    const RexCond *caseVal = makeRexCond(s->getLHS());
     if (!caseVal) {
         cout << s->getLHS() << " type was not found" << endl;
         cout << "type is: " << s->getLHS()->getStmtClassName() << endl;
@@ -478,32 +430,35 @@ void CondScope::push(CaseStmt* s) {
             cout << ref->getSubExpr()->getStmtClassName() << endl;
         }
     }
-    RexCond *caseEq = RexBinaryOp::makeBinaryOp("==", makeRexCond(switchVar.back()->getCond()), caseVal);
+    const RexCond *caseEq = RexBinaryOp::makeBinaryOp("==", makeRexCond(switchVar.back()->getCond()), caseVal);
     caseStack.back().emplace_back(caseEq);
+    conjunctionValid = false;
 }
 
 void CondScope::push(IfStmt* s) {
     if (!s) return;
-    RexCond* p = makeRexCond(s->getCond());
-    ifStack.emplace_back(p ? p : new RexTrue);
+    const RexCond* p = makeRexCond(s->getCond());
+    ifStack.emplace_back(p ? p : RexTrue::makeTrue());
+    conjunctionValid = false;
 }
 
 void CondScope::negate_top(IfStmt* s) {
     if (!s) return;
     ifStack.back() = RexUnaryOp::makeUnaryOp("!", ifStack.back());
+    conjunctionValid = false;
 }
 
 void CondScope::pop(SwitchStmt* s) {
     if (!s) return;
     switchVar.pop_back();
-    for (auto cond : caseStack.back()) delete cond;
     caseStack.pop_back();
+    conjunctionValid = false;
 }
 
 void CondScope::pop(clang::IfStmt* s) {
     if (!s) return;
-    delete ifStack.back();
     ifStack.pop_back();
+    conjunctionValid = false;
 }
 
 void CondScope::pop(Stmt* s) {
@@ -513,72 +468,67 @@ void CondScope::pop(Stmt* s) {
 
 void CondScope::pop(CaseStmt* s) {
     if (!s) return;
-    delete caseStack.back().back();
     caseStack.back().pop_back();
+    conjunctionValid = false;
 }
 
 void CondScope::pop() {
-    delete condStack.back();
     condStack.pop_back();
+    conjunctionValid = false;
 }
 
-CondScope::~CondScope() {
-    for (auto &it : condStack) {
-        delete it;
-    }
-}
-
-RexCond *CondScope::disjunction(std::vector<RexCond*> v) {
+const RexCond *CondScope::disjunction(const std::vector<const RexCond*> &v) {
     if (v.size() == 0) return nullptr;
-    if (v.size() == 1) return v.at(0)->copy();
+    if (v.size() == 1) return v.at(0);
     auto it = v.begin();
-    RexCond *dj = RexBinaryOp::makeBinaryOp("||", (*it)->copy(), (*(it + 1))->copy());
+    const RexCond *dj = RexBinaryOp::makeBinaryOp("||", *it, *(it + 1));
     for (it += 2; it != v.end(); ++it) {
-        dj = RexBinaryOp::makeBinaryOp("||", dj, (*it)->copy());
+        dj = RexBinaryOp::makeBinaryOp("||", dj, *it);
     }
     return dj;
 }
 
 /**
  * Creates a RexCond that is the conjunction of the current stack.
- * @return a heap allocated RexCond that represents the current
- * conjunction of the entire stack. Caller now owns that memory.
+ * @return the shared RexCond that represents the current conjunction of the
+ * entire stack, or nullptr if nothing on it involves a configuration variable.
  */
-RexCond *CondScope::conjunction() {
-    vector<RexCond*> total;
+const RexCond *CondScope::conjunction() {
+    if (conjunctionValid) {
+        return cachedConjunction;
+    }
+
+    vector<const RexCond*> total;
     total.insert(total.end(), condStack.begin(), condStack.end());
     total.insert(total.end(), ifStack.begin(), ifStack.end());
-    vector<RexCond*> cases;
-    for (auto vec : caseStack) {
-        RexCond * dj = disjunction(vec);
+    for (const auto &vec : caseStack) {
+        const RexCond *dj = disjunction(vec);
         if (dj) {
-            cases.emplace_back(dj);
             total.emplace_back(dj);
         }
     }
-    if (!total.size()) return nullptr;
-    auto it = total.begin();
-    while (it != total.end() && !((*it)->containsCfgVar())) {
-        ++it;
-    }
-    if (it == total.end()) {
-        for (auto ptr : cases) delete ptr;
-        return nullptr;
-    }
-    RexCond *ret = (*it)->copy();
-    ++it;
-    for (;it != total.end(); ++it) {
+
+    const RexCond *ret = nullptr;
+    for (const RexCond *cond : total) {
         // Don't bother concatenating a bunch of trues.
-        if (!((*it)->containsCfgVar())) continue;
-        ret = RexBinaryOp::makeBinaryOp("&&", ret, (*it)->copy());
+        if (!cond->containsCfgVar()) continue;
+        ret = ret ? RexBinaryOp::makeBinaryOp("&&", ret, cond) : cond;
     }
-    for (auto ptr : cases) delete ptr;
+    if (ret && CondBDD::isEnabled()) {
+        ret = CondBDD::simplify(ret);
+        // A condition that always holds is no condition
+        if (ret == RexTrue::makeTrue()) ret = nullptr;
+    }
+
+    cachedConjunction = ret;
+    conjunctionValid = true;
     return ret;
 }
 
 
-
-RexFnCall::RexFnCall(clang::CallExpr *expr, vector<RexCond *> args, const VariabilityOptions &vOpts) : args{args}, vOpts{vOpts} {
+// Works out the name that a call prints as
+string RexFnCall::calleeName(clang::CallExpr *expr) {
+    string fnName;
     // Doing stuff out here for now maybe need to move in to these ifs.
     if (auto ref = dyn_cast<CXXOperatorCallExpr>(expr)) {
         // TODO
@@ -605,15 +555,37 @@ RexFnCall::RexFnCall(clang::CallExpr *expr, vector<RexCond *> args, const Variab
             fnName = decl->getNameInfo().getName().getAsString();
         }
     }
+    return fnName;
 }
 
-RexFnCall::RexFnCall(string fnName, vector<RexCond *> args, const VariabilityOptions &vOpts) : args{args}, vOpts{vOpts}, fnName{fnName} {}
+static size_t hashFnCall(const string &fnName, const vector<const RexCond *> &args) {
+    size_t h = std::hash<string>{}(fnName);
+    for (const RexCond *arg : args) {
+        h ^= arg->getHash() + 0x9e3779b9 + (h << 6) + (h >> 2);
+    }
+    return h;
+}
 
-RexFnCall::~RexFnCall() {
-    for (auto &p : args) delete p;
+static bool anyCfgVar(const vector<const RexCond *> &args) {
+    for (const RexCond *arg : args) {
+        if (arg->containsCfgVar()) return true;
+    }
+    return false;
 }
 
-string RexFnCall::to_string() {
+RexFnCall::RexFnCall(string fnName, vector<const RexCond *> args, bool extractAll) :
+    RexCond{combineHash(6, hashFnCall(fnName, args)), extractAll || anyCfgVar(args)},
+    args{args}, fnName{fnName} {}
+
+const RexCond *RexFnCall::makeFnCall(clang::CallExpr *expr, std::vector<const RexCond *> args, const VariabilityOptions &vOpts) {
+    if (!expr) return RexTrue::makeTrue();
+    for (auto &p : args) {
+        if (!p) return RexTrue::makeTrue();
+    }
+    return intern(new RexFnCall{calleeName(expr), args, vOpts.extractAll});
+}
+
+string RexFnCall::buildString() const {
     string ret = fnName + "(";
     auto it = args.begin();
     string prefix = "";
@@ -627,64 +599,37 @@ string RexFnCall::to_string() {
     return ret;
 }
 
-RexCond *RexFnCall::copy() {
-    std::vector<RexCond *> argCopy;
-    for (auto &p : args) {
-        argCopy.emplace_back(p->copy());
-    }
-    return new RexFnCall(fnName, argCopy, vOpts);
-}
-
-std::string RexFnCall::getTopID() {
+std::string RexFnCall::getTopID() const {
     return "FNCALL" + std::to_string(pUID);
 }
 
-bool RexFnCall::containsCfgVar() {
-    bool b = vOpts.extractAll;
-    for (auto &p : args) {
-        b = b || p->containsCfgVar();
-    }
-    return b;
-}
-
-bool RexFnCall::equivalent(RexCond *c) {
-    RexFnCall *p = dynamic_cast<RexFnCall*>(c);
-    if (!p) return false;
-    if (fnName != p->fnName) return false;
-    if (args.size() != p->args.size()) return false;
-    for (size_t i = 0; i < args.size(); ++i) {
-        if (!args[i]->equivalent(p->args[i])) return false;
-    }
-    return true;
+bool RexFnCall::shallowEquals(const RexCond &node) const {
+    const RexFnCall &other = static_cast<const RexFnCall &>(node);
+    return fnName == other.fnName && args == other.args;
 }
 
-RexTernary::RexTernary(RexCond *ifC, RexCond *thenC, RexCond *elseC, const VariabilityOptions &vOpts) : ifC{ifC}, thenC{thenC}, elseC{elseC}, vOpts{vOpts} {}
+RexTernary::RexTernary(const RexCond *ifC, const RexCond *thenC, const RexCond *elseC) :
+    RexCond{combineHash(combineHash(combineHash(7, ifC->getHash()), thenC->getHash()), elseC->getHash()),
+            ifC->containsCfgVar() || elseC->containsCfgVar() || thenC->containsCfgVar()},
+    ifC{ifC}, thenC{thenC}, elseC{elseC} {}
 
-RexTernary::~RexTernary() {
-    delete ifC; delete elseC; delete thenC;
+const RexCond *RexTernary::makeTernary(const RexCond *ifC, const RexCond *thenC, const RexCond *elseC) {
+    if (!ifC || !thenC || !elseC) return RexTrue::makeTrue();
+    return intern(new RexTernary{ifC, thenC, elseC});
 }
 
-std::string RexTernary::to_string() {
+std::string RexTernary::buildString() const {
     // Currently implemented to just produce the then, because for now that's quickest and cleanest solution for readable conds.
     // In the future when conds are actually printing out, having an internal Ternary should actually change the parents behaviour but
     // thats for another time.
     return thenC->to_string();
 }
 
-RexCond *RexTernary::copy() {
-    return new RexTernary{ifC->copy(), thenC->copy(), elseC->copy(), vOpts};
-}
-
-std::string RexTernary::getTopID() {
+std::string RexTernary::getTopID() const {
     return "TERNARY" + std::to_string(pUID);
 }
 
-bool RexTernary::containsCfgVar() {
-    return ifC->containsCfgVar() || elseC->containsCfgVar() || thenC->containsCfgVar();
-}
-
-bool RexTernary::equivalent(RexCond *c) {
-    RexTernary *other = dynamic_cast<RexTernary*>(c);
-    if (!other) return false;
-    return ifC->equivalent(other->ifC) && thenC->equivalent(other->thenC) && elseC->equivalent(other->elseC);
+bool RexTernary::shallowEquals(const RexCond &node) const {
+    const RexTernary &other = static_cast<const RexTernary &>(node);
+    return ifC == other.ifC && thenC == other.thenC && elseC == other.elseC;
 }
@@ -32,137 +32,161 @@
 #include <string>
 #include "../Driver/RexArgs.h"
 #include "clang/AST/Expr.h"
-#include <regex>
+#include <cstddef>
+#include <unordered_map>
+#include "../Driver/NamePattern.h"
 
+// Conditions are hash-consed: every RexCond is immutable and created through
+// its class's factory, which returns the one shared node for that structure.
+// Equal conditions are therefore the same pointer, so facts only store a
+// handle and comparing conditions is a pointer comparison. Nodes live until
+// the process exits (one translation unit per process).
 class RexCond {
 protected:
     static unsigned long UID;
     unsigned long pUID;
+    // Structural hash: the type, the operator/name and the child pointers
+    std::size_t hash;
+    // Whether a configuration variable appears anywhere in this condition
+    bool cfgVar;
+    // Built on the first to_string() call
+    mutable std::string text;
+    mutable bool hasText;
+
+    RexCond(std::size_t hash, bool cfgVar);
+    // Compares the fields of two nodes of the same type. Children are
+    // compared by pointer since they have already been interned.
+    virtual bool shallowEquals(const RexCond &other) const = 0;
+    virtual std::string buildString() const = 0;
+    // Returns the shared node equal to `cond`, taking ownership of `cond`
+    static const RexCond *intern(RexCond *cond);
+    static std::size_t combineHash(std::size_t seed, std::size_t value);
+
 public:
-    RexCond();
     virtual ~RexCond();
-    virtual std::string to_string() = 0;
-    virtual RexCond *copy() = 0;
-    virtual std::string getTopID() = 0;
-    virtual bool equivalent(RexCond *) = 0;
-    virtual bool containsCfgVar() = 0;
+    const std::string &to_string() const;
+    virtual std::string getTopID() const = 0;
+    bool equivalent(const RexCond *other) const { return this == other; }
+    bool containsCfgVar() const { return cfgVar; }
+    std::size_t getHash() const { return hash; }
     static unsigned long getUID();
+
+    struct Hash {
+        std::size_t operator()(const RexCond *cond) const { return cond->hash; }
+    };
+    struct Equal {
+        bool operator()(const RexCond *a, const RexCond *b) const;
+    };
 };
 
 class RexUnaryOp : public RexCond {
-    RexCond *child;
+    const RexCond *child;
     std::string op;
-    RexUnaryOp(std::string, RexCond *);
+    RexUnaryOp(std::string, const RexCond *);
+    bool shallowEquals(const RexCond &other) const override;
+    std::string buildString() const override;
 public:
-    static RexCond* makeUnaryOp(std::string, RexCond *);
-    virtual ~RexUnaryOp();
-    std::string to_string() override;
-    RexCond *copy() override;
-    std::string getTopID() override;
-    bool containsCfgVar() override;
-    bool equivalent(RexCond *) override;
+    static const RexCond *makeUnaryOp(std::string, const RexCond *);
+    std::string getTopID() const override;
+    const std::string &getOp() const { return op; }
+    const RexCond *getChild() const { return child; }
 };
 
 class RexBinaryOp : public RexCond {
-    RexCond *lhs;
-    RexCond *rhs;
+    const RexCond *lhs;
+    const RexCond *rhs;
     std::string op;
     // Constructor has been made private so that these can only
     // be constructed through the factory.
-    RexBinaryOp(std::string, RexCond *, RexCond *);
+    RexBinaryOp(std::string, const RexCond *, const RexCond *);
+    bool shallowEquals(const RexCond &other) const override;
+    std::string buildString() const override;
 public:
     // Factory for creating BinaryOps. Could give a RexTrue or RexBinaryOp pointer.
-    static RexCond *makeBinaryOp(std::string, RexCond *, RexCond *);
-
-    virtual ~RexBinaryOp();
-    std::string to_string() override;
-    RexCond *copy() override;
-    std::string getTopID() override;
-    bool containsCfgVar() override;
-    bool equivalent(RexCond *) override;
+    static const RexCond *makeBinaryOp(std::string, const RexCond *, const RexCond *);
+    std::string getTopID() const override;
+    const std::string &getOp() const { return op; }
+    const RexCond *getLHS() const { return lhs; }
+    const RexCond *getRHS() const { return rhs; }
 };
 
+// Atoms are identified by how they print, which is all the old equivalence
+// check looked at, plus whether they are a configuration variable.
 class RexCondAtom : public RexCond {
-    clang::Expr *expr;
-    const VariabilityOptions &vOpts;
+    std::string name;
+    RexCondAtom(std::string name, bool isCfg);
+    bool shallowEquals(const RexCond &other) const override;
+    std::string buildString() const override;
+    static std::string atomName(clang::Expr *);
 public:
-    RexCondAtom(clang::Expr *, const VariabilityOptions &vOpts);
-    std::string to_string() override;
-    RexCond *copy() override;
-    std::string getTopID() override;
-    bool containsCfgVar() override;
-    bool equivalent(RexCond *) override;
+    static const RexCond *makeAtom(clang::Expr *, bool isCfg);
+    std::string getTopID() const override;
 };
 
 class RexCondParen : public RexCond {
-    RexCond *child;
+    const RexCond *child;
+    RexCondParen(const RexCond *);
+    bool shallowEquals(const RexCond &other) const override;
+    std::string buildString() const override;
 public:
-    RexCondParen(RexCond *);
-    ~RexCondParen();
-    std::string to_string() override;
-    RexCond *copy() override;
-    std::string getTopID() override;
-    bool containsCfgVar() override;
-    bool equivalent(RexCond *) override;
+    static const RexCond *makeParen(const RexCond *);
+    std::string getTopID() const override;
+    const RexCond *getChild() const { return child; }
 };
 
 class RexTrue : public RexCond {
+    RexTrue();
+    bool shallowEquals(const RexCond &other) const override;
+    std::string buildString() const override;
 public:
-    std::string to_string() override;
-    RexCond *copy() override;
-    std::string getTopID() override;
-    bool containsCfgVar() override;
-    bool equivalent(RexCond *) override;
+    static const RexCond *makeTrue();
+    std::string getTopID() const override;
 };
 
 class RexFnCall : public RexCond {
-    std::vector<RexCond *> args;
-    const VariabilityOptions &vOpts;
+    std::vector<const RexCond *> args;
     std::string fnName;
-    RexFnCall(std::string fnName, std::vector<RexCond *> args, const VariabilityOptions &vOpts);
-    RexFnCall(clang::CallExpr *, std::vector<RexCond *> args, const VariabilityOptions &vOpts);
+    RexFnCall(std::string fnName, std::vector<const RexCond *> args, bool extractAll);
+    bool shallowEquals(const RexCond &other) const override;
+    std::string buildString() const override;
+    static std::string calleeName(clang::CallExpr *);
   public:
-    static RexCond *makeFnCall(clang::CallExpr *expr, std::vector<RexCond *> args, const VariabilityOptions &vOpts) {
-        if (!expr) return new RexTrue;
-        for (auto &p : args) {
-            if (!p) return new RexTrue;
-        }
-        return new RexFnCall{expr,args,vOpts};
-    }
-    ~RexFnCall();
-    std::string to_string() override;
-    RexCond *copy() override;
-    std::string getTopID() override;
-    bool containsCfgVar() override;
-    bool equivalent(RexCond *) override;
+    static const RexCond *makeFnCall(clang::CallExpr *expr, std::vector<const RexCond *> args, const VariabilityOptions &vOpts);
+    std::string getTopID() const override;
 };
 
 class RexTernary : public RexCond {
-    RexCond *ifC, *thenC, *elseC;
-    const VariabilityOptions &vOpts;
+    const RexCond *ifC, *thenC, *elseC;
+    RexTernary(const RexCond *ifC, const RexCond *thenC, const RexCond *elseC);
+    bool shallowEquals(const RexCond &other) const override;
+    std::string buildString() const override;
   public:
-    RexTernary(RexCond *ifC, RexCond *thenC, RexCond *elseC, const VariabilityOptions &vOpts);
-    ~RexTernary();
-    std::string to_string() override;
-    RexCond *copy() override;
-    std::string getTopID() override;
-    bool containsCfgVar() override;
-    bool equivalent(RexCond *) override;
+    static const RexCond *makeTernary(const RexCond *ifC, const RexCond *thenC, const RexCond *elseC);
+    std::string getTopID() const override;
 };
 
 class CondScope {
-    std::vector<RexCond*> condStack;
-    std::vector<RexCond*> ifStack;
-    std::vector<std::vector<RexCond*> > caseStack;
+    std::vector<const RexCond*> condStack;
+    std::vector<const RexCond*> ifStack;
+    std::vector<std::vector<const RexCond*> > caseStack;
     std::vector<clang::SwitchStmt*> switchVar;
-    RexCond *makeRexCond(clang::Expr *cond);
-    RexCond *disjunction(std::vector<RexCond*>);
+    const RexCond *makeRexCond(clang::Expr *cond);
+    const RexCond *disjunction(const std::vector<const RexCond*> &);
 
     VariabilityOptions vOpts;
-    std::regex cfgVarRegex;
+    NamePattern cfgVarPattern;
+    // Whether each declaration referred to in a condition is a
+    // configuration variable
+    std::unordered_map<const clang::NamedDecl *, bool> cfgVars;
+    bool isCfgVar(clang::Expr *);
 
     clang::ASTContext *context;
 
+    // The conjunction only changes when the stacks do, and it is asked for
+    // on every fact
+    const RexCond *cachedConjunction;
+    bool conjunctionValid;
+
 public:
     void push(clang::Stmt* s);
     void push(clang::SwitchStmt*);
@@ -174,9 +198,8 @@ public:
     void pop(clang::SwitchStmt*);
     void pop(clang::IfStmt*);
     void pop(clang::CaseStmt*);
-    RexCond *conjunction();
+    const RexCond *conjunction();
     CondScope(clang::ASTContext *context, VariabilityOptions vOpts = VariabilityOptions{});
-    ~CondScope();
     //rexCond peek();
     // rexCond fullCond();
 };
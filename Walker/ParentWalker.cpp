@@ -697,9 +697,12 @@ ParentWalker::ParentWalker(const WalkerConfig &config, ASTContext *Context):
     featureName{config.featureName},
     langFeats{config.lFeats},
     buildCFG{config.buildCFG},
+    pruneIgnored{config.pruneIgnored},
     ROSFeats{config.ROSFeats},
-    callbackFuncRegex{regex{config.geOpts.callbackFuncRegex}},
-    Context(Context) {}
+    callbackFuncPattern{config.geOpts.callbackFuncRegex, NamePattern::FULL_MATCH},
+    Context(Context),
+    idLookups{0},
+    idCacheHits{0} {}
 
 
 /**
@@ -707,6 +710,12 @@ ParentWalker::ParentWalker(const WalkerConfig &config, ASTContext *Context):
  */
 ParentWalker::~ParentWalker() {}
 
+void ParentWalker::reportTelemetry(JobTelemetry &telemetry) const {
+    BaselineWalker::reportTelemetry(telemetry);
+    telemetry.numIDLookups += idLookups;
+    telemetry.numIDCacheHits += idCacheHits;
+}
+
 
 /**
  * Records a basic struct/union/class declaration in the TA model.
@@ -725,7 +734,7 @@ void ParentWalker::recordCXXRecordDecl(const CXXRecordDecl *decl, RexNode::NodeT
         // Creates the node.
         if (!graph.hasNode(id)) {
             RexNode *node = new RexNode(id, type, isInMainFile(decl));
-            node->addSingleAttribute(TASchemeAttribute::LABEL, name);
+            node->addSingleAttribute(RexAttribute::LABEL, name);
             // Resolves the filename.
             recordNamedDeclLocation(decl, node);
             addNodeToGraph(node);
@@ -749,8 +758,8 @@ void ParentWalker::recordEnumDecl(const EnumDecl* decl){
 
         //Creates the node.
         RexNode* node = new RexNode(id, RexNode::ENUM, isInMainFile(decl));
-        node->addSingleAttribute(TASchemeAttribute::LABEL, name);
-        node->addSingleAttribute(TASchemeAttribute::IS_CONTROL_FLOW, "0");
+        node->addSingleAttribute(RexAttribute::LABEL, name);
+        node->addSingleAttribute(RexAttribute::IS_CONTROL_FLOW, "0");
         recordNamedDeclLocation(decl, node);
         addNodeToGraph(node);
 
@@ -772,8 +781,8 @@ void ParentWalker::recordFieldDecl(const FieldDecl *decl) {
 
         // Creates the node.
         RexNode *node = specializedVariableNode(decl, isInMainFile(decl));
-        node->addSingleAttribute(TASchemeAttribute::LABEL, name);
-        node->addSingleAttribute(TASchemeAttribute::IS_CONTROL_FLOW, "0");
+        node->addSingleAttribute(RexAttribute::LABEL, name);
+        node->addSingleAttribute(RexAttribute::IS_CONTROL_FLOW, "0");
         recordNamedDeclLocation(decl, node);
         addNodeToGraph(node);
         // Get the parent.
@@ -792,15 +801,15 @@ void ParentWalker::recordVarDecl(const VarDecl *decl) {
         string name = generateName(decl);
         // Creates the node.
         RexNode *node = specializedVariableNode(decl, isInMainFile(decl));
-        node->addSingleAttribute(TASchemeAttribute::LABEL, name);
-        node->addSingleAttribute(TASchemeAttribute::IS_CONTROL_FLOW, "0");
+        node->addSingleAttribute(RexAttribute::LABEL, name);
+        node->addSingleAttribute(RexAttribute::IS_CONTROL_FLOW, "0");
         if (isa<ParmVarDecl>(decl)) {
-            node->addSingleAttribute(TASchemeAttribute::IS_PARAM, "1");
+            node->addSingleAttribute(RexAttribute::IS_PARAM, "1");
             recordNamedDeclLocation(decl, node);
-            //node->addSingleAttribute(TASchemeAttribute::FILENAME_DEFINITION, 
+            //node->addSingleAttribute(RexAttribute::FILENAME_DEFINITION, 
             //    generateFileName(decl->getDefinition()));
         } else {
-            node->addSingleAttribute(TASchemeAttribute::IS_PARAM, "0");
+            node->addSingleAttribute(RexAttribute::IS_PARAM, "0");
             recordNamedDeclLocation(decl, node);
         }
         
@@ -829,11 +838,11 @@ void ParentWalker::recordFunctionDecl(const FunctionDecl *decl) {
 
         // Creates the node.
         RexNode *node = new RexNode(id, RexNode::FUNCTION, isInMainFile(decl));
-        node->addSingleAttribute(TASchemeAttribute::LABEL, name);
+        node->addSingleAttribute(RexAttribute::LABEL, name);
 
         // Record whether the function is a callback.
-        string isCallback = regex_match(decl->getNameAsString(), callbackFuncRegex) ? "1" : "0";
-        node->addSingleAttribute(TASchemeAttribute::ROS_IS_CALLBACK, isCallback);
+        string isCallback = isCallbackFunc(decl) ? "1" : "0";
+        node->addSingleAttribute(RexAttribute::ROS_IS_CALLBACK, isCallback);
 
         // Don't add filename if we cannot determine where body is
         recordNamedDeclLocation(decl, node, decl->doesThisDeclarationHaveABody());
@@ -989,7 +998,7 @@ void ParentWalker::recordCallExpr(const CallExpr *expr, bool isROSFunction) {
 
         addOrUpdateEdge(callerID, calleeID, RexEdge::CALLS);
         /**if (hasNDef)
-            callEdge->addSingleAttribute(TASchemeAttribute::NO_DEF, "1");**/
+            callEdge->addSingleAttribute(RexAttribute::NO_DEF, "1");**/
 
         if ((canBuildCFG()) && (!isROSFunction)) {
             if (cfgModel->hasStmt(expr)) {
@@ -1003,17 +1012,17 @@ void ParentWalker::recordCallExpr(const CallExpr *expr, bool isROSFunction) {
                 
                 RexEdge *invokeEdge =
                 addEdgeIfNotExist(callerCFGID, calleeCFGID, RexEdge::NEXT_CFG_BLOCK);
-                invokeEdge->addSingleAttribute(TASchemeAttribute::CFG_INVOKE, "1");
+                invokeEdge->addSingleAttribute(RexAttribute::CFG_INVOKE, "1");
 
                 // Add edge from exit block of function to the call's block
                 RexEdge *retEdge = 
                 addEdgeIfNotExist(generateCFGExitBlockID(cDecl), callerCFGID, RexEdge::NEXT_CFG_BLOCK);
-                retEdge->addSingleAttribute(TASchemeAttribute::CFG_RETURN, "1");
+                retEdge->addSingleAttribute(RexAttribute::CFG_RETURN, "1");
                 
                 
                 /**if (hasNDef) {
-                    retEdge->addSingleAttribute(TASchemeAttribute::NO_DEF, "1");
-                    invokeEdge->addSingleAttribute(TASchemeAttribute::NO_DEF, "1");
+                    retEdge->addSingleAttribute(RexAttribute::NO_DEF, "1");
+                    invokeEdge->addSingleAttribute(RexAttribute::NO_DEF, "1");
                 }**/         
             } else {
                 cerr << "Rex Warning: Could not find a mapping from call expression to CFG block. ";
@@ -1059,41 +1068,41 @@ void ParentWalker::recordASTControl(const Stmt *baseStmt, const RexNode *astItem
     // get id of expression for comparison against condition
     int64_t baseExprID = baseStmt->getID(*Context);
 
-    // Get the parent.
-    auto parent = Context->getParents(*baseStmt);
-    while (!parent.empty()) {
+    // Visit every control structure enclosing the statement.
+    for (const auto &enclosing : getEnclosingControlStmts(baseStmt)) {
+        const Stmt *curStmt = enclosing.first;
 
         // Cast to some control structures.
-        auto curIfStmt = parent[0].get<IfStmt>();
-        if (curIfStmt && isa<IfStmt>(curIfStmt)) {
+        auto curIfStmt = dyn_cast<IfStmt>(curStmt);
+        if (curIfStmt) {
             //cout << "IF" << endl;
             inCond = addVars(curIfStmt, baseExprID, &vars);
             controlStmt = curIfStmt;
             condition = curIfStmt->getCond();
         }
-        auto curForStmt = parent[0].get<ForStmt>();
-        if (curForStmt && isa<ForStmt>(curForStmt)) {
+        auto curForStmt = dyn_cast<ForStmt>(curStmt);
+        if (curForStmt) {
             //cout << "For" << endl;
             inCond = addVars(curForStmt, baseExprID, &vars);
             controlStmt = curForStmt;
             condition = curForStmt->getCond();
         }
-        auto curWhileStmt = parent[0].get<WhileStmt>();
-        if (curWhileStmt && isa<WhileStmt>(curWhileStmt)) {
+        auto curWhileStmt = dyn_cast<WhileStmt>(curStmt);
+        if (curWhileStmt) {
             //cout << "While" << endl;
             inCond = addVars(curWhileStmt, baseExprID, &vars);
             controlStmt = curWhileStmt;
             condition = curWhileStmt->getCond();
         }
-        auto curDoStmt = parent[0].get<DoStmt>();
-        if (curDoStmt && isa<DoStmt>(curDoStmt)) {
+        auto curDoStmt = dyn_cast<DoStmt>(curStmt);
+        if (curDoStmt) {
             //cout << "Do" << endl;
             inCond = addVars(curDoStmt, baseExprID, &vars);
             controlStmt = curDoStmt;
             condition = curDoStmt->getCond();
         }
-        auto curSwitchStmt = parent[0].get<SwitchStmt>();
-        if (curSwitchStmt && isa<SwitchStmt>(curSwitchStmt)) {
+        auto curSwitchStmt = dyn_cast<SwitchStmt>(curStmt);
+        if (curSwitchStmt) {
             //cout << "Switch" << endl;
             inCond = addVars(curSwitchStmt, baseExprID, &vars);
             controlStmt = curSwitchStmt;
@@ -1101,7 +1110,6 @@ void ParentWalker::recordASTControl(const Stmt *baseStmt, const RexNode *astItem
         }
 
         //cout << "Done find vars" << endl;
-        parent = Context->getParents(parent[0]);
 
         // ignore affected variables when:
         //     - no control statement is found
@@ -1212,7 +1220,7 @@ void ParentWalker::recordControlFlow(const ValueDecl *decl) {
         return;
     }
     // Adds 1 to the control flag attr.
-    refNode->addSingleAttribute(TASchemeAttribute::IS_CONTROL_FLOW, "1");
+    refNode->addSingleAttribute(RexAttribute::IS_CONTROL_FLOW, "1");
 }
 
 /**
@@ -1589,6 +1597,10 @@ vector<string> ParentWalker::getArgs(const CallExpr *expr) {
  * @return The function declaration object.
  */
 const FunctionDecl *ParentWalker::getParentFunction(const Stmt *baseFunc) {
+    if (const AncestorIndex::Ancestors *indexed = ancestors.find(baseFunc)) {
+        return indexed->function;
+    }
+
     bool getParent = true;
 
     // Get the parent.
@@ -1695,24 +1707,24 @@ void ParentWalker::recordFunctionVarUsage(const FunctionDecl *decl,
 		//Note it is the same as below - returns now have a line number too. 
                 auto edge = addOrUpdateEdge(rhsItem, var, RexEdge::RET_WRITES);
 //		  auto edge = addOrUpdateEdge(rhsItem, var, RexEdge::RW_DESTINATION);
-  //              edge->RexEdge::addSingleAttribute("LINE_NUMBER", std::to_string(line_number)); //NEW!
+  //              edge->RexEdge::addSingleAttribute(RexAttribute::LINE_NUMBER, std::to_string(line_number)); //NEW!
 
             } else {
                 auto edge = addOrUpdateEdge(rhsItem, var, RexEdge::VAR_WRITES);
   //Incorrect on account of single varWrite fact possibly having multiple CFG blocks; amended to be the source specifically. 
 //		auto edge = addOrUpdateEdge(rhsItem, var, RexEdge::VW_SOURCE);              
                   //addAttribute of extracted line number here 
-//		edge->RexEdge::addSingleAttribute("LINE_NUMBER", std::to_string(line_number));                
+//		edge->RexEdge::addSingleAttribute(RexAttribute::LINE_NUMBER, std::to_string(line_number));                
     //        	llvm::errs() << "Added attribute LINE_NUMBER: " << line_number << " to edge between " << rhsItem << " and " << var << "\n";  // Debugging statement    
         }
 
 
 
-            //edge->addMultiAttribute(TASchemeAttribute::CONTAINING_FUNCTIONS, functionID);
+            //edge->addMultiAttribute(RexAttribute::CONTAINING_FUNCTIONS, functionID);
             if (canBuildCFG()) {
                 if (!cfgNodeID.empty()) {
                     cfgModel->markCFGNodeContainsFact(curDflowStmt);
-                    //edge->addMultiAttribute(TASchemeAttribute::CFG_BLOCKS, cfgNodeID);
+                    //edge->addMultiAttribute(RexAttribute::CFG_BLOCKS, cfgNodeID);
 
                     // Link item to CFG block (source and destination edges)
                     // Differentiate return node write and normal variable write
@@ -1720,11 +1732,11 @@ void ParentWalker::recordFunctionVarUsage(const FunctionDecl *decl,
                         string cfgSrcNodeID = rhsItem.substr(0, rhsItem.size()-RETURN_SUFFIX.size()) + ":CFG:0";
                         auto edge = addOrUpdateEdge(rhsItem, cfgSrcNodeID, RexEdge::RW_SOURCE);
 			edge = addOrUpdateEdge(var, cfgNodeID, RexEdge::RW_DESTINATION);
-			edge->RexEdge::addSingleAttribute("LINE_NUMBER", std::to_string(line_number));
+			edge->RexEdge::addSingleAttribute(RexAttribute::LINE_NUMBER, std::to_string(line_number));
 //                    	addOrUpdateEdge(rhsItem, cfgSrcNodeID, RexEdge::RW_SOURCE);
 		    } else {
                         auto edge = addOrUpdateEdge(rhsItem, cfgNodeID, RexEdge::VW_SOURCE);
-                        edge->RexEdge::addSingleAttribute("LINE_NUMBER", std::to_string(line_number));
+                        edge->RexEdge::addSingleAttribute(RexAttribute::LINE_NUMBER, std::to_string(line_number));
 			addOrUpdateEdge(var, cfgNodeID, RexEdge::VW_DESTINATION);
                     }
                     
@@ -1762,7 +1774,7 @@ void ParentWalker::recordParameterWrite(const FunctionDecl *calledFn,
         addOrUpdateEdge(rhsItem, param, RexEdge::PAR_WRITES);
         //RexEdge *edge = addOrUpdateEdge(rhsItem, param, RexEdge::PAR_WRITES);
         /**if (hasNDef) 
-            edge->addSingleAttribute(TASchemeAttribute::NO_DEF, "1");**/
+            edge->addSingleAttribute(RexAttribute::NO_DEF, "1");**/
 
         // only create the fact if path exist or 
         if (canBuildCFG()) {
@@ -1878,19 +1890,7 @@ bool ParentWalker::isInSystemHeader(const Stmt *statement) {
     if (statement == nullptr)
         return false;
 
-    // Get the system header.
-    bool isIn;
-    try {
-        // Get the source manager.
-        auto &manager = Context->getSourceManager();
-
-        // Check if in header.
-        isIn = isInSystemHeader(manager, statement->getBeginLoc());
-    } catch (...) {
-        return false;
-    }
-
-    return isIn;
+    return isInSystemHeader(Context->getSourceManager(), statement->getBeginLoc());
 }
 
 /**
@@ -1902,19 +1902,7 @@ bool ParentWalker::isInSystemHeader(const Decl *decl) {
     if (decl == nullptr)
         return false;
 
-    // Get the system header.
-    bool isIn;
-    try {
-        // Get the source manager.
-        auto &manager = Context->getSourceManager();
-
-        // Check if in header.
-        isIn = isInSystemHeader(manager, decl->getBeginLoc());
-    } catch (...) {
-        return false;
-    }
-
-    return isIn;
+    return isInSystemHeader(Context->getSourceManager(), decl->getBeginLoc());
 }
 
 std::string ParentWalker::generateRetID(const clang::FunctionDecl *fdecl) {
@@ -1950,14 +1938,44 @@ string ParentWalker::generateCFGEntryBlockID(const FunctionDecl *fdecl)
 }
 string ParentWalker::generateCFGInnerBlockID(const FunctionDecl *fdecl, const CFGBlock* block)
 {
-    return generateID(fdecl, true, (block->getBlockID() != 0)) + ":CFG:" + to_string(block->getBlockID());
+    return generateID(fdecl, (block->getBlockID() != 0)) + ":CFG:" + to_string(block->getBlockID());
 }
 string ParentWalker::generateCFGExitBlockID(const FunctionDecl *fdecl)
 {
-    return generateID(fdecl, true) + ":CFG:0";
+    return generateID(fdecl) + ":CFG:0";
 }
 
 
+/**
+ * Gets the unique ID of a decl, generating it the first time it is needed.
+ * The same decl is looked up many times while walking a translation unit
+ * (every reference to it, every CFG block of a function), so IDs are cached
+ * per decl. Redeclarations share the entry of their canonical decl.
+ * @param decl The decl to get the ID for.
+ * @param isInnerCFG checks if this ID is used for generating CFG blocks
+ * @return The ID. The reference stays valid for the lifetime of the walker.
+ */
+const string &ParentWalker::generateID(const NamedDecl *decl, bool isInnerCFG) {
+    idLookups++;
+
+    // Inner CFG IDs and the `;static;` suffix of non-function statics use the
+    // filename of this particular redeclaration, so those can't be shared.
+    const Decl *key = decl->getCanonicalDecl();
+    if (isInnerCFG || (!decl->getAsFunction() && isStatic(decl))) {
+        key = decl;
+    }
+    auto &cache = isInnerCFG ? innerCFGDeclIDs : declIDs;
+    auto cached = cache.find(key);
+    if (cached != cache.end()) {
+        idCacheHits++;
+        return *cached->second;
+    }
+
+    const string *id = &*generatedIDs.insert(generateQualifiedID(decl, true, isInnerCFG)).first;
+    cache.emplace(key, id);
+    return *id;
+}
+
 /**
  * Generates a unique ID based on a decl.
  * @param decl The decl to generate the ID for.
@@ -1966,7 +1984,7 @@ string ParentWalker::generateCFGExitBlockID(const FunctionDecl *fdecl)
  * @param isCFGBlock checks if this ID is used for generating CFG blocks
  * @return A string of the ID.
  */
-string ParentWalker::generateID(const NamedDecl *decl, bool root, bool isInnerCFG) {
+string ParentWalker::generateQualifiedID(const NamedDecl *decl, bool root, bool isInnerCFG) {
     // "root" defaults to true and indicates whether we are in a recursive
     // invocation of this function or not.
     //TODO: Internal-only parameters like this are a code smell. You can
@@ -2024,10 +2042,7 @@ string ParentWalker::generateID(const NamedDecl *decl, bool root, bool isInnerCF
     bool isFunctionOrMethod = (isa<FunctionDecl>(decl) || isa<CXXMethodDecl>(decl));
 
     const NamedDecl *canDecl = dyn_cast<NamedDecl>(decl->getCanonicalDecl());
-    string filepath = generateFileName(canDecl);
-    if ((isInnerCFG)) {   
-        filepath = generateFileName(decl);
-    } 
+    const NamedDecl *fileDecl = isInnerCFG ? decl : canDecl;
 
     // Adds function parameters to account for function overloading
     if (isFunctionOrMethod) {
@@ -2054,21 +2069,20 @@ string ParentWalker::generateID(const NamedDecl *decl, bool root, bool isInnerCF
     // Find the first parent that is a NamedDecl (if any)
     // True if we found a NamedDecl
     bool found = false;
-    auto parent = Context->getParents(*canDecl);
     string parentName;
-    while (!parent.empty()) {
-        // Get the parent decl as named.
-        const NamedDecl *parentDecl = parent[0].get<NamedDecl>();
-
-        if (parentDecl) {
-            parentName = generateID(parentDecl, false, !isa<ParmVarDecl>(decl));
-            if (!parentName.empty())
-                name = parentName + "::" + name;
-            found = true;
-            break;
+    // Decls in an indexed function body already know their parent
+    const NamedDecl *parentDecl = ancestors.enclosingDecl(canDecl);
+    if (!parentDecl) {
+        auto parent = Context->getParents(*canDecl);
+        while (!parent.empty() && !(parentDecl = parent[0].get<NamedDecl>())) {
+            parent = Context->getParents(parent[0]);
         }
-
-        parent = Context->getParents(parent[0]);
+    }
+    if (parentDecl) {
+        parentName = generateQualifiedID(parentDecl, false, !isa<ParmVarDecl>(decl));
+        if (!parentName.empty())
+            name = parentName + "::" + name;
+        found = true;
     }
 
     const DeclContext *parentContext = nullptr;
@@ -2082,7 +2096,7 @@ string ParentWalker::generateID(const NamedDecl *decl, bool root, bool isInnerCF
 
         if (parentContext) {
             if (const auto *parentDecl = dyn_cast<NamedDecl>(parentContext)) {
-                funcName = generateID(parentDecl, false, !isa<ParmVarDecl>(decl));
+                funcName = generateQualifiedID(parentDecl, false, !isa<ParmVarDecl>(decl));
                 if (!funcName.empty()) {
                     name = funcName + "::" + name;
                 }
@@ -2111,9 +2125,7 @@ string ParentWalker::generateID(const NamedDecl *decl, bool root, bool isInnerCF
     // Adding filename to node ids
     if ((isFunctionOrMethod) || (!assignedFileName && root)) {
         assignedFileName = true;
-        std::vector<std::string> strs;
-        boost::split(strs, filepath, boost::is_any_of("/"));
-        name = strs.back() + "::" + name;
+        name = generateBaseFileName(fileDecl) + "::" + name;
     }
     
     if (!root) {
@@ -2210,35 +2222,97 @@ string ParentWalker::getPartialFileName(string filename, const NamedDecl *decl)
  */
 string ParentWalker::generateFileName(const NamedDecl *decl) {
 
-    // Gets the file name.
+    // Every decl in a file has the same filename, so it is only worked out
+    // once per file.
     SourceManager &sourceManager = Context->getSourceManager();
-    string filename = sourceManager.getFilename(decl->getLocation());
+    FileInfo &info = getFileInfo(sourceManager.getFileID(decl->getLocation()));
+    if (info.hasPath) {
+        return info.path;
+    }
 
-    if (filename.empty()) {
+    // Gets the file name.
+    string filename = sourceManager.getFilename(decl->getLocation());
+    if (!filename.empty()) {
+        info.hasPath = true;
+        info.path = normalizeFileName(filename);
+        info.baseName = info.path.substr(info.path.find_last_of('/') + 1);
+        return info.path;
+    }
+
+    // in cases we cannot locate file with the regular method, here is the alternative
+    // Example case: Test function of GTest 
+    // This depends on the decl and not just the file, so it isn't cached.
+    string location = decl->getBeginLoc().printToString(Context->getSourceManager());
+    size_t foundFile = location.find_first_of(":");
+    if (foundFile) {
+        filename = location.substr(0, foundFile);
+    } else {
+        return filename;
+    }
+    return normalizeFileName(filename);
+}
 
-        // in cases we cannot locate file with the regular method, here is the alternative
-        // Example case: Test function of GTest 
-        string location = decl->getBeginLoc().printToString(Context->getSourceManager());
-        size_t foundFile = location.find_first_of(":");
-        if (foundFile) {
-            filename = location.substr(0, foundFile);
-        } else {
-            return filename;
+/**
+ * Gets the last component of the filename of the decl.
+ * @param decl The declaration.
+ * @return The name of the file the declaration is in, without directories.
+ */
+string ParentWalker::generateBaseFileName(const NamedDecl *decl) {
+    FileInfo &info = getFileInfo(Context->getSourceManager().getFileID(decl->getLocation()));
+    if (!info.hasPath) {
+        string filename = generateFileName(decl);
+        if (!info.hasPath) {
+            return filename.substr(filename.find_last_of('/') + 1);
         }
-
     }
-    filename = fs::absolute(filename).string();
+    return info.baseName;
+}
+
+/**
+ * Makes a filename returned by clang absolute.
+ * @param filename The filename.
+ * @return The absolute filename with any dots resolved.
+ */
+string ParentWalker::normalizeFileName(const string &filename) {
+    string absolute = fs::absolute(filename).string();
 
     // The filenames returned by clang can have `..` path elements in them. The `fs::absolute` call
     // does not resolve these, it just guarantees that the filename is indeed an absolute path.
     // Using fs::canonical would resolve all the dots, but it is a very slow operation.
     // Compromise by manually resolving any dots.
-    auto smallstr = SmallString<256>(StringRef(filename));
+    auto smallstr = SmallString<256>(StringRef(absolute));
     // if remove_dot_dot==false, will only resolve single dots (.), not not double dots (..)
     llvm::sys::path::remove_dots(smallstr, /*remove_dot_dot=*/true);
     return smallstr.str();
 }
 
+/**
+ * Checks whether a function is a callback according to callbackFuncRegex.
+ * Every redeclaration gets the same answer, so it is worked out once.
+ * @param decl The function to check.
+ * @return Whether the name of the function matches.
+ */
+bool ParentWalker::isCallbackFunc(const FunctionDecl *decl) {
+    const FunctionDecl *canonical = decl->getCanonicalDecl();
+    auto known = callbackFuncs.find(canonical);
+    if (known != callbackFuncs.end()) {
+        return known->second;
+    }
+    bool isCallback = callbackFuncPattern.matches(decl->getNameAsString());
+    callbackFuncs.emplace(canonical, isCallback);
+    return isCallback;
+}
+
+/**
+ * Gets what we know about a file in the translation unit, adding an empty
+ * entry the first time the file is seen.
+ * @param file The file.
+ * @return The cached information about the file.
+ */
+ParentWalker::FileInfo &ParentWalker::getFileInfo(FileID file) {
+    return files[file.getHashValue()];
+}
+
 /**
  * Gets the location (filename) of the named decl.
  * @param decl - The named declaration.
@@ -2251,8 +2325,8 @@ void ParentWalker::recordNamedDeclLocation(const NamedDecl *decl, RexNode* node,
     string canBaseFN = generateFileName(dyn_cast<NamedDecl>(decl->getCanonicalDecl()));
     if (!baseFN.empty()) {
         if (hasBody)
-            node->addSingleAttribute(TASchemeAttribute::FILENAME, baseFN);
-        node->addSingleAttribute(TASchemeAttribute::FILENAME_DECLARE, canBaseFN);
+            node->addSingleAttribute(RexAttribute::FILENAME, baseFN);
+        node->addSingleAttribute(RexAttribute::FILENAME_DECLARE, canBaseFN);
     }
 }
 
@@ -2274,18 +2348,42 @@ bool ParentWalker::isInSystemHeader(
         return false;
     }
 
-    if (manager.isInSystemHeader(loc))
-        return true;
+    // The answer is the same for every location in a file, so we only work it
+    // out once per file in the translation unit.
+    FileInfo &info = getFileInfo(manager.getFileID(loc));
+    if (info.isSystem != FileInfo::UNKNOWN) {
+        return info.isSystem == FileInfo::YES;
+    }
 
-    // Now, check to see if we have a ROS library.
-    string libLoc = loc.printToString(manager);
-    libLoc = libLoc.substr(0, libLoc.find(":"));
-    return ignored.shouldIgnore(libLoc);
+    bool isSystem = manager.isInSystemHeader(loc);
+    if (!isSystem) {
+        // Now, check to see if we have a ROS library.
+        string libLoc = loc.printToString(manager);
+        libLoc = libLoc.substr(0, libLoc.find(":"));
+        isSystem = ignored.shouldIgnore(libLoc);
+    }
+    info.isSystem = isSystem ? FileInfo::YES : FileInfo::NO;
+    return isSystem;
 }
 
 bool ParentWalker::isInMainFile(const Stmt *statement) {
     const SourceManager &mgr = Context->getSourceManager();
-    return mgr.isInMainFile(statement->getBeginLoc());
+    SourceLocation loc = statement->getBeginLoc();
+    if (loc.isInvalid()) {
+        return false;
+    }
+
+    // The source manager answers this for the file the location was expanded
+    // in, so cache it for that file.
+    FileID file = mgr.getFileID(mgr.getExpansionLoc(loc));
+    if (hasLineDirectives(mgr, file)) {
+        return mgr.isInMainFile(loc);
+    }
+    FileInfo &info = getFileInfo(file);
+    if (info.isMain == FileInfo::UNKNOWN) {
+        info.isMain = mgr.isInMainFile(loc) ? FileInfo::YES : FileInfo::NO;
+    }
+    return info.isMain == FileInfo::YES;
 }
 
 bool ParentWalker::isInMainFile(const Decl *decl) {
@@ -2332,8 +2430,34 @@ bool ParentWalker::isInMainFile(const Decl *decl) {
         }**/
     }
 
+    // Same as above, this depends only on the file the location was expanded in
     const SourceManager &mgr = Context->getSourceManager();
-    return !mgr.isWrittenInBuiltinFile(decl->getLocation());
+    SourceLocation loc = decl->getLocation();
+    if (loc.isInvalid()) {
+        return !mgr.isWrittenInBuiltinFile(loc);
+    }
+    FileID file = mgr.getFileID(mgr.getExpansionLoc(loc));
+    if (hasLineDirectives(mgr, file)) {
+        return !mgr.isWrittenInBuiltinFile(loc);
+    }
+    FileInfo &info = getFileInfo(file);
+    if (info.isBuiltin == FileInfo::UNKNOWN) {
+        info.isBuiltin = mgr.isWrittenInBuiltinFile(loc) ? FileInfo::YES : FileInfo::NO;
+    }
+    return info.isBuiltin == FileInfo::NO;
+}
+
+/**
+ * Checks whether a file has #line directives. Those can change the presumed
+ * file partway through, so answers for the file can't be cached.
+ * @param manager The source manager.
+ * @param file The file.
+ * @return Whether the file has any #line directives.
+ */
+bool ParentWalker::hasLineDirectives(const SourceManager &manager, FileID file) {
+    bool invalid = false;
+    const SrcMgr::SLocEntry &entry = manager.getSLocEntry(file, &invalid);
+    return !invalid && entry.isFile() && entry.getFile().hasLineDirectives();
 }
 
 /**
@@ -2342,37 +2466,14 @@ bool ParentWalker::isInMainFile(const Decl *decl) {
  * @return Whether the variable is used.
  */
 bool ParentWalker::usedInIfStatement(const Expr *declRef) {
-    // Iterate through and find if we have an if statement parent.
-    bool getParent = true;
-    auto parent = Context->getParents(*declRef);
-    auto previous = Context->getParents(*declRef);
-
-    while (getParent) {
-        // Check if it's empty.
-        if (parent.empty()) {
-            getParent = false;
-            continue;
-        }
-
-        // Get the current parent as an if statement.
-        auto ifStmt = parent[0].get<IfStmt>();
-        if (ifStmt) {
-            auto conditionExpression = previous[0].get<Expr>();
-            if (findExpression(conditionExpression))
-                return true;
-            return false;
-        }
-
-        auto switchStmt = parent[0].get<SwitchStmt>();
-        if (switchStmt) {
-            auto conditionExpression = previous[0].get<Expr>();
+    // Find the nearest if or switch statement parent.
+    for (const auto &enclosing : getEnclosingControlStmts(declRef)) {
+        if (isa<IfStmt>(enclosing.first) || isa<SwitchStmt>(enclosing.first)) {
+            auto conditionExpression = dyn_cast_or_null<Expr>(enclosing.second);
             if (findExpression(conditionExpression))
                 return true;
             return false;
         }
-
-        previous = parent;
-        parent = Context->getParents(parent[0]);
     }
 
     return false;
@@ -2384,40 +2485,49 @@ bool ParentWalker::usedInIfStatement(const Expr *declRef) {
  * @return Whether the variable is used.
  */
 bool ParentWalker::usedInLoop(const Expr *declRef) {
-    // Iterate through and find if we have an if statement parent.
-    bool getParent = true;
-    auto parent = Context->getParents(*declRef);
-    auto previous = Context->getParents(*declRef);
-
-    while (getParent) {
-        // Check if it's empty.
-        if (parent.empty()) {
-            getParent = false;
-            continue;
-        }
-
-        // Get the current parent as an if statement.
-        auto whileStmt = parent[0].get<WhileStmt>();
-        if (whileStmt) {
-            auto conditionExpression = previous[0].get<Expr>();
+    // Find the nearest while or for loop parent.
+    for (const auto &enclosing : getEnclosingControlStmts(declRef)) {
+        if (isa<WhileStmt>(enclosing.first) || isa<ForStmt>(enclosing.first)) {
+            auto conditionExpression = dyn_cast_or_null<Expr>(enclosing.second);
             if (findExpression(conditionExpression))
                 return true;
             return false;
         }
+    }
 
-        auto forStmt = parent[0].get<ForStmt>();
-        if (forStmt) {
-            auto conditionExpression = previous[0].get<Expr>();
-            if (findExpression(conditionExpression))
-                return true;
-            return false;
+    return false;
+}
+
+/**
+ * Gets the control statements (if/for/while/do/switch) enclosing a statement.
+ * Uses the ancestor index when the statement is in an indexed function body,
+ * otherwise climbs the parent map.
+ * @param stmt The statement.
+ * @return Each control statement, innermost first, paired with its child
+ *         that contains the statement.
+ */
+vector<pair<const Stmt *, const Stmt *>> ParentWalker::getEnclosingControlStmts(const Stmt *stmt) {
+    vector<pair<const Stmt *, const Stmt *>> enclosing;
+
+    if (const AncestorIndex::Ancestors *indexed = ancestors.find(stmt)) {
+        while (indexed && indexed->control) {
+            enclosing.emplace_back(indexed->control, indexed->controlChild);
+            indexed = ancestors.find(indexed->control);
         }
+        return enclosing;
+    }
 
-        previous = parent;
+    auto parent = Context->getParents(*stmt);
+    const Stmt *previous = stmt;
+    while (!parent.empty()) {
+        const Stmt *current = parent[0].get<Stmt>();
+        if (current && AncestorIndex::isControlStmt(current)) {
+            enclosing.emplace_back(current, previous);
+        }
+        previous = current;
         parent = Context->getParents(parent[0]);
     }
-
-    return false;
+    return enclosing;
 }
 
 /**
@@ -2444,6 +2554,13 @@ void ParentWalker::addParentRelationship(
     bool getParent = true;
     auto currentDecl = baseDecl;
 
+    // Decls in function bodies are indexed with their enclosing function or
+    // variable, both of which are containers.
+    if (const NamedDecl *parentDecl = ancestors.enclosingDecl(baseDecl)) {
+        addOrUpdateEdge(generateID(parentDecl), baseID, RexEdge::CONTAINS);
+        return;
+    }
+
     // Get the parent.
     auto parent = Context->getParents(*currentDecl);
     while (getParent) {
@@ -2806,9 +2923,12 @@ void ParentWalker::CFGModel::BasicBlock::createAndLinkRexCFGNodes(ParentWalker&
                                 RexNode::CFG_BLOCK, true /* shouldKeep */);
     //bool isExit = walker.isStatic(walker.curFunc) || ((block_->getBlockID() != 0) && (block_ != &(walker.curCFG.get()->getEntry())));
     walker.recordNamedDeclLocation(walker.curFunc, head); // add filename
-    //head->addSingleAttribute(TASchemeAttribute::FILENAME_DEFINITION, 
+    //head->addSingleAttribute(RexAttribute::FILENAME_DEFINITION, 
                     //walker.generateFileName(walker.curFunc));
-    walker.addEdgeToGraph(walker.generateID(walker.curFunc), head->getID(), RexEdge::CONTAINS);
+    // Lets tools find the function of a block without following contain edges
+    string functionID = walker.generateID(walker.curFunc);
+    head->addSingleAttribute(RexAttribute::CFG_FUNCTION, functionID);
+    walker.addEdgeToGraph(functionID, head->getID(), RexEdge::CONTAINS);
     walker.addNodeToGraph(head);
 }
 
@@ -31,6 +31,8 @@
 #define REX_PARENTWALKER_H
 
 #include <map>
+#include <unordered_map>
+#include <unordered_set>
 
 #include <clang/AST/ASTContext.h>
 #include <clang/AST/Decl.h>
@@ -39,7 +41,9 @@
 
 #include "../Graph/TAGraph.h"
 #include "BaselineWalker.h"
+#include "AncestorIndex.h"
 #include "../Driver/RexArgs.h"
+#include "../Driver/NamePattern.h"
 #include "../Linker/TASchemeAttribute.h"
 
 
@@ -53,6 +57,8 @@ public:
     ParentWalker(const WalkerConfig &config, clang::ASTContext *Context);
     virtual ~ParentWalker();
 
+    virtual void reportTelemetry(JobTelemetry &telemetry) const override;
+
     // Variable access
     // A function can read or write to a variable. These are some data structures
     // Used to keep track of variable access.
@@ -125,8 +131,9 @@ public:
     bool addVars(std::set<const clang::Stmt*> stmts, int64_t baseExprID, std::vector<std::string> *vars);
 
     // Name Helper Functions
-    std::string generateID(const clang::NamedDecl *decl, bool root = true, bool isInnerCFG = false);
+    const std::string &generateID(const clang::NamedDecl *decl, bool isInnerCFG = false);
     std::string generateID(const clang::MemberExpr *member);
+    std::string generateQualifiedID(const clang::NamedDecl *decl, bool root, bool isInnerCFG);
     bool assignedFileName;
     // A CFG's entry block gets assigned a different ID than the other blocks.
     // This method can be used as a convenience to avoid explicitly checking if the block is
@@ -140,6 +147,8 @@ public:
     std::string generateRetID(const clang::FunctionDecl *fdecl);
     std::string generateName(const clang::NamedDecl *decl);
     std::string generateFileName(const clang::NamedDecl *decl);
+    std::string generateBaseFileName(const clang::NamedDecl *decl);
+    static std::string normalizeFileName(const std::string &filename);
     std::string getPartialFileName(std::string filename, const clang::NamedDecl *decl);
     void recordNamedDeclLocation(const clang::NamedDecl *decl, RexNode* node, bool hasBody = true);
 
@@ -152,6 +161,7 @@ public:
 
     // System Headers - Helpers
     bool isInSystemHeader(const clang::SourceManager &manager, clang::SourceLocation loc);
+    static bool hasLineDirectives(const clang::SourceManager &manager, clang::FileID file);
 
     // Minimal Variables - Helpers
     const clang::NamedDecl *getAssignee(const clang::CXXOperatorCallExpr *parent);
@@ -168,6 +178,9 @@ public:
     template <typename T>
     const clang::NamedDecl *getParent(const T *node)
     {
+		if (const AncestorIndex::Ancestors *indexed = ancestors.find(node)) {
+			return indexed->namedDecl;
+		}
 		auto parents = Context->getParents(*node);
 		const clang::NamedDecl *parentDecl = parents[0].template get<clang::NamedDecl>();
 		while (!parentDecl && !parents.empty()) {
@@ -181,6 +194,10 @@ public:
     bool usedInIfStatement(const clang::Expr *declRef);
     bool usedInLoop(const clang::Expr *declRef);
     bool findExpression(const clang::Expr *expression);
+    // The if/for/while/do/switch statements enclosing a statement, innermost
+    // first, each paired with its child that contains the statement
+    std::vector<std::pair<const clang::Stmt *, const clang::Stmt *>>
+    getEnclosingControlStmts(const clang::Stmt *stmt);
 
     // Secondary Helper Functions
     void addParentRelationship(const clang::NamedDecl *baseDecl, std::string baseID);
@@ -196,12 +213,49 @@ protected:
     const std::string &featureName;
     const LanguageFeatureOptions langFeats;
     bool buildCFG;
+    bool pruneIgnored;
     const ROSFeatureOptions ROSFeats;
-    const std::regex callbackFuncRegex;
+    const NamePattern callbackFuncPattern;
     clang::ASTContext *Context;
 
     std::vector<clang::Expr *> parentExpression;
 
+    // What we have worked out about each file (by FileID) in the translation
+    // unit. Every location in a file gets the same answers, so each field is
+    // filled in the first time it is asked for.
+    struct FileInfo {
+        enum Answer { UNKNOWN, YES, NO };
+        // System header or ignored (isInSystemHeader)
+        Answer isSystem = UNKNOWN;
+        // isInMainFile for statements
+        Answer isMain = UNKNOWN;
+        // Written in <built-in> (isInMainFile for decls)
+        Answer isBuiltin = UNKNOWN;
+        // Absolute path with dots resolved, and its last component
+        bool hasPath = false;
+        std::string path;
+        std::string baseName;
+    };
+    std::unordered_map<unsigned, FileInfo> files;
+    FileInfo &getFileInfo(clang::FileID file);
+
+    // Ancestors of the statements in every function body walked so far
+    AncestorIndex ancestors;
+
+    // Whether each function (by canonical decl) matches callbackFuncRegex
+    std::unordered_map<const clang::FunctionDecl *, bool> callbackFuncs;
+    bool isCallbackFunc(const clang::FunctionDecl *decl);
+
+    // IDs already generated in this translation unit. Every distinct ID is
+    // stored once in generatedIDs, and the per-decl caches point into it.
+    // The cache for inner CFG IDs is keyed by the decl itself because those
+    // IDs use the filename of that particular redeclaration.
+    std::unordered_set<std::string> generatedIDs;
+    std::unordered_map<const clang::Decl *, const std::string *> declIDs;
+    std::unordered_map<const clang::Decl *, const std::string *> innerCFGDeclIDs;
+    unsigned long idLookups;
+    unsigned long idCacheHits;
+
     // Variability Aware - but also these functions must now always
     // be used when adding edges/nodes to the graph!
     virtual void addEdgeToGraph(RexEdge *);
@@ -24,8 +24,10 @@
 /////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 #include "ROSConsumer.h"
+#include "../Driver/IgnoreMatcher.h"
 
 #include <clang/Frontend/CompilerInstance.h>
+#include <chrono>
 #include <iostream>
 
 using namespace clang;
@@ -37,14 +39,16 @@ WalkerConfig::WalkerConfig(TAGraph &graph, const IgnoreMatcher &ignored,
                             VariabilityOptions vOpts, LanguageFeatureOptions lFeats,
                             GuidedExtractionOptions geOpts, ROSFeatureOptions ROSFeats):
     graph{graph}, ignored{ignored}, featureName{featureName}, clangOnly{clangOnly},
-    buildCFG{buildCFG}, vOpts{vOpts}, lFeats{lFeats}, geOpts{geOpts}, ROSFeats{ROSFeats} {}
+    buildCFG{buildCFG}, pruneIgnored{false}, leanFrontend{false}, vOpts{vOpts}, lFeats{lFeats}, geOpts{geOpts}, ROSFeats{ROSFeats},
+    telemetry{nullptr} {}
 
 
 /**
  * Creates a ROS consumer.
  * @param context The AST context.
  */
-ROSConsumer::ROSConsumer(const WalkerConfig &config, ASTContext *context)
+ROSConsumer::ROSConsumer(const WalkerConfig &config, ASTContext *context) :
+    telemetry{config.telemetry}, ignored{config.ignored}, leanFrontend{config.leanFrontend}
 {
     walker = createWalker(config, context);
 }
@@ -59,7 +63,58 @@ ROSConsumer::~ROSConsumer()
  * @param context The AST context.
  */
 void ROSConsumer::HandleTranslationUnit(ASTContext &context) {
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
     walker->TraverseDecl(context.getTranslationUnitDecl());
+    if (telemetry) {
+        chrono::duration<double, milli> walkTime = chrono::steady_clock::now() - start;
+        telemetry->walkMs += walkTime.count();
+        telemetry->walkStartUs = chrono::duration_cast<chrono::microseconds>(start.time_since_epoch()).count();
+        walker->reportTelemetry(*telemetry);
+    }
+}
+
+/**
+ * Decides whether clang can skip parsing a function body. Only asked when
+ * SkipFunctionBodies is on (see ROSAction), and clang still parses bodies it
+ * needs for semantic analysis (constexpr functions, deduced return types).
+ * @param decl The function whose body is about to be parsed.
+ * @return Whether the body is an ordinary function in an ignored or system file.
+ */
+bool ROSConsumer::shouldSkipFunctionBody(Decl *decl) {
+    if (!leanFrontend) {
+        return false;
+    }
+
+    // Instantiations used by project code get their bodies from the template,
+    // so function templates, their specializations and members of class
+    // templates always keep theirs
+    FunctionDecl *function = decl->getAsFunction();
+    if (isa<FunctionTemplateDecl>(decl) || !function ||
+        function->getTemplatedKind() != FunctionDecl::TK_NonTemplate || function->isDependentContext()) {
+        return false;
+    }
+
+    // Use where the body was expanded so functions defined by a macro from
+    // a library (e.g. gtest's TEST) in project code are kept
+    SourceManager &manager = decl->getASTContext().getSourceManager();
+    SourceLocation loc = manager.getExpansionLoc(decl->getLocation());
+    if (loc.isInvalid()) {
+        return false;
+    }
+
+    unsigned fileID = manager.getFileID(loc).getHashValue();
+    auto cached = skippableFiles.find(fileID);
+    if (cached != skippableFiles.end()) {
+        return cached->second;
+    }
+
+    bool skippable = manager.isInSystemHeader(loc);
+    if (!skippable) {
+        string filename = manager.getFilename(loc).str();
+        skippable = !filename.empty() && ignored.shouldIgnore(filename);
+    }
+    skippableFiles[fileID] = skippable;
+    return skippable;
 }
 
 // TODO: Create alternative walkers based on what is available
@@ -88,6 +143,14 @@ std::unique_ptr<ASTConsumer> ROSAction::CreateASTConsumer(
     CompilerInstance &Compiler, StringRef /* InFile */) {
 	// Hide all output
 	//Compiler.getDiagnostics().setClient(new IgnoringDiagConsumer());
+
+    if (config.leanFrontend) {
+        // The consumer decides which bodies to skip in shouldSkipFunctionBody
+        Compiler.getFrontendOpts().SkipFunctionBodies = true;
+        // Nothing we extract comes from comments, so don't record the ones
+        // in system headers
+        Compiler.getLangOpts().RetainCommentsFromSystemHeaders = false;
+    }
     return std::unique_ptr<ASTConsumer>(new ROSConsumer(config, &Compiler.getASTContext()));
 }
 
@@ -29,12 +29,14 @@
 #include "ROSWalker.h"
 #include "VarWalker.h"
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 
 #include <clang/Frontend/FrontendAction.h>
 #include <clang/Tooling/Tooling.h>
 #include "../Driver/RexArgs.h"
+#include "../Driver/JobTelemetry.h"
 
 
 class IgnoreMatcher;
@@ -56,6 +58,14 @@ struct WalkerConfig {
     // Whether to build and include CFG information
     bool buildCFG;
 
+    // Whether to skip walking declarations that are entirely in ignored or
+    // system files
+    bool pruneIgnored;
+
+    // Whether to have clang skip parsing non-template function bodies in
+    // ignored or system files (and not keep comments from system headers)
+    bool leanFrontend;
+
     // Variability Aware
     VariabilityOptions vOpts;
 
@@ -65,6 +75,9 @@ struct WalkerConfig {
 
     GuidedExtractionOptions geOpts;
 
+    // Where to record walk time and AST size, if anywhere
+    JobTelemetry *telemetry;
+
     WalkerConfig(TAGraph &graph, const IgnoreMatcher &ignored,
         const std::string &featureName, bool clangOnly = false, bool buildCFG = false,
         VariabilityOptions vOpts = VariabilityOptions{},
@@ -75,12 +88,18 @@ struct WalkerConfig {
 
 class ROSConsumer : public clang::ASTConsumer {
     BaselineWalker* walker;
+    JobTelemetry *telemetry;
+    const IgnoreMatcher &ignored;
+    bool leanFrontend;
+    // Whether bodies in each file (by FileID) can be skipped
+    std::unordered_map<unsigned, bool> skippableFiles;
 
   public:
     // Constructor/Destructor
     ROSConsumer(const WalkerConfig &config, clang::ASTContext *context);
     virtual ~ROSConsumer();
     virtual void HandleTranslationUnit(clang::ASTContext &context) override;
+    virtual bool shouldSkipFunctionBody(clang::Decl *decl) override;
 
   private:
     BaselineWalker* createWalker(const WalkerConfig &config, clang::ASTContext *context);
@@ -234,6 +234,9 @@ bool ROSWalker::VisitFunctionDecl(FunctionDecl *decl) {
         return true;
 
     curFunc = decl;
+    // Index the body up front since most of what we record in it asks about
+    // its ancestors.
+    ancestors.indexFunction(decl);
     // Record the function declaration.
     recordFunctionDecl(decl);
     auto functionID = generateID(decl);
@@ -346,6 +349,14 @@ bool ROSWalker::VisitDeclRefExpr(DeclRefExpr *declRef) {
 }
 
 bool ROSWalker::TraverseDecl(clang::Decl *d)  {
+    // Nothing inside an ignored or system DeclContext gets recorded, so with
+    // pruning on we don't walk it at all. Anything in there that the project
+    // refers to (callees, types) still gets a node when the reference is
+    // recorded.
+    if (pruneIgnored && isIgnoredDeclContext(d)) {
+        return true;
+    }
+
     if (BaselineWalker::TraverseDecl(d)) {
         // TraverseDecl on a FunctionDecl also performs a Clang traversal
         // of the function's entire body. So at this point, all facts in
@@ -364,6 +375,19 @@ bool ROSWalker::TraverseDecl(clang::Decl *d)  {
     return false;
 }
 
+/**
+ * Checks whether a decl is a DeclContext that starts and ends in ignored or
+ * system files (e.g. a namespace, class or function from a ROS/Boost/STL header).
+ * @param d The declaration.
+ * @return Whether it can be skipped entirely.
+ */
+bool ROSWalker::isIgnoredDeclContext(const Decl *d) {
+    if (!d || !isa<DeclContext>(d) || isa<TranslationUnitDecl>(d)) {
+        return false;
+    }
+    return isInSystemHeader(d) && isInSystemHeader(Context->getSourceManager(), d->getEndLoc());
+}
+
 void ROSWalker::extractTopicVariable(Stmt* stmt) {
     // extract default values for ros::param assignments
     if (CallExpr *callExpr = dyn_cast<CallExpr>(stmt)) {
@@ -532,7 +556,7 @@ RexNode* ROSWalker::recordCallback(const FunctionDecl *funcDecl, RexNode *topic,
     }
 
     // mark function as callback
-    callback->addSingleAttribute(TASchemeAttribute::ROS_IS_CALLBACK, "1");
+    callback->addSingleAttribute(RexAttribute::ROS_IS_CALLBACK, "1");
 
     // Record that the callback's argument is the target of a publish. The word
     // "target" refers to the fact that publish(var) will write `var` to this
@@ -665,12 +689,12 @@ void ROSWalker::recordSubscribe(const CallExpr *expr) {
     }
 
     // Record attributes for subscriber.
-    //currentSubscriber->addSingleAttribute(TASchemeAttribute::ROS_TOPIC_BUFFER_SIZE, queueSize);
-    currentSubscriber->addSingleAttribute(TASchemeAttribute::ROS_NUM_ATTRIBUTES, to_string(numArgs));
-    currentSubscriber->addSingleAttribute(TASchemeAttribute::ROS_CALLBACK, callbackName);
+    //currentSubscriber->addSingleAttribute(RexAttribute::ROS_TOPIC_BUFFER_SIZE, queueSize);
+    currentSubscriber->addSingleAttribute(RexAttribute::ROS_NUM_ATTRIBUTES, to_string(numArgs));
+    currentSubscriber->addSingleAttribute(RexAttribute::ROS_CALLBACK, callbackName);
 
     // Finally, adds in the callback function.
-    //callback->addSingleAttribute(TASchemeAttribute::ROS_IS_CALLBACK, "1");
+    //callback->addSingleAttribute(RexAttribute::ROS_IS_CALLBACK, "1");
     RexEdge *callbackEdge = new RexEdge(currentSubscriber, callback, RexEdge::CALLS);
     addEdgeToGraph(callbackEdge);
 
@@ -699,7 +723,7 @@ void ROSWalker::recordPublish(const CallExpr *expr, string cfgID) {
         return;
 
     // Next, gets the topic it publishes to.
-    const vector<RexEdge *> &destinations = graph.findEdgesBySrcID(parentVar->getID());
+    const vector<RexEdge *> destinations = graph.findEdgesBySrcID(parentVar->getID());
     RexNode *topic = nullptr;
 
     if (destinations.empty()) {
@@ -740,7 +764,7 @@ void ROSWalker::recordPublish(const CallExpr *expr, string cfgID) {
     string data = args.at(0);
     if (data.size() > PUB_MAX)
         data = data.substr(0, PUB_MAX);
-    publish->addSingleAttribute(TASchemeAttribute::ROS_PUBLISHER_DATA, data);
+    publish->addSingleAttribute(RexAttribute::ROS_PUBLISHER_DATA, data);
 
     // Adds the result to the graph.
     addEdgeToGraph(publish);
@@ -859,9 +883,9 @@ void ROSWalker::recordAdvertise(const CallExpr *expr) {
     addEdgeToGraph(topEdge);
 
     // Record specific attributes.
-    //currentPublisher->addSingleAttribute(TASchemeAttribute::ROS_TOPIC_BUFFER_SIZE, queueSize);
-    currentPublisher->addSingleAttribute(TASchemeAttribute::ROS_NUM_ATTRIBUTES, to_string(numArgs));
-    currentPublisher->addSingleAttribute(TASchemeAttribute::ROS_PUBLISHER_TYPE, getPublisherType(expr));
+    //currentPublisher->addSingleAttribute(RexAttribute::ROS_TOPIC_BUFFER_SIZE, queueSize);
+    currentPublisher->addSingleAttribute(RexAttribute::ROS_NUM_ATTRIBUTES, to_string(numArgs));
+    currentPublisher->addSingleAttribute(RexAttribute::ROS_PUBLISHER_TYPE, getPublisherType(expr));
 
     currentPublisher = nullptr;
 }
@@ -923,8 +947,8 @@ void ROSWalker::recordTimer(const CallExpr *expr) {
 
 	RexNode* currentTimer = graph.findNode(timerStack.top());
     // Adds specific attributes.
-    currentTimer->addSingleAttribute(TASchemeAttribute::ROS_TIMER_DURATION, timerFreq);
-    currentTimer->addSingleAttribute(TASchemeAttribute::ROS_TIMER_IS_ONESHOT, oneshot);
+    currentTimer->addSingleAttribute(RexAttribute::ROS_TIMER_DURATION, timerFreq);
+    currentTimer->addSingleAttribute(RexAttribute::ROS_TIMER_IS_ONESHOT, oneshot);
 
     // Attempt to find the callback
     RexNode *callback = nullptr;
@@ -1077,7 +1101,7 @@ void ROSWalker::recordTopic(string id, string name, const Expr *topicArg) {
 
     // Create the node.
     RexNode *node = new RexNode(id, RexNode::TOPIC, isInMainFile(topicArg));
-    node->addSingleAttribute(TASchemeAttribute::LABEL, name);
+    node->addSingleAttribute(RexAttribute::LABEL, name);
     addNodeToGraph(node);
 }
 
@@ -51,6 +51,7 @@ class ROSWalker : public ParentWalker {
     bool VisitDeclRefExpr(clang::DeclRefExpr *declRef) override;
 
     bool TraverseDecl(clang::Decl *d) override;
+    bool isIgnoredDeclContext(const clang::Decl *d);
 
     void handleROSstmt(clang::Stmt* statement);
 
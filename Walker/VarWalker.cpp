@@ -39,6 +39,7 @@
 #include "../Graph/RexNode.h"
 #include "ROSConsumer.h"
 #include "CondScope.h"
+#include "CondBDD.h"
 #include "RexID.h"
 using namespace llvm;
 using namespace clang;
@@ -49,7 +50,11 @@ using namespace std;
  * @param Context AST Context
  */
 VarWalker::VarWalker(const WalkerConfig &config, ASTContext *Context) :
-        ROSWalker{config, Context}, condScope{Context, config.vOpts} {}
+        ROSWalker{config, Context}, condScope{Context, config.vOpts} {
+    if (config.vOpts.bdd) {
+        CondBDD::enable(config.vOpts);
+    }
+}
 
 /**
  * Destructor
@@ -58,13 +63,13 @@ VarWalker::~VarWalker() {}
 
 
 void VarWalker::addEdgeToGraph(RexEdge *e) {
-    RexCond *c = condScope.conjunction();
+    const RexCond *c = condScope.conjunction();
     e->setCond(c);
     graph.addEdge(e);
 }
 
 void VarWalker::addNodeToGraph(RexNode *n) {
-    RexCond *c = condScope.conjunction();
+    const RexCond *c = condScope.conjunction();
     n->setCond(c);
     graph.addNode(n);
 }
@@ -8,15 +8,15 @@ void ParentWalker::recordVarDecl(const VarDecl *decl) {
 
         // Creates the node.
         RexNode *node = specializedVariableNode(decl, isInMainFile(decl));
-        node->addSingleAttribute(TASchemeAttribute::LABEL, name);
-        node->addSingleAttribute(TASchemeAttribute::IS_CONTROL_FLOW, "0");
+        node->addSingleAttribute(RexAttribute::LABEL, name);
+        node->addSingleAttribute(RexAttribute::IS_CONTROL_FLOW, "0");
         if (isa<ParmVarDecl>(decl)) {
-            node->addSingleAttribute(TASchemeAttribute::IS_PARAM, "1");
+            node->addSingleAttribute(RexAttribute::IS_PARAM, "1");
             recordNamedDeclLocation(decl, node);
-            //node->addSingleAttribute(TASchemeAttribute::FILENAME_DEFINITION, 
+            //node->addSingleAttribute(RexAttribute::FILENAME_DEFINITION, 
             //    generateFileName(decl->getDefinition()));
         } else {
-            node->addSingleAttribute(TASchemeAttribute::IS_PARAM, "0");
+            node->addSingleAttribute(RexAttribute::IS_PARAM, "0");
             recordNamedDeclLocation(decl, node);
         }
         
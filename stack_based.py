@@ -55,8 +55,9 @@ class StackFrame:
         return "match " + self.match + " where " + self.whereID + " and " + self.pattern + " return 1"
 
 def getEnclosingFunction(cfgID):
-    result = session.run('''match (f)-[:functionCFGLink]->()-[:contain*]->(n {id: $cfgID})
-                            return f.id as fID''', cfgID=cfgID)
+    # Every CFG block records the function it belongs to
+    result = session.run('''match (n {id: $cfgID})
+                            return n.function as fID''', cfgID=cfgID)
     return result.peek()['fID']
 
 def callsTransitively(f1, f2):
@@ -0,0 +1,75 @@
+#!/bin/bash
+
+# Links two object files whose facts have presence conditions and checks the
+# conditions in the TA file and the snapshot. Each object file has its own
+# condition table, and a fact found in both files gets the OR of its
+# conditions:
+#   f               A in first.tao, B in second.tao
+#   v               B in both
+#   g               defined(C) in first.tao, unconditional in second.tao
+#   write f v       A in first.tao, (defined(C)||B) in second.tao
+#   write f g, h    only in one file
+
+echo "Creating temp files..."
+
+TEMP_STDOUT=$(mktemp /tmp/RexTestStdout.XXXXXX)
+TEMP_STDERR=$(mktemp /tmp/RexTestStderr.XXXXXX)
+
+if [ -z "$REX" ]
+then
+    echo "REX environment variable is undefined. Assuming Rex is found in PATH."
+    REX_EXECUTABLE=Rex
+else
+    echo "REX environment variable found."
+    REX_EXECUTABLE="$REX"
+fi
+
+# Clean up previous output (if any)
+rm -f out.ta out.rexsnap stream.ta attributes.txt stream_attributes.txt conditions.txt
+
+OBJECT_FILES="first.tao second.tao"
+
+exit_code=0
+# Runs a step of the test. Any step that fails fails the test.
+run() {
+    echo "$1"
+    eval "$1" >> $TEMP_STDOUT 2>> $TEMP_STDERR || { echo "Step failed"; exit_code=1; }
+}
+
+# Running test...
+run "$REX_EXECUTABLE --output=out.ta --snapshot=out.rexsnap $OBJECT_FILES"
+run "$REX_EXECUTABLE --stream-link --output=stream.ta $OBJECT_FILES"
+# Conditions are written inline, as the text of the condition attribute
+run "sed -n '/^FACT ATTRIBUTE :\$/,\$p' out.ta | sort > attributes.txt"
+run "diff expected_attributes.txt attributes.txt"
+run "sed -n '/^FACT ATTRIBUTE :\$/,\$p' stream.ta | sort > stream_attributes.txt"
+run "diff expected_attributes.txt stream_attributes.txt"
+run "$REX_EXECUTABLE query out.rexsnap --script conditions.rql > conditions.txt"
+run "diff expected_conditions.txt conditions.txt"
+
+echo "exit_code=$exit_code"
+
+if [ $exit_code -eq 0 ]
+then
+    echo "PASSED"
+else
+    echo "FAILED!!!"
+fi
+
+# Backing-up test result...
+TESTS_RESULT=tests_result
+mkdir -p $TESTS_RESULT
+
+timestamp=$(date +%s-%N) # Get timestamp in nanoseconds
+RESULT=$TESTS_RESULT/$timestamp
+mkdir $RESULT
+
+cp $TEMP_STDOUT $RESULT/stdout
+cp $TEMP_STDERR $RESULT/stderr
+cp out.ta stream.ta conditions.txt $RESULT/ 2>/dev/null
+
+echo "Result backed-up to $RESULT"
+
+# Cleaning up temp files...
+rm -f $TEMP_STDERR
+rm -f $TEMP_STDOUT
@@ -0,0 +1,75 @@
+#!/bin/bash
+
+# Runs the behaviour alteration path query on a small graph (see
+# Query/PathQuery.h). Each candidate path only differs from a valid one in
+# the order of its facts:
+#   a   writes x, x is written to y, then y influences a call to b: valid
+#   c   writes p after p is written to q, so q can't be influenced: invalid
+#   m   calls a, but the path never returns to m: invalid
+# The CFG blocks of a and m name their function, the blocks of b and c are
+# only contained by theirs. contained.tao is the same graph with every block
+# only contained by its function, which must give the same paths.
+
+echo "Creating temp files..."
+
+TEMP_STDOUT=$(mktemp /tmp/RexTestStdout.XXXXXX)
+TEMP_STDERR=$(mktemp /tmp/RexTestStderr.XXXXXX)
+
+if [ -z "$REX" ]
+then
+    echo "REX environment variable is undefined. Assuming Rex is found in PATH."
+    REX_EXECUTABLE=Rex
+else
+    echo "REX environment variable found."
+    REX_EXECUTABLE="$REX"
+fi
+
+# Clean up previous output (if any)
+rm -f paths.rexsnap paths.csv parallel.csv short.csv contained.rexsnap contained.csv
+
+exit_code=0
+# Runs a step of the test. Any step that fails fails the test.
+run() {
+    echo "$1"
+    eval "$1" >> $TEMP_STDOUT 2>> $TEMP_STDERR || { echo "Step failed"; exit_code=1; }
+}
+
+# Running test...
+run "$REX_EXECUTABLE --snapshot=paths.rexsnap paths.tao"
+run "$REX_EXECUTABLE query paths.rexsnap paths.csv"
+run "diff expected_paths.csv paths.csv"
+run "$REX_EXECUTABLE query --jobs 3 paths.rexsnap parallel.csv"
+run "diff expected_paths.csv parallel.csv"
+# The valid path has two edges before the varInfFunc edge
+run "$REX_EXECUTABLE query --max-length 1 paths.rexsnap short.csv"
+run "[ ! -s short.csv ]"
+run "$REX_EXECUTABLE --snapshot=contained.rexsnap contained.tao"
+run "$REX_EXECUTABLE query contained.rexsnap contained.csv"
+run "diff expected_paths.csv contained.csv"
+
+echo "exit_code=$exit_code"
+
+if [ $exit_code -eq 0 ]
+then
+    echo "PASSED"
+else
+    echo "FAILED!!!"
+fi
+
+# Backing-up test result...
+TESTS_RESULT=tests_result
+mkdir -p $TESTS_RESULT
+
+timestamp=$(date +%s-%N) # Get timestamp in nanoseconds
+RESULT=$TESTS_RESULT/$timestamp
+mkdir $RESULT
+
+cp $TEMP_STDOUT $RESULT/stdout
+cp $TEMP_STDERR $RESULT/stderr
+cp paths.csv parallel.csv short.csv contained.csv $RESULT/ 2>/dev/null
+
+echo "Result backed-up to $RESULT"
+
+# Cleaning up temp files...
+rm -f $TEMP_STDERR
+rm -f $TEMP_STDOUT
@@ -0,0 +1,86 @@
+#!/bin/bash
+
+# Builds the reachability index of a small graph and checks its answer for
+# every pair of nodes against the transitive closure of the indexed edges,
+# computed by a relation script. The graph has two cycles, a contain edge
+# (which isn't indexed) and an isolated node. An index built from another
+# snapshot must be rejected.
+
+echo "Creating temp files..."
+
+TEMP_STDOUT=$(mktemp /tmp/RexTestStdout.XXXXXX)
+TEMP_STDERR=$(mktemp /tmp/RexTestStderr.XXXXXX)
+
+if [ -z "$REX" ]
+then
+    echo "REX environment variable is undefined. Assuming Rex is found in PATH."
+    REX_EXECUTABLE=Rex
+else
+    echo "REX environment variable found."
+    REX_EXECUTABLE="$REX"
+fi
+
+# Clean up previous output (if any)
+rm -f graph.rexsnap graph.rexsnap.rexreach other.rexsnap other.rexsnap.rexreach nodes.txt closure.txt
+
+exit_code=0
+# Runs a step of the test. Any step that fails fails the test.
+run() {
+    echo "$1"
+    eval "$1" >> $TEMP_STDOUT 2>> $TEMP_STDERR || { echo "Step failed"; exit_code=1; }
+}
+
+# Asks the index about every pair of nodes
+check_all_pairs() {
+    for from in $(cat nodes.txt); do
+        for to in $(cat nodes.txt); do
+            answer=$($REX_EXECUTABLE query graph.rexsnap --from $from --to $to) || return 1
+            if [ $from = $to ] || grep -qx "$from $to" closure.txt; then
+                expected="$from reaches $to"
+            else
+                expected="$from does not reach $to"
+            fi
+            if [ "$answer" != "$expected" ]; then
+                echo "Index says '$answer', expected '$expected'"
+                return 1
+            fi
+        done
+    done
+}
+
+# Running test...
+run "$REX_EXECUTABLE --snapshot=graph.rexsnap --reachability graph.tao"
+run "[ -f graph.rexsnap.rexreach ]"
+run "$REX_EXECUTABLE query graph.rexsnap --script nodes.rql > nodes.txt"
+run "$REX_EXECUTABLE query graph.rexsnap --script closure.rql > closure.txt"
+run "check_all_pairs"
+run "$REX_EXECUTABLE --snapshot=other.rexsnap other.tao"
+run "cp graph.rexsnap.rexreach other.rexsnap.rexreach"
+run "! $REX_EXECUTABLE query other.rexsnap --from a --to b"
+
+echo "exit_code=$exit_code"
+
+if [ $exit_code -eq 0 ]
+then
+    echo "PASSED"
+else
+    echo "FAILED!!!"
+fi
+
+# Backing-up test result...
+TESTS_RESULT=tests_result
+mkdir -p $TESTS_RESULT
+
+timestamp=$(date +%s-%N) # Get timestamp in nanoseconds
+RESULT=$TESTS_RESULT/$timestamp
+mkdir $RESULT
+
+cp $TEMP_STDOUT $RESULT/stdout
+cp $TEMP_STDERR $RESULT/stderr
+cp nodes.txt closure.txt $RESULT/ 2>/dev/null
+
+echo "Result backed-up to $RESULT"
+
+# Cleaning up temp files...
+rm -f $TEMP_STDERR
+rm -f $TEMP_STDOUT
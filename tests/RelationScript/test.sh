@@ -0,0 +1,70 @@
+#!/bin/bash
+
+# Runs relation scripts with Rex query on a snapshot of a small ROS graph
+# (fixtures/robot.tao, which Snapshot shares).
+# operators.rql uses every operator and statement of the script language
+# (see Query/RelationScript.h), and its output is compared with the expected
+# one. Scripts given together share their variables, quit stops them all, and
+# a script that can't be evaluated fails with the line of the error.
+
+echo "Creating temp files..."
+
+TEMP_STDOUT=$(mktemp /tmp/RexTestStdout.XXXXXX)
+TEMP_STDERR=$(mktemp /tmp/RexTestStderr.XXXXXX)
+
+if [ -z "$REX" ]
+then
+    echo "REX environment variable is undefined. Assuming Rex is found in PATH."
+    REX_EXECUTABLE=Rex
+else
+    echo "REX environment variable found."
+    REX_EXECUTABLE="$REX"
+fi
+
+# Clean up previous output (if any)
+rm -f robot.rexsnap operators.txt shared.txt quit.txt bad.txt
+
+exit_code=0
+# Runs a step of the test. Any step that fails fails the test.
+run() {
+    echo "$1"
+    eval "$1" >> $TEMP_STDOUT 2>> $TEMP_STDERR || { echo "Step failed"; exit_code=1; }
+}
+
+# Running test...
+run "$REX_EXECUTABLE --snapshot=robot.rexsnap ../fixtures/robot.tao"
+run "$REX_EXECUTABLE query robot.rexsnap --script operators.rql > operators.txt"
+run "diff expected_operators.txt operators.txt"
+run "$REX_EXECUTABLE query robot.rexsnap --script define.rql --script use.rql > shared.txt"
+run "diff <(echo stop) shared.txt"
+run "$REX_EXECUTABLE query robot.rexsnap --script quit.rql --script use.rql > quit.txt"
+run "diff <(echo before) quit.txt"
+run "! $REX_EXECUTABLE query robot.rexsnap --script bad.rql 2> bad.txt"
+run "grep -q 'bad.rql, line 4: ' bad.txt"
+
+echo "exit_code=$exit_code"
+
+if [ $exit_code -eq 0 ]
+then
+    echo "PASSED"
+else
+    echo "FAILED!!!"
+fi
+
+# Backing-up test result...
+TESTS_RESULT=tests_result
+mkdir -p $TESTS_RESULT
+
+timestamp=$(date +%s-%N) # Get timestamp in nanoseconds
+RESULT=$TESTS_RESULT/$timestamp
+mkdir $RESULT
+
+cp $TEMP_STDOUT $RESULT/stdout
+cp $TEMP_STDERR $RESULT/stderr
+cp operators.txt shared.txt quit.txt bad.txt $RESULT/ 2>/dev/null
+
+echo "Result backed-up to $RESULT"
+
+# Cleaning up temp files...
+rm -f $TEMP_STDERR
+rm -f $TEMP_STDOUT
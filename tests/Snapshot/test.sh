@@ -0,0 +1,74 @@
+#!/bin/bash
+
+# Writes a snapshot of a small graph (fixtures/robot.tao, which RelationScript
+# shares) and loads it with Rex query. Every fact is read back through a
+# script and compared with the expected dump, and the nodes are compared with
+# the TA file written by the same link. Files that aren't complete snapshots
+# must be rejected, and so must snapshots from version 1, which have no column
+# for the function of each CFG block.
+
+echo "Creating temp files..."
+
+TEMP_STDOUT=$(mktemp /tmp/RexTestStdout.XXXXXX)
+TEMP_STDERR=$(mktemp /tmp/RexTestStderr.XXXXXX)
+
+if [ -z "$REX" ]
+then
+    echo "REX environment variable is undefined. Assuming Rex is found in PATH."
+    REX_EXECUTABLE=Rex
+else
+    echo "REX environment variable found."
+    REX_EXECUTABLE="$REX"
+fi
+
+# Clean up previous output (if any)
+rm -f out.ta out.rexsnap truncated.rexsnap version1.rexsnap dump.txt ta_nodes.txt snapshot_nodes.txt
+
+exit_code=0
+# Runs a step of the test. Any step that fails fails the test.
+run() {
+    echo "$1"
+    eval "$1" >> $TEMP_STDOUT 2>> $TEMP_STDERR || { echo "Step failed"; exit_code=1; }
+}
+
+# Running test...
+run "$REX_EXECUTABLE --output=out.ta --snapshot=out.rexsnap ../fixtures/robot.tao"
+run "$REX_EXECUTABLE query out.rexsnap --script dump.rql > dump.txt"
+run "diff expected_dump.txt dump.txt"
+run "grep '^[$]INSTANCE' out.ta | tr -d '\"' | cut -d ' ' -f 2,3 | sort > ta_nodes.txt"
+run "$REX_EXECUTABLE query out.rexsnap --script nodes.rql | sort > snapshot_nodes.txt"
+run "diff ta_nodes.txt snapshot_nodes.txt"
+run "head -c 200 out.rexsnap > truncated.rexsnap"
+run "! $REX_EXECUTABLE query truncated.rexsnap --script dump.rql"
+run "! $REX_EXECUTABLE query ../fixtures/robot.tao --script dump.rql"
+# The version comes right after the 8 byte magic number
+run "cp out.rexsnap version1.rexsnap"
+run "printf '\\001' | dd of=version1.rexsnap bs=1 seek=8 conv=notrunc"
+run "! $REX_EXECUTABLE query version1.rexsnap --script dump.rql"
+
+echo "exit_code=$exit_code"
+
+if [ $exit_code -eq 0 ]
+then
+    echo "PASSED"
+else
+    echo "FAILED!!!"
+fi
+
+# Backing-up test result...
+TESTS_RESULT=tests_result
+mkdir -p $TESTS_RESULT
+
+timestamp=$(date +%s-%N) # Get timestamp in nanoseconds
+RESULT=$TESTS_RESULT/$timestamp
+mkdir $RESULT
+
+cp $TEMP_STDOUT $RESULT/stdout
+cp $TEMP_STDERR $RESULT/stderr
+cp out.ta dump.txt $RESULT/ 2>/dev/null
+
+echo "Result backed-up to $RESULT"
+
+# Cleaning up temp files...
+rm -f $TEMP_STDERR
+rm -f $TEMP_STDOUT
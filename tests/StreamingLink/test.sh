@@ -0,0 +1,70 @@
+#!/bin/bash
+
+# Links the same object files with and without --stream-link and checks that
+# both write the same graph. The streaming linker writes facts in the order
+# the files arrive, so the TA files are compared line by line after sorting.
+#
+# main.tao calls helper and log, which are only declared by the other files,
+# and helper.tao calls a function that no file declares.
+
+echo "Creating temp files..."
+
+TEMP_STDOUT=$(mktemp /tmp/RexTestStdout.XXXXXX)
+TEMP_STDERR=$(mktemp /tmp/RexTestStderr.XXXXXX)
+
+if [ -z "$REX" ]
+then
+    echo "REX environment variable is undefined. Assuming Rex is found in PATH."
+    REX_EXECUTABLE=Rex
+else
+    echo "REX environment variable found."
+    REX_EXECUTABLE="$REX"
+fi
+
+# Clean up previous output (if any)
+rm -f batch.ta stream.ta
+
+OBJECT_FILES="main.tao helper.tao log.tao"
+
+exit_code=0
+# Runs a step of the test. Any step that fails fails the test.
+run() {
+    echo "$1"
+    eval "$1" >> $TEMP_STDOUT 2>> $TEMP_STDERR || { echo "Step failed"; exit_code=1; }
+}
+
+# Running test...
+run "$REX_EXECUTABLE --output=batch.ta $OBJECT_FILES"
+run "$REX_EXECUTABLE --stream-link --output=stream.ta $OBJECT_FILES"
+run "diff <(sort batch.ta) <(sort stream.ta)"
+# Edges between files are kept, the one that is never established is dropped
+run "grep -qx 'call \"main\" \"helper\"' stream.ta"
+run "grep -qx 'varWrite \"counter\" \"total\"' stream.ta"
+run "! grep -q '\"missing\"' stream.ta"
+
+echo "exit_code=$exit_code"
+
+if [ $exit_code -eq 0 ]
+then
+    echo "PASSED"
+else
+    echo "FAILED!!!"
+fi
+
+# Backing-up test result...
+TESTS_RESULT=tests_result
+mkdir -p $TESTS_RESULT
+
+timestamp=$(date +%s-%N) # Get timestamp in nanoseconds
+RESULT=$TESTS_RESULT/$timestamp
+mkdir $RESULT
+
+cp $TEMP_STDOUT $RESULT/stdout
+cp $TEMP_STDERR $RESULT/stderr
+cp batch.ta stream.ta $RESULT/ 2>/dev/null
+
+echo "Result backed-up to $RESULT"
+
+# Cleaning up temp files...
+rm -f $TEMP_STDERR
+rm -f $TEMP_STDOUT
@@ -38,7 +38,8 @@ args=("$@")
 if [ ${#args[@]} -eq 0 ]
 then
     # NOTE: this won't work if tests' names contain space
-    tests=($(ls -d */ | cut -f1 -d'/'))
+    # fixtures holds the inputs shared between tests, it isn't a test itself
+    tests=($(ls -d */ | cut -f1 -d'/' | grep -vx fixtures))
     echo "Running all ${#tests[@]} tests..."
 else
     tests=("${args[@]}")